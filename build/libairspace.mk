@@ -20,6 +20,7 @@ AIRSPACE_SOURCES = \
 	$(AIRSPACE_SRC_DIR)/AirspaceIntersectionVisitor.cpp \
 	$(AIRSPACE_SRC_DIR)/AirspaceWarningConfig.cpp \
 	$(AIRSPACE_SRC_DIR)/AirspaceWarningManager.cpp \
+	$(AIRSPACE_SRC_DIR)/AirspaceInterceptCache.cpp \
 	$(AIRSPACE_SRC_DIR)/AirspaceWarning.cpp \
 	$(AIRSPACE_SRC_DIR)/AirspaceSorter.cpp
 
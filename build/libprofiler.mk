@@ -0,0 +1,9 @@
+# Build rules for the run-time profiler library
+
+PROFILER_SRC_DIR = $(SRC)/Profiler
+
+PROFILER_SOURCES = \
+	$(PROFILER_SRC_DIR)/Profiler.cpp \
+	$(PROFILER_SRC_DIR)/Statistics.cpp
+
+$(eval $(call link-library,libprofiler,PROFILER))
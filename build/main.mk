@@ -76,6 +76,7 @@ DIALOG_SOURCES = \
 	$(SRC)/Dialogs/StatusPanels/TaskStatusPanel.cpp \
 	$(SRC)/Dialogs/StatusPanels/RulesStatusPanel.cpp \
 	$(SRC)/Dialogs/StatusPanels/TimesStatusPanel.cpp \
+	$(SRC)/Dialogs/StatusPanels/ProfilerStatusPanel.cpp \
 	\
 	$(SRC)/Dialogs/Waypoint/WaypointInfoWidget.cpp \
 	$(SRC)/Dialogs/Waypoint/WaypointCommandsWidget.cpp \
@@ -195,6 +196,7 @@ XCSOAR_SOURCES := \
 	$(SRC)/Renderer/TaskProgressRenderer.cpp \
 	\
 	$(SRC)/Airspace/AirspaceGlue.cpp \
+	$(SRC)/Airspace/AirspaceCache.cpp \
 	$(SRC)/Airspace/AirspaceParser.cpp \
 	$(SRC)/Airspace/AirspaceVisibility.cpp \
 	$(SRC)/Airspace/AirspaceComputerSettings.cpp \
@@ -272,9 +274,13 @@ XCSOAR_SOURCES := \
 	$(SRC)/IGC/Generator.cpp \
 	$(SRC)/Logger/MD5.cpp \
 	$(SRC)/Logger/NMEALogger.cpp \
+	$(SRC)/Logger/AsyncLineWriter.cpp \
 	$(SRC)/Logger/ExternalLogger.cpp \
 	$(SRC)/Logger/FlightLogger.cpp \
 	$(SRC)/Logger/GlueFlightLogger.cpp \
+	$(SRC)/JSON/Writer.cpp \
+	$(SRC)/Profiler/TraceWriter.cpp \
+	$(SRC)/Profiler/Glue.cpp \
 	$(SRC)/NMEA/Info.cpp \
 	$(SRC)/NMEA/MoreData.cpp \
 	$(SRC)/NMEA/Acceleration.cpp \
@@ -307,6 +313,7 @@ XCSOAR_SOURCES := \
 	$(SRC)/Waypoint/WaypointListBuilder.cpp \
 	$(SRC)/Waypoint/WaypointFilter.cpp \
 	$(SRC)/Waypoint/WaypointGlue.cpp \
+	$(SRC)/Waypoint/WaypointCache.cpp \
 	$(SRC)/Waypoint/SaveGlue.cpp \
 	$(SRC)/Waypoint/LastUsed.cpp \
 	$(SRC)/Waypoint/HomeGlue.cpp \
@@ -765,7 +772,7 @@ XCSOAR_DEPENDS = GETTEXT PROFILE \
 	IO ASYNC TASK CONTEST ROUTE GLIDE WAYPOINT AIRSPACE \
 	LUA \
 	SHAPELIB ZZIP \
-	LIBNET TIME OS THREAD \
+	LIBNET TIME OS PROFILER THREAD \
 	UTIL GEO MATH
 
 ifeq ($(TARGET_IS_DARWIN),y)
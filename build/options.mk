@@ -11,12 +11,6 @@ endif
 
 ICF ?= n
 
-# show map renderer times?
-STOP_WATCH ?= n
-ifeq ($(STOP_WATCH),y)
-TARGET_CPPFLAGS += -DSTOP_WATCH
-endif
-
 # compile without UI?
 HEADLESS ?= n
 
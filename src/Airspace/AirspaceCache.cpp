@@ -0,0 +1,492 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "AirspaceCache.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspacePolygon.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "IO/FileCache.hpp"
+#include "OS/FileMapping.hpp"
+#include "OS/FileUtil.hpp"
+#include "Util/tstring.hpp"
+#include "Util/StringAPI.hxx"
+#include "Compiler.h"
+
+#include <memory>
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * The trailer at the end of the file, which locates the sections.
+ * All offsets are absolute file offsets.
+ */
+struct AirspaceCacheTrailer {
+  /**
+   * Increment the version whenever the file format changes.
+   */
+  static constexpr uint32_t VERSION = 1;
+  static constexpr uint32_t MAGIC = 0x41535043;
+
+  /**
+   * The alignment of all sections.
+   */
+  static constexpr unsigned ALIGNMENT = 8;
+
+  uint64_t records_offset, points_offset, sources_offset, strings_offset;
+  uint32_t n_records, n_points, n_sources, n_strings;
+
+  double center_longitude, center_latitude;
+
+  uint32_t version, magic;
+};
+
+struct AirspaceCacheSource {
+  uint64_t size, mtime;
+  uint32_t path_offset, path_length;
+};
+
+struct AirspaceCacheAltitude {
+  double altitude, flight_level, altitude_above_terrain;
+  int8_t reference;
+};
+
+struct AirspaceCacheRecord {
+  uint32_t first_point, n_points;
+  uint32_t name_offset, name_length;
+  uint32_t radio_offset, radio_length;
+
+  AirspaceCacheAltitude base, top;
+
+  /**
+   * Only used by circles.
+   */
+  double center_longitude, center_latitude, radius;
+
+  int32_t box_left, box_bottom, box_right, box_top;
+
+  uint8_t shape, type, days;
+};
+
+struct AirspaceCachePoint {
+  double longitude, latitude;
+  int32_t x, y;
+};
+
+static_assert(sizeof(AirspaceActivity) == 1,
+              "Unexpected AirspaceActivity size");
+
+static AirspaceCacheAltitude
+ToCache(const AirspaceAltitude &src)
+{
+  AirspaceCacheAltitude dest;
+  memset(&dest, 0, sizeof(dest));
+  dest.altitude = src.altitude;
+  dest.flight_level = src.flight_level;
+  dest.altitude_above_terrain = src.altitude_above_terrain;
+  dest.reference = (int8_t)src.reference;
+  return dest;
+}
+
+static AirspaceAltitude
+FromCache(const AirspaceCacheAltitude &src)
+{
+  AirspaceAltitude dest;
+  dest.altitude = fixed(src.altitude);
+  dest.flight_level = fixed(src.flight_level);
+  dest.altitude_above_terrain = fixed(src.altitude_above_terrain);
+  dest.reference = (AltitudeReference)src.reference;
+  return dest;
+}
+
+static GeoPoint
+MakeGeoPoint(double longitude, double latitude)
+{
+  return GeoPoint(Angle::Native(fixed(longitude)),
+                  Angle::Native(fixed(latitude)));
+}
+
+/**
+ * Collects the sections of the cache file in memory.
+ */
+class AirspaceCacheBuilder {
+  std::vector<AirspaceCacheRecord> records;
+  std::vector<AirspaceCachePoint> points;
+  std::vector<AirspaceCacheSource> sources;
+  tstring strings;
+
+public:
+  void AddSource(const TCHAR *path) {
+    AirspaceCacheSource source;
+    memset(&source, 0, sizeof(source));
+    source.size = File::GetSize(path);
+    source.mtime = File::GetLastModification(path);
+    AddString(path, _tcslen(path), source.path_offset, source.path_length);
+    sources.push_back(source);
+  }
+
+  void AddAirspace(const Airspace &item);
+
+  bool Write(FILE *file, const GeoPoint &center) const;
+
+private:
+  void AddString(const TCHAR *value, size_t length,
+                 uint32_t &offset_r, uint32_t &length_r) {
+    offset_r = strings.length();
+    length_r = length;
+    strings.append(value, length);
+  }
+
+  void AddString(const tstring &value,
+                 uint32_t &offset_r, uint32_t &length_r) {
+    AddString(value.data(), value.length(), offset_r, length_r);
+  }
+};
+
+void
+AirspaceCacheBuilder::AddAirspace(const Airspace &item)
+{
+  const AbstractAirspace &airspace = item.GetAirspace();
+  const SearchPointVector &border = airspace.GetPoints();
+
+  AirspaceCacheRecord record;
+  /* zero-fill all implicit padding bytes (to make valgrind happy) */
+  memset(&record, 0, sizeof(record));
+
+  record.first_point = points.size();
+  record.n_points = border.size();
+
+  for (const auto &i : border) {
+    AirspaceCachePoint point;
+    memset(&point, 0, sizeof(point));
+    point.longitude = i.GetLocation().longitude.Native();
+    point.latitude = i.GetLocation().latitude.Native();
+    point.x = i.GetFlatLocation().x;
+    point.y = i.GetFlatLocation().y;
+    points.push_back(point);
+  }
+
+  AddString(airspace.GetName(), _tcslen(airspace.GetName()),
+            record.name_offset, record.name_length);
+  AddString(airspace.GetRadioText(),
+            record.radio_offset, record.radio_length);
+
+  record.base = ToCache(airspace.GetBase());
+  record.top = ToCache(airspace.GetTop());
+
+  if (airspace.GetShape() == AbstractAirspace::Shape::CIRCLE) {
+    const AirspaceCircle &circle = (const AirspaceCircle &)airspace;
+    record.center_longitude = circle.GetCenter().longitude.Native();
+    record.center_latitude = circle.GetCenter().latitude.Native();
+    record.radius = circle.GetRadius();
+  }
+
+  record.box_left = item.GetLeft();
+  record.box_bottom = item.GetBottom();
+  record.box_right = item.GetRight();
+  record.box_top = item.GetTop();
+
+  record.shape = (uint8_t)airspace.GetShape();
+  record.type = airspace.GetType();
+
+  const AirspaceActivity days = airspace.GetDays();
+  memcpy(&record.days, &days, sizeof(days));
+
+  records.push_back(record);
+}
+
+/**
+ * Pad the file to the section alignment and return the position.
+ */
+static long
+Align(FILE *file)
+{
+  long position = ftell(file);
+  if (position < 0)
+    return -1;
+
+  static constexpr char padding[AirspaceCacheTrailer::ALIGNMENT] = {};
+  const unsigned misalignment = position % AirspaceCacheTrailer::ALIGNMENT;
+  if (misalignment > 0) {
+    const unsigned n = AirspaceCacheTrailer::ALIGNMENT - misalignment;
+    if (fwrite(padding, 1, n, file) != n)
+      return -1;
+
+    position += n;
+  }
+
+  return position;
+}
+
+template<typename T>
+static bool
+WriteSection(FILE *file, const T *data, size_t n, uint64_t &offset_r)
+{
+  const long position = Align(file);
+  if (position < 0)
+    return false;
+
+  offset_r = position;
+  return n == 0 || fwrite(data, sizeof(*data), n, file) == n;
+}
+
+bool
+AirspaceCacheBuilder::Write(FILE *file, const GeoPoint &center) const
+{
+  AirspaceCacheTrailer trailer;
+  memset(&trailer, 0, sizeof(trailer));
+  trailer.n_records = records.size();
+  trailer.n_points = points.size();
+  trailer.n_sources = sources.size();
+  trailer.n_strings = strings.length();
+  trailer.center_longitude = center.longitude.Native();
+  trailer.center_latitude = center.latitude.Native();
+  trailer.version = AirspaceCacheTrailer::VERSION;
+  trailer.magic = AirspaceCacheTrailer::MAGIC;
+
+  return WriteSection(file, records.data(), records.size(),
+                      trailer.records_offset) &&
+    WriteSection(file, points.data(), points.size(),
+                 trailer.points_offset) &&
+    WriteSection(file, sources.data(), sources.size(),
+                 trailer.sources_offset) &&
+    WriteSection(file, strings.data(), strings.length(),
+                 trailer.strings_offset) &&
+    Align(file) >= 0 &&
+    fwrite(&trailer, sizeof(trailer), 1, file) == 1;
+}
+
+bool
+AirspaceCache::Save(FileCache &cache,
+                    const std::vector<const TCHAR *> &sources,
+                    const Airspaces &airspaces)
+{
+  assert(!sources.empty());
+
+  AirspaceCacheBuilder builder;
+  for (const TCHAR *path : sources)
+    builder.AddSource(path);
+
+  for (const auto &i : airspaces)
+    builder.AddAirspace(i);
+
+  static constexpr const TCHAR *name = _T("airspace");
+  FILE *file = cache.Save(name, sources.front());
+  if (file == nullptr)
+    return false;
+
+  if (!builder.Write(file, airspaces.GetProjection().GetCenter())) {
+    cache.Cancel(name, file);
+    return false;
+  }
+
+  return cache.Commit(name, file);
+}
+
+/**
+ * Provides bounds-checked access to the sections of a mapped cache
+ * file.
+ */
+class AirspaceCacheReader {
+  const FileMapping &mapping;
+  const AirspaceCacheTrailer *trailer = nullptr;
+
+  const AirspaceCacheRecord *records;
+  const AirspaceCachePoint *points;
+  const AirspaceCacheSource *sources;
+  const TCHAR *strings;
+
+public:
+  explicit AirspaceCacheReader(const FileMapping &_mapping)
+    :mapping(_mapping) {}
+
+  bool Open();
+
+  gcc_pure
+  bool CheckSources(const std::vector<const TCHAR *> &paths) const;
+
+  bool Load(Airspaces &airspaces) const;
+
+private:
+  template<typename T>
+  const T *GetSection(uint64_t offset, uint32_t n) const {
+    if (offset % alignof(T) != 0 || offset > mapping.size() ||
+        n > (mapping.size() - offset) / sizeof(T))
+      return nullptr;
+
+    return (const T *)mapping.at(offset);
+  }
+
+  gcc_pure
+  bool IsValidString(uint32_t offset, uint32_t length) const {
+    return offset <= trailer->n_strings &&
+      length <= trailer->n_strings - offset;
+  }
+
+  gcc_pure
+  bool IsValid(const AirspaceCacheRecord &record) const;
+
+  AbstractAirspace *Create(const AirspaceCacheRecord &record) const;
+};
+
+bool
+AirspaceCacheReader::Open()
+{
+  if (mapping.size() < sizeof(*trailer))
+    return false;
+
+  const uint64_t trailer_offset = mapping.size() - sizeof(*trailer);
+  if (trailer_offset % alignof(AirspaceCacheTrailer) != 0)
+    return false;
+
+  trailer = (const AirspaceCacheTrailer *)mapping.at(trailer_offset);
+  if (trailer->magic != AirspaceCacheTrailer::MAGIC ||
+      trailer->version != AirspaceCacheTrailer::VERSION)
+    return false;
+
+  records = GetSection<AirspaceCacheRecord>(trailer->records_offset,
+                                            trailer->n_records);
+  points = GetSection<AirspaceCachePoint>(trailer->points_offset,
+                                          trailer->n_points);
+  sources = GetSection<AirspaceCacheSource>(trailer->sources_offset,
+                                            trailer->n_sources);
+  strings = GetSection<TCHAR>(trailer->strings_offset, trailer->n_strings);
+  return records != nullptr && points != nullptr && sources != nullptr &&
+    strings != nullptr;
+}
+
+bool
+AirspaceCacheReader::CheckSources(const std::vector<const TCHAR *> &paths) const
+{
+  if (paths.size() != trailer->n_sources)
+    return false;
+
+  for (unsigned i = 0; i < trailer->n_sources; ++i) {
+    const AirspaceCacheSource &source = sources[i];
+    const TCHAR *path = paths[i];
+
+    if (!IsValidString(source.path_offset, source.path_length) ||
+        _tcslen(path) != source.path_length ||
+        !StringIsEqual(path, strings + source.path_offset,
+                       source.path_length) ||
+        File::GetSize(path) != source.size ||
+        File::GetLastModification(path) != source.mtime)
+      return false;
+  }
+
+  return true;
+}
+
+bool
+AirspaceCacheReader::IsValid(const AirspaceCacheRecord &record) const
+{
+  return record.first_point <= trailer->n_points &&
+    record.n_points <= trailer->n_points - record.first_point &&
+    record.n_points >= 3 &&
+    IsValidString(record.name_offset, record.name_length) &&
+    IsValidString(record.radio_offset, record.radio_length) &&
+    record.shape <= (uint8_t)AbstractAirspace::Shape::POLYGON &&
+    record.type < AIRSPACECLASSCOUNT;
+}
+
+AbstractAirspace *
+AirspaceCacheReader::Create(const AirspaceCacheRecord &record) const
+{
+  SearchPointVector border;
+  border.reserve(record.n_points);
+
+  const AirspaceCachePoint *end = points + record.first_point +
+    record.n_points;
+  for (auto i = points + record.first_point; i != end; ++i)
+    border.emplace_back(MakeGeoPoint(i->longitude, i->latitude),
+                        FlatGeoPoint(i->x, i->y));
+
+  AbstractAirspace *airspace;
+  if (record.shape == (uint8_t)AbstractAirspace::Shape::CIRCLE)
+    airspace = new AirspaceCircle(MakeGeoPoint(record.center_longitude,
+                                               record.center_latitude),
+                                  fixed(record.radius), std::move(border));
+  else
+    airspace = new AirspacePolygon(std::move(border));
+
+  airspace->SetProperties(tstring(strings + record.name_offset,
+                                  record.name_length),
+                          (AirspaceClass)record.type,
+                          FromCache(record.base), FromCache(record.top));
+  airspace->SetRadio(tstring(strings + record.radio_offset,
+                             record.radio_length));
+
+  AirspaceActivity days;
+  memcpy(&days, &record.days, sizeof(days));
+  airspace->SetDays(days);
+
+  return airspace;
+}
+
+bool
+AirspaceCacheReader::Load(Airspaces &airspaces) const
+{
+  /* validate everything before adding anything */
+  for (unsigned i = 0; i < trailer->n_records; ++i)
+    if (!IsValid(records[i]))
+      return false;
+
+  const GeoPoint center = MakeGeoPoint(trailer->center_longitude,
+                                       trailer->center_latitude);
+
+  for (unsigned i = 0; i < trailer->n_records; ++i) {
+    const AirspaceCacheRecord &record = records[i];
+    const FlatBoundingBox box(FlatGeoPoint(record.box_left,
+                                           record.box_bottom),
+                              FlatGeoPoint(record.box_right,
+                                           record.box_top));
+    airspaces.AddProjected(Create(record), box, center);
+  }
+
+  return true;
+}
+
+bool
+AirspaceCache::Load(FileCache &cache,
+                    const std::vector<const TCHAR *> &sources,
+                    Airspaces &airspaces)
+{
+  assert(!sources.empty());
+
+  static constexpr const TCHAR *name = _T("airspace");
+  std::unique_ptr<FileMapping> mapping(cache.LoadMapping(name,
+                                                         sources.front()));
+  if (!mapping)
+    return false;
+
+  AirspaceCacheReader reader(*mapping);
+  if (!reader.Open() || !reader.CheckSources(sources) ||
+      !reader.Load(airspaces)) {
+    cache.Flush(name);
+    return false;
+  }
+
+  return true;
+}
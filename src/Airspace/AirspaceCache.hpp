@@ -0,0 +1,69 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_AIRSPACE_CACHE_HPP
+#define XCSOAR_AIRSPACE_CACHE_HPP
+
+#include <vector>
+
+#include <tchar.h>
+
+class Airspaces;
+class FileCache;
+
+/**
+ * A compiled snapshot of the #Airspaces database in the #FileCache.
+ * It contains the projected borders and bounding boxes of all
+ * airspaces in one contiguous file which gets mapped into memory, so
+ * loading does not need any text parsing, trigonometry or
+ * projection.
+ *
+ * The snapshot is invalidated when any of the source files changes.
+ * If the projection centre computed while loading differs from the
+ * one in the snapshot, the #Airspaces database projects the borders
+ * again.
+ */
+namespace AirspaceCache {
+  /**
+   * Load the snapshot and add its airspaces to the database.
+   * Airspaces::Optimise() must be called afterwards.  Nothing is
+   * added if the snapshot is missing, stale or broken.
+   *
+   * @param sources the files the airspaces were parsed from, in
+   * parse order; the first one is the key of the #FileCache entry
+   * @return true if the snapshot was loaded
+   */
+  bool Load(FileCache &cache, const std::vector<const TCHAR *> &sources,
+            Airspaces &airspaces);
+
+  /**
+   * Save a snapshot of the database.  Airspaces::Optimise() must have
+   * been called, but Airspaces::SetFlightLevels() and
+   * Airspaces::SetGroundLevels() not yet, because the snapshot shall
+   * contain the altitudes from the file.
+   */
+  bool Save(FileCache &cache, const std::vector<const TCHAR *> &sources,
+            const Airspaces &airspaces);
+}
+
+#endif
@@ -23,6 +23,7 @@ Copyright_License {
 
 #include "Airspace/AirspaceGlue.hpp"
 #include "Airspace/AirspaceParser.hpp"
+#include "Airspace/AirspaceCache.hpp"
 #include "Engine/Airspace/Airspaces.hpp"
 #include "Profile/ProfileKeys.hpp"
 #include "Operation/Operation.hpp"
@@ -36,6 +37,8 @@ Copyright_License {
 
 #include <zzip/zzip.h>
 
+#include <vector>
+
 #include <windef.h> /* for MAX_PATH */
 
 #include <string.h>
@@ -83,6 +86,7 @@ void
 ReadAirspace(Airspaces &airspaces,
              RasterTerrain *terrain,
              const AtmosphericPressure &press,
+             FileCache *cache,
              OperationEnvironment &operation)
 {
   LogFormat("ReadAirspace");
@@ -90,24 +94,50 @@ ReadAirspace(Airspaces &airspaces,
 
   bool airspace_ok = false;
 
-  AirspaceParser parser(airspaces);
-
   // Read the airspace filenames from the registry
-  TCHAR path[MAX_PATH];
-  if (Profile::GetPath(ProfileKeys::AirspaceFile, path))
-    airspace_ok |= ParseAirspaceFile(parser, path, operation);
-
-  if (Profile::GetPath(ProfileKeys::AdditionalAirspaceFile, path))
-    airspace_ok |= ParseAirspaceFile(parser, path, operation);
-
-  auto dir = OpenMapFile();
-  if (dir != nullptr) {
-    airspace_ok |= ParseAirspaceFile(parser, dir, "airspace.txt", operation);
-    zzip_dir_close(dir);
+  TCHAR path[MAX_PATH], additional_path[MAX_PATH], map_path[MAX_PATH];
+  const bool have_path =
+    Profile::GetPath(ProfileKeys::AirspaceFile, path);
+  const bool have_additional_path =
+    Profile::GetPath(ProfileKeys::AdditionalAirspaceFile, additional_path);
+  const bool have_map_path =
+    Profile::GetPath(ProfileKeys::MapFile, map_path);
+
+  std::vector<const TCHAR *> sources;
+  if (have_path)
+    sources.push_back(path);
+  if (have_additional_path)
+    sources.push_back(additional_path);
+  if (have_map_path)
+    sources.push_back(map_path);
+
+  const bool cached = cache != nullptr && !sources.empty() &&
+    AirspaceCache::Load(*cache, sources, airspaces);
+  if (cached) {
+    airspace_ok = true;
+  } else {
+    AirspaceParser parser(airspaces);
+
+    if (have_path)
+      airspace_ok |= ParseAirspaceFile(parser, path, operation);
+
+    if (have_additional_path)
+      airspace_ok |= ParseAirspaceFile(parser, additional_path, operation);
+
+    auto dir = OpenMapFile();
+    if (dir != nullptr) {
+      airspace_ok |= ParseAirspaceFile(parser, dir, "airspace.txt", operation);
+      zzip_dir_close(dir);
+    }
   }
 
   if (airspace_ok) {
     airspaces.Optimise();
+
+    if (cache != nullptr && !cached &&
+        !AirspaceCache::Save(*cache, sources, airspaces))
+      LogFormat("Failed to save airspace cache");
+
     airspaces.SetFlightLevels(press);
 
     if (terrain != NULL)
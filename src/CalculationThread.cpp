@@ -27,6 +27,7 @@ Copyright_License {
 #include "Blackboard/DeviceBlackboard.hpp"
 #include "Components.hpp"
 #include "Hardware/CPU.hpp"
+#include "Profiler/Profiler.hpp"
 
 /**
  * Constructor of the CalculationThread class
@@ -58,6 +59,8 @@ CalculationThread::SetScreenDistanceMeters(fixed new_value)
 void
 CalculationThread::Tick()
 {
+  Profiler::RegisterThread("CalculationThread");
+
 #ifdef HAVE_CPU_FREQUENCY
   const ScopeLockCPU cpu;
 #endif
@@ -91,9 +94,11 @@ CalculationThread::Tick()
 
   bool do_idle = false;
 
-  if (gps_updated || force)
+  if (gps_updated || force) {
+    const ProfileScope scope("ProcessGPS");
     // perform idle call if time advanced and slow calculations need to be updated
     do_idle |= glide_computer.ProcessGPS(force);
+  }
 
   // values changed, so copy them back now: ONLY CALCULATED INFO
   // should be changed in DoCalculations, so we only need to write
@@ -110,6 +115,7 @@ CalculationThread::Tick()
 
   if (do_idle) {
     // do slow calculations last, to minimise latency
+    const ProfileScope scope("ProcessIdle");
     glide_computer.ProcessIdle();
   }
 }
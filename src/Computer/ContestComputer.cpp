@@ -23,6 +23,7 @@ Copyright_License {
 
 #include "ContestComputer.hpp"
 #include "Engine/Contest/Settings.hpp"
+#include "Thread/Parallel.hpp"
 
 ContestComputer::ContestComputer(const Trace &trace_full,
                                  const Trace &trace_triangle,
@@ -30,6 +31,9 @@ ContestComputer::ContestComputer(const Trace &trace_full,
   :contest_manager(Contest::OLC_SPRINT, trace_full, trace_triangle, trace_sprint, true)
 {
   contest_manager.SetIncremental(true);
+
+  if (GetCPUCount() > 1)
+    contest_manager.SetParallel(RunParallel);
 }
 
 void
@@ -27,6 +27,7 @@ Copyright_License {
 #include "ConditionMonitor/ConditionMonitors.hpp"
 #include "GlideComputerInterface.hpp"
 #include "Engine/Waypoint/Waypoints.hpp"
+#include "Profiler/Profiler.hpp"
 
 static PeriodClock last_team_code_update;
 
@@ -108,34 +109,43 @@ GlideComputer::ProcessGPS(bool force)
   calculated.Expire(basic.clock);
 
   // Process basic information
+  ProfileScope scope("AirData");
   air_data_computer.ProcessBasic(Basic(), SetCalculated(),
                                  GetComputerSettings());
 
   // Process basic task information
   const bool last_finished = calculated.ordered_task_stats.task_finished;
 
+  scope.Next("Task");
   task_computer.ProcessBasicTask(basic,
                                  calculated,
                                  GetComputerSettings(),
                                  force);
+
+  scope.Next("Route");
   task_computer.ProcessMoreTask(basic, calculated, GetComputerSettings());
 
+  scope.Next("Task");
   if (!last_finished && calculated.ordered_task_stats.task_finished)
     OnFinishTask();
 
   // Check if everything is okay with the gps time and process it
+  scope.Next("AirData");
   air_data_computer.FlightTimes(Basic(), SetCalculated(),
                                 GetComputerSettings());
 
   TakeoffLanding(last_flying);
 
+  scope.Next("Task");
   task_computer.ProcessAutoTask(basic, calculated);
 
   // Process extended information
+  scope.Next("AirData");
   air_data_computer.ProcessVertical(Basic(),
                                     SetCalculated(),
                                     GetComputerSettings());
 
+  scope.Next("Misc");
   stats_computer.ProcessClimbEvents(calculated);
 
   // Calculate the team code
@@ -173,14 +183,20 @@ GlideComputer::ProcessIdle(bool exhaustive)
 
   // Log GPS fixes for internal usage
   // (snail trail, stats, olc, ...)
-  stats_computer.DoLogging(basic, calculated);
-  log_computer.Run(basic, calculated, GetComputerSettings().logger);
+  {
+    const ProfileScope scope("Logging");
+    stats_computer.DoLogging(basic, calculated);
+    log_computer.Run(basic, calculated, GetComputerSettings().logger);
+  }
 
   task_computer.ProcessIdle(basic, calculated, GetComputerSettings(),
                             exhaustive);
 
-  warning_computer.Update(GetComputerSettings(), basic,
-                          calculated, calculated.airspace_warnings);
+  {
+    const ProfileScope scope("AirspaceWarnings");
+    warning_computer.Update(GetComputerSettings(), basic,
+                            calculated, calculated.airspace_warnings);
+  }
 
   // Calculate summary of flight
   if (basic.location_available)
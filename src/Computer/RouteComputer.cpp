@@ -28,6 +28,7 @@ Copyright_License {
 #include "NMEA/Derived.hpp"
 #include "NMEA/Aircraft.hpp"
 #include "Navigation/Aircraft.hpp"
+#include "Thread/Parallel.hpp"
 
 #include <algorithm>
 
@@ -35,13 +36,17 @@ RouteComputer::RouteComputer(const Airspaces &airspace_database,
                              const ProtectedAirspaceWarningManager *warnings)
   :protected_route_planner(route_planner, airspace_database, warnings),
    terrain(NULL)
-{}
+{
+  if (GetCPUCount() > 1)
+    route_planner.SetParallel(RunParallel);
+}
 
 void
 RouteComputer::ResetFlight()
 {
   route_clock.Reset();
   reach_clock.Reset();
+  full_reach_clock.Reset();
   protected_route_planner.Reset();
 
   last_task_type = TaskType::NONE;
@@ -142,13 +147,27 @@ RouteComputer::Reach(const MoreData &basic, DerivedInfo &calculated,
   const RoughAltitude h_ceiling((short)std::max((int)basic.nav_altitude + 500,
                                                 (int)calculated.thermal_band.working_band_ceiling));
 
-  if (reach_clock.CheckAdvance(basic.time, PERIOD)) {
-    protected_route_planner.SolveReach(start, config, h_ceiling, do_solve);
+  if (!reach_clock.CheckAdvance(basic.time, REACH_PERIOD))
+    return;
 
-    if (do_solve) {
-      calculated.terrain_base = route_planner.GetTerrainBase();
-      calculated.terrain_base_valid = true;
-    }
+  if (do_solve &&
+      !protected_route_planner.CanUpdateReach(start, config, h_ceiling) &&
+      !full_reach_clock.CheckAdvance(basic.time, REACH_FULL_PERIOD))
+    /* a full solution is expensive; keep the current one until
+       REACH_FULL_PERIOD has passed */
+    return;
+
+  protected_route_planner.SolveReach(start, config, h_ceiling, do_solve,
+                                     true);
+
+  if (do_solve) {
+    if (route_planner.GetReachUpdateCount() == 0)
+      /* solved from scratch, possibly because the incremental
+         update has failed */
+      full_reach_clock.Update(basic.time);
+
+    calculated.terrain_base = route_planner.GetTerrainBase();
+    calculated.terrain_base_valid = true;
   }
 }
 
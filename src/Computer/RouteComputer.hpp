@@ -40,11 +40,24 @@ class GlidePolar;
 class RouteComputer {
   static constexpr unsigned PERIOD = 5;
 
+  /**
+   * The reach is updated more often than the route, because most
+   * updates are incremental, see ReachFan::Solve().
+   */
+  static constexpr unsigned REACH_PERIOD = 1;
+
+  /**
+   * If the reach cannot be updated incrementally, it is solved from
+   * scratch at most this often.
+   */
+  static constexpr unsigned REACH_FULL_PERIOD = 5;
+
   RoutePlannerGlue route_planner;
   ProtectedRoutePlanner protected_route_planner;
 
   GPSClock route_clock;
   GPSClock reach_clock;
+  GPSClock full_reach_clock;
 
   const RasterTerrain *terrain;
 
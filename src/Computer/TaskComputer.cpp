@@ -29,6 +29,7 @@ Copyright_License {
 #include "NMEA/MoreData.hpp"
 #include "NMEA/Derived.hpp"
 #include "Settings.hpp"
+#include "Profiler/Profiler.hpp"
 
 #include <algorithm>
 
@@ -149,6 +150,7 @@ TaskComputer::ProcessIdle(const MoreData &basic, DerivedInfo &calculated,
                           const ComputerSettings &settings_computer,
                           bool exhaustive)
 {
+  ProfileScope scope("Contest");
   contest.SetPredicted(Predicted(settings_computer.contest, basic,
                                  calculated.task_stats.current_leg));
 
@@ -158,6 +160,7 @@ TaskComputer::ProcessIdle(const MoreData &basic, DerivedInfo &calculated,
   else
     contest.Solve(settings_computer.contest, calculated.contest_stats);
 
+  scope.Next("Task");
   const AircraftState as = ToAircraftState(basic, calculated);
 
   ProtectedTaskManager::ExclusiveLease _task(task);
@@ -694,7 +694,8 @@ DeviceDescriptor::IsAlive() const
 }
 
 bool
-DeviceDescriptor::ParseNMEA(const char *line, NMEAInfo &info)
+DeviceDescriptor::ParseNMEA(const char *line, NMEAInfo &info,
+                            const ExternalSettings &sent)
 {
   assert(line != nullptr);
 
@@ -712,7 +713,7 @@ DeviceDescriptor::ParseNMEA(const char *line, NMEAInfo &info)
        sent to the device */
     const ExternalSettings old_received = settings_received;
     settings_received = info.settings;
-    info.settings.EliminateRedundant(settings_sent, old_received);
+    info.settings.EliminateRedundant(sent, old_received);
 
     return true;
   }
@@ -1108,10 +1109,27 @@ DeviceDescriptor::OnCalculatedUpdate(const MoreData &basic,
 bool
 DeviceDescriptor::ParseLine(const char *line)
 {
-  ScopeLock protect(device_blackboard->mutex);
-  NMEAInfo &basic = device_blackboard->SetRealState(index);
+  if (!staging.IsActive()) {
+    const ScopeLock protect(device_blackboard->mutex);
+    staging.Begin(device_blackboard->RealState(index));
+    staging_settings_sent = settings_sent;
+  }
+
+  NMEAInfo &basic = staging.Get();
   basic.UpdateClock();
-  return ParseNMEA(line, basic);
+  if (!ParseNMEA(line, basic, staging_settings_sent))
+    return false;
+
+  staging.SetModified();
+  return true;
+}
+
+void
+DeviceDescriptor::PublishStaging()
+{
+  if (staging.Publish(device_blackboard->mutex,
+                      device_blackboard->SetRealState(index)))
+    device_blackboard->ScheduleMerge();
 }
 
 void
@@ -1152,8 +1170,10 @@ DeviceDescriptor::DataReceived(const void *data, size_t length)
     return;
   }
 
-  if (!IsNMEAOut())
+  if (!IsNMEAOut()) {
     PortLineSplitter::DataReceived(data, length);
+    PublishStaging();
+  }
 }
 
 void
@@ -1164,6 +1184,5 @@ DeviceDescriptor::LineReceived(const char *line)
   if (dispatcher != nullptr)
     dispatcher->LineReceived(line);
 
-  if (ParseLine(line))
-    device_blackboard->ScheduleMerge();
+  ParseLine(line);
 }
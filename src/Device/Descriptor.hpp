@@ -28,6 +28,7 @@ Copyright_License {
 #include "Config.hpp"
 #include "IO/DataHandler.hpp"
 #include "Device/Util/LineSplitter.hpp"
+#include "Device/Util/StagedNMEAInfo.hpp"
 #include "Port/State.hpp"
 #include "Device/Parser.hpp"
 #include "RadioFrequency.hpp"
@@ -186,6 +187,20 @@ class DeviceDescriptor final : private Notify, private PortLineSplitter {
    */
   ExternalSettings settings_received;
 
+  /**
+   * The port thread parses NMEA lines into this object without
+   * holding DeviceBlackboard::mutex, and publishes it to the
+   * blackboard after each chunk of data received from the port.
+   */
+  StagedNMEAInfo staging;
+
+  /**
+   * A copy of #settings_sent for the port thread, taken at the
+   * beginning of each batch, because #settings_sent is protected by
+   * DeviceBlackboard::mutex.
+   */
+  ExternalSettings staging_settings_sent;
+
   /**
    * Number of port failures since the device was last reset.
    *
@@ -436,7 +451,12 @@ public:
   bool IsAlive() const;
 
 private:
-  bool ParseNMEA(const char *line, struct NMEAInfo &info);
+  /**
+   * @param sent a copy of #settings_sent which was taken while
+   * holding DeviceBlackboard::mutex
+   */
+  bool ParseNMEA(const char *line, struct NMEAInfo &info,
+                 const ExternalSettings &sent);
 
 public:
   void SetMonitor(DataHandler  *_monitor) {
@@ -502,8 +522,18 @@ public:
                           const DerivedInfo &calculated);
 
 private:
+  /**
+   * Parse a line into #staging.  Begins a new batch if none is in
+   * progress.
+   */
   bool ParseLine(const char *line);
 
+  /**
+   * Finish the batch in #staging and publish it to the
+   * #DeviceBlackboard.
+   */
+  void PublishStaging();
+
   /* virtual methods from class Notify */
   void OnNotification() override;
 
@@ -25,6 +25,7 @@ Copyright_License {
 #include "Units/System.hpp"
 #include "NMEA/Info.hpp"
 #include "NMEA/InputLine.hpp"
+#include "NMEA/Tag.hpp"
 #include "NMEA/Checksum.hpp"
 
 static bool
@@ -149,14 +150,16 @@ CAI302Device::ParseNMEA(const char *String, NMEAInfo &info)
   char type[16];
   line.Read(type, 16);
 
-  if (StringIsEqual(type, "$PCAIB"))
+  switch (NMEATag(type)) {
+  case NMEATag("$PCAIB"):
     return cai_PCAIB(line, info);
 
-  if (StringIsEqual(type, "$PCAID"))
+  case NMEATag("$PCAID"):
     return cai_PCAID(line, info);
 
-  if (StringIsEqual(type, "!w"))
+  case NMEATag("!w"):
     return cai_w(line, info);
+  }
 
   return false;
 }
@@ -25,6 +25,7 @@ Copyright_License {
 #include "Device/Parser.hpp"
 #include "NMEA/Info.hpp"
 #include "NMEA/InputLine.hpp"
+#include "NMEA/Tag.hpp"
 #include "NMEA/Checksum.hpp"
 #include "Units/System.hpp"
 #include "Atmosphere/Temperature.hpp"
@@ -254,12 +255,16 @@ FlytecDevice::ParseNMEA(const char *_line, NMEAInfo &info)
   char type[16];
   line.Read(type, 16);
 
-  if (StringIsEqual(type, "$BRSF"))
+  switch (NMEATag(type)) {
+  case NMEATag("$BRSF"):
     return FlytecParseBRSF(line, info);
-  else if (StringIsEqual(type, "$VMVABD"))
+
+  case NMEATag("$VMVABD"):
     return FlytecParseVMVABD(line, info);
-  else if (StringIsEqual(type, "$FLYSEN"))
+
+  case NMEATag("$FLYSEN"):
     return ParseFLYSEN(line, info);
-  else
-    return false;
+  }
+
+  return false;
 }
@@ -26,6 +26,7 @@ Copyright_License {
 #include "Device/Driver.hpp"
 #include "NMEA/Info.hpp"
 #include "NMEA/InputLine.hpp"
+#include "NMEA/Tag.hpp"
 #include "Units/System.hpp"
 #include "Atmosphere/Temperature.hpp"
 
@@ -212,17 +213,19 @@ LeonardoDevice::ParseNMEA(const char *_line, NMEAInfo &info)
   char type[16];
   line.Read(type, 16);
 
-  if (StringIsEqual(type, "$C") ||
-      StringIsEqual(type, "$c"))
+  switch (NMEATag(type)) {
+  case NMEATag("$C"):
+  case NMEATag("$c"):
     return LeonardoParseC(line, info);
 
-  else if (StringIsEqual(type, "$D") ||
-           StringIsEqual(type, "$d"))
+  case NMEATag("$D"):
+  case NMEATag("$d"):
     return LeonardoParseD(line, info);
 
-  else if (StringIsEqual(type, "$PDGFTL1") ||
-           StringIsEqual(type, "$PDGFTTL"))
+  case NMEATag("$PDGFTL1"):
+  case NMEATag("$PDGFTTL"):
     return PDGFTL1(line, info);
+  }
 
   return false;
 }
@@ -26,6 +26,7 @@ Copyright_License {
 #include "Device/Util/NMEAWriter.hpp"
 #include "NMEA/Info.hpp"
 #include "NMEA/InputLine.hpp"
+#include "NMEA/Tag.hpp"
 #include "NMEA/Checksum.hpp"
 
 #include <stdint.h>
@@ -165,14 +166,18 @@ VaulterDevice::ParseNMEA(const char *_line, NMEAInfo &info)
   char type[16];
   line.Read(type, 16);
 
-  if (StringIsEqual(type, "$PITV3"))
+  switch (NMEATag(type)) {
+  case NMEATag("$PITV3"):
     return ParsePITV3(line, info);
-  else if (StringIsEqual(type, "$PITV4"))
+
+  case NMEATag("$PITV4"):
     return ParsePITV4(line, info);
-  else if (StringIsEqual(type, "$PITV5"))
+
+  case NMEATag("$PITV5"):
     return ParsePITV5(line, info);
-  else
-    return false;
+  }
+
+  return false;
 }
 
 static Device *
@@ -25,6 +25,7 @@ Copyright_License {
 #include "Message.hpp"
 #include "NMEA/Info.hpp"
 #include "NMEA/InputLine.hpp"
+#include "NMEA/Tag.hpp"
 #include "Compiler.h"
 #include "Util/Macros.hpp"
 
@@ -226,26 +227,36 @@ VegaDevice::ParseNMEA(const char *String, NMEAInfo &info)
   if (memcmp(type, "$PD", 3) == 0)
     detected = true;
 
-  if (StringIsEqual(type, "$PDSWC"))
+  switch (NMEATag(type)) {
+  case NMEATag("$PDSWC"):
     return PDSWC(line, info, volatile_data);
-  else if (StringIsEqual(type, "$PDAAV"))
+
+  case NMEATag("$PDAAV"):
     return PDAAV(line, info);
-  else if (StringIsEqual(type, "$PDVSC"))
+
+  case NMEATag("$PDVSC"):
     return PDVSC(line, info);
-  else if (StringIsEqual(type, "$PDVDV"))
+
+  case NMEATag("$PDVDV"):
     return PDVDV(line, info);
-  else if (StringIsEqual(type, "$PDVDS"))
+
+  case NMEATag("$PDVDS"):
     return PDVDS(line, info);
-  else if (StringIsEqual(type, "$PDVVT"))
+
+  case NMEATag("$PDVVT"):
     return PDVVT(line, info);
-  else if (StringIsEqual(type, "$PDVSD")) {
+
+  case NMEATag("$PDVSD"): {
     const auto message = line.Rest();
     StaticString<256> buffer;
     buffer.SetASCII(message.begin(), message.end());
     Message::AddMessage(buffer);
     return true;
-  } else if (StringIsEqual(type, "$PDTSM"))
+  }
+
+  case NMEATag("$PDTSM"):
     return PDTSM(line, info);
-  else
-    return false;
+  }
+
+  return false;
 }
@@ -25,6 +25,7 @@ Copyright_License {
 #include "Device/Driver.hpp"
 #include "NMEA/Info.hpp"
 #include "NMEA/InputLine.hpp"
+#include "NMEA/Tag.hpp"
 #include "NMEA/Checksum.hpp"
 #include "Units/System.hpp"
 #include "Util/StringAPI.hxx"
@@ -137,20 +138,22 @@ ZanderDevice::ParseNMEA(const char *String, NMEAInfo &info)
   char type[16];
   line.Read(type, 16);
 
-  if (StringIsEqual(type, "$PZAN1"))
+  switch (NMEATag(type)) {
+  case NMEATag("$PZAN1"):
     return PZAN1(line, info);
 
-  if (StringIsEqual(type, "$PZAN2"))
+  case NMEATag("$PZAN2"):
     return PZAN2(line, info);
 
-  if (StringIsEqual(type, "$PZAN3"))
+  case NMEATag("$PZAN3"):
     return PZAN3(line, info);
 
-  if (StringIsEqual(type, "$PZAN4"))
+  case NMEATag("$PZAN4"):
     return PZAN4(line, info);
 
-  if (StringIsEqual(type, "$PZAN5"))
+  case NMEATag("$PZAN5"):
     return PZAN5(line, info);
+  }
 
   return false;
 }
@@ -29,7 +29,7 @@ Copyright_License {
 #include "NMEA/Info.hpp"
 #include "NMEA/Checksum.hpp"
 #include "NMEA/InputLine.hpp"
-#include "Util/StringUtil.hpp"
+#include "NMEA/Tag.hpp"
 #include "Units/System.hpp"
 #include "Driver/FLARM/StaticParser.hpp"
 
@@ -63,52 +63,53 @@ NMEAParser::ParseLine(const char *string, NMEAInfo &info)
   line.Read(type, 16);
 
   if (IsAlphaASCII(type[1]) && IsAlphaASCII(type[2])) {
-    if (StringIsEqual(type + 3, "GSA"))
+    /* skip the talker id */
+    switch (NMEATag(type + 3)) {
+    case NMEATag("GSA"):
       return GSA(line, info);
 
-    if (StringIsEqual(type + 3, "GLL"))
+    case NMEATag("GLL"):
       return GLL(line, info);
 
-    if (StringIsEqual(type + 3, "RMC"))
+    case NMEATag("RMC"):
       return RMC(line, info);
 
-    if (StringIsEqual(type + 3, "GGA"))
+    case NMEATag("GGA"):
       return GGA(line, info);
 
-    if (StringIsEqual(type + 3, "HDM"))
+    case NMEATag("HDM"):
       return HDM(line, info);
+    }
   }
 
   // if (proprietary sentence) ...
   if (type[1] == 'P') {
+    switch (NMEATag(type + 1)) {
     // Airspeed and vario sentence
-    if (StringIsEqual(type + 1, "PTAS1"))
+    case NMEATag("PTAS1"):
       return PTAS1(line, info);
 
     // FLARM sentences
-    if (StringIsEqual(type + 1, "PFLAE")) {
+    case NMEATag("PFLAE"):
       ParsePFLAE(line, info.flarm.error, info.clock);
       return true;
-    }
 
-    if (StringIsEqual(type + 1, "PFLAV")) {
+    case NMEATag("PFLAV"):
       ParsePFLAV(line, info.flarm.version, info.clock);
       return true;
-    }
 
-    if (StringIsEqual(type + 1, "PFLAA")) {
+    case NMEATag("PFLAA"):
       ParsePFLAA(line, info.flarm.traffic, info.clock);
       return true;
-    }
 
-    if (StringIsEqual(type + 1, "PFLAU")) {
+    case NMEATag("PFLAU"):
       ParsePFLAU(line, info.flarm.status, info.clock);
       return true;
-    }
 
     // Garmin altitude sentence
-    if (StringIsEqual(type + 1, "PGRMZ"))
+    case NMEATag("PGRMZ"):
       return RMZ(line, info);
+    }
 
     return false;
   }
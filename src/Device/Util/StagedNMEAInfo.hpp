@@ -0,0 +1,126 @@
+/*
+  Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_DEVICE_STAGED_NMEA_INFO_HPP
+#define XCSOAR_DEVICE_STAGED_NMEA_INFO_HPP
+
+#include "NMEA/Info.hpp"
+#include "Thread/Mutex.hpp"
+
+#include <assert.h>
+
+/**
+ * A private copy of one device's #NMEAInfo, which the port thread
+ * parses a batch of lines into without holding the lock which
+ * protects the shared copy.  The shared copy is read when the batch
+ * begins and is replaced when it ends, so the lock is held for two
+ * copies per batch instead of for parsing each line.
+ *
+ * Modifications of the shared copy by other threads while a batch is
+ * in progress get lost; this is only acceptable for data which is
+ * derived from the parsed values, such as expiry.
+ */
+class StagedNMEAInfo {
+  NMEAInfo info;
+
+  bool active = false, modified = false;
+
+public:
+  bool IsActive() const {
+    return active;
+  }
+
+  bool IsModified() const {
+    return modified;
+  }
+
+  /**
+   * Begin a new batch.  The caller must hold the lock protecting the
+   * shared copy.
+   */
+  NMEAInfo &Begin(const NMEAInfo &shared) {
+    assert(!active);
+
+    info = shared;
+    active = true;
+    modified = false;
+    return info;
+  }
+
+  NMEAInfo &Get() {
+    assert(active);
+
+    return info;
+  }
+
+  void SetModified() {
+    assert(active);
+
+    modified = true;
+  }
+
+  /**
+   * Finish the batch and publish the parsed data.  The caller must
+   * hold the lock protecting the shared copy.
+   */
+  void Commit(NMEAInfo &shared) {
+    assert(active);
+    assert(modified);
+
+    shared = info;
+    active = false;
+  }
+
+  /**
+   * Finish the batch without publishing; use this if nothing was
+   * modified.
+   */
+  void Cancel() {
+    assert(active);
+
+    active = false;
+  }
+
+  /**
+   * Finish the batch, if one is in progress.  If it has modified the
+   * staged copy, lock the mutex and publish it; otherwise the mutex
+   * is not touched.
+   *
+   * @return true if the shared copy has been replaced
+   */
+  bool Publish(Mutex &mutex, NMEAInfo &shared) {
+    if (!active)
+      return false;
+
+    if (!modified) {
+      Cancel();
+      return false;
+    }
+
+    const ScopeLock protect(mutex);
+    Commit(shared);
+    return true;
+  }
+};
+
+#endif
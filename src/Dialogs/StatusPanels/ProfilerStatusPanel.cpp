@@ -0,0 +1,119 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "ProfilerStatusPanel.hpp"
+#include "Profiler/Profiler.hpp"
+#include "Profiler/Statistics.hpp"
+#include "Profiler/Glue.hpp"
+#include "Dialogs/Message.hpp"
+#include "Form/Button.hpp"
+#include "Language/Language.hpp"
+#include "Util/StaticString.hxx"
+#include "Util/ConvertString.hpp"
+
+enum Controls {
+  ENABLE,
+  TRACE,
+  SPANS,
+};
+
+void
+ProfilerStatusPanel::Refresh()
+{
+  const bool enabled = Profiler::IsEnabled();
+
+  ((Button &)GetRow(ENABLE)).SetCaption(enabled
+                                        ? _("Disable profiler")
+                                        : _("Enable profiler"));
+  ((Button &)GetRow(TRACE)).SetCaption(ProfilerGlue::IsTracing()
+                                       ? _("Stop trace")
+                                       : _("Start trace"));
+
+  if (!enabled) {
+    SetMultiLineText(SPANS, _T(""));
+    return;
+  }
+
+  StaticString<2048> text;
+  text.Format(_T("%s: p50 / p95 / p99 [ms]\n"), _("Span"));
+
+  for (const auto &i : Profiler::CalculateStatistics())
+    text.AppendFormat(_T("%s: %.1f / %.1f / %.1f (%u)\n"),
+                      (const TCHAR *)UTF8ToWideConverter(i.name),
+                      i.p50 / 1000., i.p95 / 1000., i.p99 / 1000.,
+                      i.count);
+
+  SetMultiLineText(SPANS, text);
+}
+
+void
+ProfilerStatusPanel::Prepare(ContainerWindow &parent, const PixelRect &rc)
+{
+  AddButton(_("Enable profiler"), *this, ENABLE);
+  AddButton(_("Start trace"), *this, TRACE);
+  AddMultiLine();
+}
+
+void
+ProfilerStatusPanel::Show(const PixelRect &rc)
+{
+  StatusPanel::Show(rc);
+  Timer::Schedule(1000);
+}
+
+void
+ProfilerStatusPanel::Hide()
+{
+  Timer::Cancel();
+  StatusPanel::Hide();
+}
+
+void
+ProfilerStatusPanel::OnAction(int id)
+{
+  switch (id) {
+  case ENABLE:
+    if (Profiler::IsEnabled()) {
+      ProfilerGlue::StopTrace();
+      Profiler::SetEnabled(false);
+    } else
+      Profiler::SetEnabled(true);
+    break;
+
+  case TRACE:
+    if (ProfilerGlue::IsTracing())
+      ProfilerGlue::StopTrace();
+    else if (!ProfilerGlue::StartTrace())
+      ShowMessageBox(_("Failed to create the trace file."), _("Profiler"),
+                     MB_OK | MB_ICONERROR);
+    break;
+  }
+
+  Refresh();
+}
+
+void
+ProfilerStatusPanel::OnTimer()
+{
+  Refresh();
+}
@@ -0,0 +1,57 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_PROFILER_STATUS_PANEL_HPP
+#define XCSOAR_PROFILER_STATUS_PANEL_HPP
+
+#include "StatusPanel.hpp"
+#include "Form/ActionListener.hpp"
+#include "Event/Timer.hpp"
+
+/**
+ * Shows the duration percentiles of the spans recorded by the
+ * profiler, and allows switching the profiler and the trace file on
+ * and off.
+ */
+class ProfilerStatusPanel final
+  : public StatusPanel, ActionListener, Timer {
+public:
+  ProfilerStatusPanel(const DialogLook &look):StatusPanel(look) {}
+
+  /* virtual methods from class StatusPanel */
+  void Refresh() override;
+
+  /* virtual methods from class Widget */
+  void Prepare(ContainerWindow &parent, const PixelRect &rc) override;
+  void Show(const PixelRect &rc) override;
+  void Hide() override;
+
+private:
+  /* virtual methods from class ActionListener */
+  void OnAction(int id) override;
+
+  /* virtual methods from class Timer */
+  void OnTimer() override;
+};
+
+#endif
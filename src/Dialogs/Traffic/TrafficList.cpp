@@ -662,14 +662,14 @@ TrafficListWidget::OnPaintItem(Canvas &canvas, const PixelRect rc,
     if (!record->pilot.empty())
       tmp = record->pilot.c_str();
 
-    if (!record->plane_type.empty()) {
+    if (!StringIsEmpty(record->plane_type)) {
       if (!tmp.empty())
         tmp.append(_T(" - "));
 
       tmp.append(record->plane_type);
     }
 
-    if (!record->airfield.empty()) {
+    if (!StringIsEmpty(record->airfield)) {
       if (!tmp.empty())
         tmp.append(_T(" - "));
 
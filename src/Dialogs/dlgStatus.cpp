@@ -33,6 +33,7 @@ Copyright_License {
 #include "StatusPanels/RulesStatusPanel.hpp"
 #include "StatusPanels/SystemStatusPanel.hpp"
 #include "StatusPanels/TimesStatusPanel.hpp"
+#include "StatusPanels/ProfilerStatusPanel.hpp"
 #include "Components.hpp"
 #include "Engine/Waypoint/Waypoints.hpp"
 #include "Interface.hpp"
@@ -103,6 +104,9 @@ dlgStatusShowModal(int start_page)
   Widget *times_panel = new TimesStatusPanel(look);
   widget.AddTab(times_panel, _("Times"), TimesIcon);
 
+  Widget *profiler_panel = new ProfilerStatusPanel(look);
+  widget.AddTab(profiler_panel, _("Profiler"), nullptr);
+
   /* restore previous page */
 
   if (start_page != -1) {
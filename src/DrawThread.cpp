@@ -27,6 +27,7 @@ Copyright_License {
 
 #include "MapWindow/GlueMapWindow.hpp"
 #include "Hardware/CPU.hpp"
+#include "Profiler/Profiler.hpp"
 
 /**
  * Main loop of the DrawThread
@@ -35,6 +36,7 @@ void
 DrawThread::Run()
 {
   SetLowPriority();
+  Profiler::RegisterThread("DrawThread");
 
   const ScopeLock lock(mutex);
 
@@ -53,7 +55,10 @@ DrawThread::Run()
     const ScopeLockCPU cpu;
 #endif
 
-    map.Idle();
+    {
+      const ProfileScope scope("MapIdle");
+      map.Idle();
+    }
 
     // Get data from the DeviceBlackboard
     map.ExchangeBlackboard();
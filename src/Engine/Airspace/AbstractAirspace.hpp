@@ -231,6 +231,13 @@ public:
     days_of_operation = mask;
   }
 
+  /**
+   * Get the days of operation of the airspace
+   */
+  AirspaceActivity GetDays() const {
+    return days_of_operation;
+  }
+
   /**
    * Get type of airspace
    *
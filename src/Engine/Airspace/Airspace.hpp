@@ -63,6 +63,15 @@ public:
   Airspace(AbstractAirspace &airspace,
            const FlatProjection &projection);
 
+  /**
+   * Constructor for airspaces whose border has already been
+   * projected.
+   *
+   * @param box the bounding box of the projected border
+   */
+  Airspace(AbstractAirspace &_airspace, const FlatBoundingBox &box)
+    :FlatBoundingBox(box), airspace(&_airspace) {}
+
   /**
    * Constructor for virtual airspaces for use in range-based
    * intersection queries
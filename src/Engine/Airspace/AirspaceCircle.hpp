@@ -48,6 +48,13 @@ public:
    */
   AirspaceCircle(const GeoPoint &loc, const fixed _radius);
 
+  /**
+   * Constructor for a circle whose border polygon has already been
+   * calculated and projected, e.g. one which was loaded from a cache.
+   */
+  AirspaceCircle(const GeoPoint &loc, const fixed _radius,
+                 SearchPointVector &&border);
+
   /* virtual methods from class AbstractAirspace */
   const GeoPoint GetReferenceLocation() const override {
     return m_center;
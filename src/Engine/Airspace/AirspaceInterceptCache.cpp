@@ -0,0 +1,100 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+ */
+
+#include "AirspaceInterceptCache.hpp"
+#include "Navigation/Aircraft.hpp"
+
+/** Maximum altitude change (m) before an entry becomes invalid */
+static constexpr fixed ALTITUDE_TOLERANCE(20);
+
+/** Maximum ground speed change (m/s) before an entry becomes invalid */
+static constexpr fixed SPEED_TOLERANCE(2);
+
+/** Maximum track change before an entry becomes invalid */
+static constexpr Angle TRACK_TOLERANCE = Angle::Degrees(10);
+
+bool
+AirspaceInterceptCache::IsUnchanged(const AbstractAirspace &airspace,
+                                    AirspaceWarning::State warning_state,
+                                    const AircraftState &state,
+                                    fixed max_time) const
+{
+  const auto i = entries.find(Key(&airspace, warning_state));
+  if (i == entries.end())
+    return false;
+
+  const Entry &entry = i->second;
+
+  const auto age = state.time - entry.time;
+  if (negative(age) || age >= fixed(MAX_AGE))
+    return false;
+
+  if (fabs(state.altitude - entry.altitude) > ALTITUDE_TOLERANCE ||
+      fabs(state.ground_speed - entry.ground_speed) > SPEED_TOLERANCE ||
+      !state.track.CompareRoughly(entry.track, TRACK_TOLERANCE))
+    return false;
+
+  if (!entry.solution.IsValid())
+    /* no intercept was possible at all; that can only change with
+       the altitude, speed or track */
+    return true;
+
+  /* the intercept was beyond the time limit; in steady flight, it
+     comes closer by one second per second.  Use only half of the
+     margin, to absorb changes of the vertical speed. */
+  const auto time_margin = (entry.solution.elapsed_time - max_time) / 2;
+  if (age >= time_margin)
+    return false;
+
+  /* the distance the aircraft can fly towards the intercept before
+     it gets within reach */
+  const auto distance_margin = entry.solution.distance * time_margin
+    / entry.solution.elapsed_time;
+  return state.location.Distance(entry.location) < distance_margin;
+}
+
+void
+AirspaceInterceptCache::Put(const AbstractAirspace &airspace,
+                            AirspaceWarning::State warning_state,
+                            const AircraftState &state,
+                            const AirspaceInterceptSolution &solution)
+{
+  Entry &entry = entries[Key(&airspace, warning_state)];
+  entry.location = state.location;
+  entry.time = state.time;
+  entry.altitude = state.altitude;
+  entry.ground_speed = state.ground_speed;
+  entry.track = state.track;
+  entry.solution = solution;
+}
+
+void
+AirspaceInterceptCache::Expire(const AircraftState &state)
+{
+  for (auto i = entries.begin(), end = entries.end(); i != end;) {
+    const auto age = state.time - i->second.time;
+    if (negative(age) || age >= fixed(MAX_AGE))
+      i = entries.erase(i);
+    else
+      ++i;
+  }
+}
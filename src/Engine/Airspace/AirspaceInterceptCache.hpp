@@ -0,0 +1,115 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+ */
+#ifndef AIRSPACE_INTERCEPT_CACHE_HPP
+#define AIRSPACE_INTERCEPT_CACHE_HPP
+
+#include "AirspaceWarning.hpp"
+#include "AirspaceInterceptSolution.hpp"
+#include "Geo/GeoPoint.hpp"
+#include "Math/Angle.hpp"
+#include "Compiler.h"
+
+#include <map>
+#include <utility>
+
+struct AircraftState;
+class AbstractAirspace;
+
+/**
+ * Remembers the intercept solutions of airspaces which did not cause
+ * a predicted warning, together with the aircraft state they were
+ * calculated for.  #AirspaceWarningManager uses it to skip airspaces
+ * whose result cannot change until the aircraft has used up the
+ * margin (in time and distance) between the old solution and the
+ * warning threshold.
+ *
+ * An entry is only valid while the aircraft's altitude, speed and
+ * track stay close to the values it was recorded with, and never
+ * longer than #MAX_AGE.  The caller must Clear() the cache when the
+ * airspaces or the aircraft performance model change.
+ */
+class AirspaceInterceptCache {
+  /**
+   * Upper limit for the age of an entry (s).
+   */
+  static constexpr unsigned MAX_AGE = 10;
+
+  struct Entry {
+    /** The aircraft state the solution was calculated for */
+    GeoPoint location;
+    fixed time, altitude, ground_speed;
+    Angle track;
+
+    /** The intercept solution; may be invalid */
+    AirspaceInterceptSolution solution;
+  };
+
+  typedef std::pair<const AbstractAirspace *, AirspaceWarning::State> Key;
+
+  std::map<Key, Entry> entries;
+
+public:
+  bool empty() const {
+    return entries.empty();
+  }
+
+  void Clear() {
+    entries.clear();
+  }
+
+  /**
+   * Is the given airspace known to cause no warning of the given
+   * type, and can that result not have changed yet?
+   *
+   * @param max_time the current time limit of intercepts (s)
+   */
+  gcc_pure
+  bool IsUnchanged(const AbstractAirspace &airspace,
+                   AirspaceWarning::State warning_state,
+                   const AircraftState &state, fixed max_time) const;
+
+  /**
+   * Remember that the airspace caused no warning of the given type.
+   *
+   * @param solution the intercept solution which was rejected; may
+   * be invalid
+   */
+  void Put(const AbstractAirspace &airspace,
+           AirspaceWarning::State warning_state,
+           const AircraftState &state,
+           const AirspaceInterceptSolution &solution);
+
+  /**
+   * Forget the given airspace, e.g. because it caused a warning.
+   */
+  void Remove(const AbstractAirspace &airspace,
+              AirspaceWarning::State warning_state) {
+    entries.erase(Key(&airspace, warning_state));
+  }
+
+  /**
+   * Remove all entries which are too old to be used.
+   */
+  void Expire(const AircraftState &state);
+};
+
+#endif
@@ -29,6 +29,7 @@
 struct AircraftState;
 struct AirspaceInterceptSolution;
 class AirspaceAircraftPerformance;
+class AbstractAirspace;
 
 /**
  * Generic visitor for objects in the Airspaces container,
@@ -55,6 +56,17 @@ public:
     return !intersections.empty();
   }
 
+  /**
+   * Called by Airspaces before the (expensive) intersection test.
+   * The default implementation returns false.
+   *
+   * @return true if the airspace shall not be visited, because the
+   * visitor knows the result already
+   */
+  virtual bool Skip(const AbstractAirspace &as) {
+    return false;
+  }
+
 protected:
   /**
    * Find intercept solution of intersections
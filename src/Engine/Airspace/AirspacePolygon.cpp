@@ -53,6 +53,15 @@ AirspacePolygon::AirspacePolygon(const std::vector<GeoPoint> &pts,
   }
 }
 
+AirspacePolygon::AirspacePolygon(SearchPointVector &&border)
+  :AbstractAirspace(Shape::POLYGON)
+{
+  assert(border.size() >= 3);
+
+  m_border = std::move(border);
+  is_convex = TriState::UNKNOWN;
+}
+
 const GeoPoint
 AirspacePolygon::GetReferenceLocation() const
 {
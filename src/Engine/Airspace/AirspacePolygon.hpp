@@ -44,6 +44,12 @@ public:
    */
   AirspacePolygon(const std::vector<GeoPoint> &pts, const bool prune = false);
 
+  /**
+   * Constructor for a border which is already closed and projected,
+   * e.g. one which was loaded from a cache.
+   */
+  explicit AirspacePolygon(SearchPointVector &&border);
+
   /* virtual methods from class AbstractAirspace */
   const GeoPoint GetReferenceLocation() const override;
   const GeoPoint GetCenter() const override;
@@ -58,11 +58,19 @@ AirspaceWarningManager::SetConfig(const AirspaceWarningConfig &_config)
   }
 }
 
+void
+AirspaceWarningManager::SetIncremental(bool _incremental)
+{
+  incremental = _incremental;
+  intercept_cache.Clear();
+}
+
 void
 AirspaceWarningManager::Reset(const AircraftState &state)
 {
   ++serial;
   warnings.clear();
+  intercept_cache.Clear();
   cruise_filter.Reset(state);
   circling_filter.Reset(state);
 }
@@ -71,12 +79,14 @@ void
 AirspaceWarningManager::SetPredictionTimeGlide(fixed time)
 {
   prediction_time_glide = time;
+  intercept_cache.Clear();
 }
 
 void 
 AirspaceWarningManager::SetPredictionTimeFilter(fixed time)
 {
   prediction_time_filter = time;
+  intercept_cache.Clear();
   cruise_filter.Design(std::max(fixed(10),
                                 prediction_time_filter * CRUISE_FILTER_FACT));
   circling_filter.Design(std::max(fixed(10), prediction_time_filter));
@@ -130,6 +140,26 @@ AirspaceWarningManager::Update(const AircraftState& state,
     return false;
   }
 
+  n_evaluated = n_skipped = 0;
+
+  if (incremental) {
+    if (airspaces.GetSerial() != cache_serial ||
+        glide_polar.GetMC() != cache_mc ||
+        glide_polar.GetBugs() != cache_bugs ||
+        glide_polar.GetBallast() != cache_ballast ||
+        circling != cache_circling) {
+      /* the cached solutions were calculated for other airspaces or
+         another performance model */
+      intercept_cache.Clear();
+      cache_serial = airspaces.GetSerial();
+      cache_mc = glide_polar.GetMC();
+      cache_bugs = glide_polar.GetBugs();
+      cache_ballast = glide_polar.GetBallast();
+      cache_circling = circling;
+    } else
+      intercept_cache.Expire(state);
+  }
+
   // save old state
   for (auto &w : warnings)
     w.SaveState();
@@ -168,11 +198,13 @@ class AirspaceIntersectionWarningVisitor final
   const AircraftState state;
   const AirspaceAircraftPerformance &perf;
   AirspaceWarningManager &warning_manager;
+  AirspaceInterceptCache *const cache;
   const AirspaceWarning::State warning_state;
   const fixed max_time;
   bool found;
   const fixed max_alt;
   bool mode_inside;
+  unsigned n_evaluated, n_skipped;
 
 public:
   /**
@@ -181,6 +213,7 @@ public:
    * @param state State of aircraft
    * @param perf Aircraft performance model
    * @param warning_manager Warning manager to add items to
+   * @param cache Cache of rejected intercepts (optional)
    * @param warning_state Type of warning
    * @param max_time Time limit of intercept
    * @param max_alt Maximum height of base to allow (optional)
@@ -190,17 +223,20 @@ public:
   AirspaceIntersectionWarningVisitor(const AircraftState &_state,
                                      const AirspaceAircraftPerformance &_perf,
                                      AirspaceWarningManager &_warning_manager,
+                                     AirspaceInterceptCache *_cache,
                                      const AirspaceWarning::State _warning_state,
                                      const fixed _max_time,
                                      const fixed _max_alt = fixed(-1)):
     state(_state),
     perf(_perf),
     warning_manager(_warning_manager),
+    cache(_cache),
     warning_state(_warning_state),
     max_time(_max_time),
     found(false),
     max_alt(_max_alt),
-    mode_inside(false)
+    mode_inside(false),
+    n_evaluated(0), n_skipped(0)
     {      
     };
 
@@ -226,6 +262,16 @@ public:
         airspace.Intercept(state, perf, solution, state.location, state.location);
       } else {
         solution = Intercept(airspace, state, perf);
+        ++n_evaluated;
+
+        if (cache != nullptr) {
+          if (!solution.IsValid() || solution.elapsed_time > max_time) {
+            cache->Put(airspace, warning_state, state, solution);
+            return;
+          }
+
+          cache->Remove(airspace, warning_state);
+        }
       }
       if (!solution.IsValid())
         return;
@@ -240,6 +286,17 @@ public:
     }
   }
 
+  bool Skip(const AbstractAirspace &airspace) override {
+    /* only airspaces without a warning are in the cache */
+    if (cache == nullptr ||
+        warning_manager.GetWarningPtr(airspace) != nullptr ||
+        !cache->IsUnchanged(airspace, warning_state, state, max_time))
+      return false;
+
+    ++n_skipped;
+    return true;
+  }
+
   void Visit(const AbstractAirspace &as) override {
     Intersection(as);
   }
@@ -261,6 +318,14 @@ public:
     mode_inside = m;
   }
 
+  unsigned GetEvaluatedCount() const {
+    return n_evaluated;
+  }
+
+  unsigned GetSkippedCount() const {
+    return n_skipped;
+  }
+
 private:
   bool ExcludeAltitude(const AbstractAirspace& airspace) {
     if (!positive(max_alt))
@@ -296,12 +361,17 @@ AirspaceWarningManager::UpdatePredicted(const AircraftState& state,
     + fixed(std::max((unsigned)1000, config.altitude_warning_margin));
 
   AirspaceIntersectionWarningVisitor visitor(state, perf, 
-                                             *this, 
+                                             *this,
+                                             incremental
+                                             ? &intercept_cache : nullptr,
                                              warning_state, max_time_limit,
                                              ceiling);
 
   airspaces.VisitIntersecting(state.location, location_predicted, visitor);
 
+  n_evaluated += visitor.GetEvaluatedCount();
+  n_skipped += visitor.GetSkippedCount();
+
   visitor.SetMode(true);
   airspaces.VisitInside(state.location, visitor);
 
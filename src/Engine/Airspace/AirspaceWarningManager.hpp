@@ -24,7 +24,9 @@
 
 #include "AirspaceWarning.hpp"
 #include "AirspaceWarningConfig.hpp"
+#include "AirspaceInterceptCache.hpp"
 #include "Util/AircraftStateFilter.hpp"
+#include "Util/Serial.hpp"
 #include "Compiler.h"
 
 #include <list>
@@ -66,6 +68,32 @@ class AirspaceWarningManager {
    */
   unsigned serial;
 
+  /**
+   * Skip predicted intercepts which cannot have changed since the
+   * previous Update() call?
+   */
+  bool incremental = true;
+
+  /**
+   * Remembers airspaces which caused no predicted warning, see
+   * #incremental.
+   */
+  AirspaceInterceptCache intercept_cache;
+
+  /**
+   * The parameters #intercept_cache was filled with.  It is cleared
+   * when one of them changes.
+   */
+  Serial cache_serial;
+  fixed cache_mc = fixed(-1), cache_bugs = fixed(-1), cache_ballast = fixed(-1);
+  bool cache_circling = false;
+
+  /**
+   * The number of predicted intercepts which were calculated and
+   * skipped during the last Update() call.
+   */
+  unsigned n_evaluated = 0, n_skipped = 0;
+
 public:
   typedef AirspaceWarningList::const_iterator const_iterator;
 
@@ -89,6 +117,35 @@ public:
 
   void SetConfig(const AirspaceWarningConfig &_config);
 
+  bool IsIncremental() const {
+    return incremental;
+  }
+
+  /**
+   * Enable or disable the incremental mode.  In this mode, airspaces
+   * which did not cause a predicted warning are not evaluated again
+   * until the aircraft state has changed enough to make a difference
+   * (see #AirspaceInterceptCache).
+   */
+  void SetIncremental(bool _incremental);
+
+  /**
+   * Returns the number of airspaces whose predicted intercept was
+   * calculated during the last Update() call.
+   */
+  unsigned GetEvaluatedCount() const {
+    return n_evaluated;
+  }
+
+  /**
+   * Returns the number of airspaces which were skipped during the
+   * last Update() call, because their previous result was still
+   * valid.
+   */
+  unsigned GetSkippedCount() const {
+    return n_skipped;
+  }
+
   /**
    * Returns a serial for the current state.  The serial gets
    * incremented each time the list of warnings is modified.
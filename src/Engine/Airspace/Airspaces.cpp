@@ -30,12 +30,38 @@
 #include "Geo/Flat/TaskProjection.hpp"
 
 #include <functional>
+#include <algorithm>
+
+#include <assert.h>
 
 #ifdef INSTRUMENT_TASK
 extern unsigned n_queries;
 extern long count_intersections;
 #endif
 
+template<typename V>
+inline void
+Airspaces::VisitTree(const FlatBoundingBox &box, int range, V &visitor) const
+{
+  if (removed.empty())
+    airspace_tree.VisitWithinRange(box, range, visitor);
+  else
+    airspace_tree.VisitWithinRange(box, range, [this, &visitor](const Airspace &as){
+        if (!IsRemoved(as.GetAirspace()))
+          visitor(as);
+      });
+
+  if (!overflow.empty()) {
+    const FlatBoundingBox query(FlatGeoPoint(box.GetLeft() - range,
+                                             box.GetBottom() - range),
+                                FlatGeoPoint(box.GetRight() + range,
+                                             box.GetTop() + range));
+    for (const auto &as : overflow)
+      if (as.Overlaps(query))
+        visitor(as);
+  }
+}
+
 class AirspacePredicateVisitorAdapter {
   const AirspacePredicate *predicate;
   AirspaceVisitor *visitor;
@@ -45,7 +71,7 @@ public:
                                   AirspaceVisitor &_visitor)
     :predicate(&_predicate), visitor(&_visitor) {}
 
-  void operator()(Airspace as) {
+  void operator()(const Airspace &as) {
     AbstractAirspace &aas = as.GetAirspace();
     if (predicate->operator()(aas))
       visitor->Visit(as);
@@ -64,7 +90,7 @@ Airspaces::VisitWithinRange(const GeoPoint &location, fixed range,
   Airspace bb_target(location, task_projection);
   int projected_range = task_projection.ProjectRangeInteger(location, range);
   AirspacePredicateVisitorAdapter adapter(predicate, visitor);
-  airspace_tree.visit_within_range(bb_target, -projected_range, adapter);
+  VisitTree(bb_target, projected_range, adapter);
 
 #ifdef INSTRUMENT_TASK
   n_queries++;
@@ -86,8 +112,8 @@ public:
      ray(projection->ProjectInteger(start), projection->ProjectInteger(end)),
      visitor(&_visitor) {}
 
-  void operator()(Airspace as) {
-    if (as.Intersects(ray) &&
+  void operator()(const Airspace &as) {
+    if (as.Intersects(ray) && !visitor->Skip(as.GetAirspace()) &&
         visitor->SetIntersections(as.Intersects(start, end, *projection)))
       visitor->Visit(as);
   }
@@ -105,7 +131,7 @@ Airspaces::VisitIntersecting(const GeoPoint &loc, const GeoPoint &end,
   Airspace bb_target(c, task_projection);
   int projected_range = task_projection.ProjectRangeInteger(c, loc.Distance(end) / 2);
   IntersectingAirspaceVisitorAdapter adapter(loc, end, task_projection, visitor);
-  airspace_tree.visit_within_range(bb_target, -projected_range, adapter);
+  VisitTree(bb_target, projected_range, adapter);
 
 #ifdef INSTRUMENT_TASK
   n_queries++;
@@ -139,7 +165,7 @@ Airspaces::ScanRange(const GeoPoint &location, fixed range,
       res.push_back(v);
   };
 
-  airspace_tree.visit_within_range(bb_target, -projected_range, visitor);
+  VisitTree(bb_target, projected_range, visitor);
 
   return res;
 }
@@ -168,7 +194,7 @@ Airspaces::FindInside(const AircraftState &state,
       vectors.push_back(v);
   };
 
-  airspace_tree.visit_within_range(bb_target, 0, visitor);
+  VisitTree(bb_target, 0, visitor);
 
   return vectors;
 }
@@ -183,30 +209,77 @@ Airspaces::Optimise()
     // to re-build airspace envelopes
 
     for (const auto &i : airspace_tree)
+      if (!IsRemoved(i.GetAirspace()))
+        tmp_as.push_back(&i.GetAirspace());
+
+    for (const auto &i : overflow)
       tmp_as.push_back(&i.GetAirspace());
 
     airspace_tree.clear();
+    overflow.clear();
+    removed.clear();
   }
 
-  if (!tmp_as.empty()) {
-    while (!tmp_as.empty()) {
-      Airspace as(*tmp_as.front(), task_projection);
-      airspace_tree.insert(as);
-      tmp_as.pop_front();
-    }
-    airspace_tree.optimise();
+  if (!tmp_projected.empty() &&
+      task_projection.GetCenter() != projected_center) {
+    // the bounding boxes were calculated with a different projection
+    for (const auto &i : tmp_projected)
+      tmp_as.push_back(&i.GetAirspace());
+
+    tmp_projected.clear();
   }
 
+  if (!tmp_as.empty() || !tmp_projected.empty()) {
+    // the packed tree cannot be modified, so rebuild it with the
+    // existing and the new items
+    AirspaceVector items;
+    items.reserve(GetSize() + tmp_projected.size() + tmp_as.size());
+
+    for (const auto &i : airspace_tree)
+      if (!IsRemoved(i.GetAirspace()))
+        items.push_back(i);
+    removed.clear();
+
+    items.insert(items.end(), overflow.begin(), overflow.end());
+    overflow.clear();
+
+    items.insert(items.end(), tmp_projected.begin(), tmp_projected.end());
+    tmp_projected.clear();
+
+    for (AbstractAirspace *as : tmp_as)
+      items.emplace_back(*as, task_projection);
+    tmp_as.clear();
+
+    airspace_tree.Load(std::move(items));
+  } else
+    Merge();
+
   ++serial;
 }
 
 void
-Airspaces::Add(AbstractAirspace *airspace)
+Airspaces::Merge()
 {
-  if (!airspace)
-    // nothing to add
+  if (overflow.empty() && removed.empty())
     return;
 
+  AirspaceVector items;
+  items.reserve(GetSize());
+
+  for (const auto &i : airspace_tree)
+    if (!IsRemoved(i.GetAirspace()))
+      items.push_back(i);
+  removed.clear();
+
+  items.insert(items.end(), overflow.begin(), overflow.end());
+  overflow.clear();
+
+  airspace_tree.Load(std::move(items));
+}
+
+void
+Airspaces::OnAdd(const AbstractAirspace &airspace)
+{
   // reset QNH to zero so set_pressure_levels will be triggered next update
   // this allows for airspaces to be add at any time
   qnh = AtmosphericPressure::Zero();
@@ -217,14 +290,35 @@ Airspaces::Add(AbstractAirspace *airspace)
 
   if (owns_children) {
     if (IsEmpty())
-      task_projection.Reset(airspace->GetReferenceLocation());
+      task_projection.Reset(airspace.GetReferenceLocation());
 
-    task_projection.Scan(airspace->GetReferenceLocation());
+    task_projection.Scan(airspace.GetReferenceLocation());
   }
+}
 
+void
+Airspaces::Add(AbstractAirspace *airspace)
+{
+  if (!airspace)
+    // nothing to add
+    return;
+
+  OnAdd(*airspace);
   tmp_as.push_back(airspace);
 }
 
+void
+Airspaces::AddProjected(AbstractAirspace *airspace,
+                        const FlatBoundingBox &box, const GeoPoint &center)
+{
+  assert(airspace != nullptr);
+  assert(tmp_projected.empty() || center == projected_center);
+
+  OnAdd(*airspace);
+  projected_center = center;
+  tmp_projected.emplace_back(*airspace, box);
+}
+
 void
 Airspaces::Clear()
 {
@@ -237,28 +331,41 @@ Airspaces::Clear()
     tmp_as.pop_front();
   }
 
+  if (owns_children)
+    for (auto &i : tmp_projected)
+      i.Destroy();
+  tmp_projected.clear();
+
   // delete items in the tree
   if (owns_children) {
     for (const auto &i : airspace_tree) {
+      if (IsRemoved(i.GetAirspace()))
+        continue;
+
       Airspace a = i;
       a.Destroy();
     }
+
+    for (auto &i : overflow)
+      i.Destroy();
   }
 
   // then delete the tree
   airspace_tree.clear();
+  overflow.clear();
+  removed.clear();
 }
 
 unsigned
 Airspaces::GetSize() const
 {
-  return airspace_tree.size();
+  return airspace_tree.size() - removed.size() + overflow.size();
 }
 
 bool
 Airspaces::IsEmpty() const
 {
-  return airspace_tree.empty() && tmp_as.empty();
+  return GetSize() == 0 && tmp_as.empty() && tmp_projected.empty();
 }
 
 void
@@ -269,6 +376,8 @@ Airspaces::SetFlightLevels(const AtmosphericPressure &press)
 
     for (auto &v : airspace_tree)
       v.SetFlightLevel(press);
+    for (auto &v : overflow)
+      v.SetFlightLevel(press);
   }
 }
 
@@ -280,6 +389,8 @@ Airspaces::SetActivity(const AirspaceActivity mask)
 
     for (auto &v : airspace_tree)
       v.SetActivity(mask);
+    for (auto &v : overflow)
+      v.SetActivity(mask);
   }
 }
 
@@ -288,6 +399,8 @@ Airspaces::ClearClearances()
 {
   for (auto &v : airspace_tree)
     v.ClearClearance();
+  for (auto &v : overflow)
+    v.ClearClearance();
 }
 
 
@@ -299,17 +412,26 @@ Airspaces::SynchroniseInRange(const Airspaces &master,
 {
   qnh = master.qnh;
   activity_mask = master.activity_mask;
+
+  if (!IsEmpty() &&
+      task_projection.GetCenter() != master.task_projection.GetCenter()) {
+    /* our bounding boxes were calculated with another projection;
+       start from scratch */
+    ClearClearances();
+    Clear();
+  }
+
   task_projection = master.task_projection;
 
   bool changed = false;
   const AirspaceVector contents_master = master.ScanRange(location, range, condition);
   AirspaceVector contents_self;
-  contents_self.reserve(std::max(airspace_tree.size(), contents_master.size()));
-
-  task_projection = master.task_projection; // ensure these are up to date
+  contents_self.reserve(std::max(GetSize(), unsigned(contents_master.size())));
 
   for (const auto &v : airspace_tree)
-    contents_self.push_back(v);
+    if (!IsRemoved(v.GetAirspace()))
+      contents_self.push_back(v);
+  contents_self.insert(contents_self.end(), overflow.begin(), overflow.end());
 
   // find items to add
   for (const auto &v : contents_master) {
@@ -325,33 +447,47 @@ Airspaces::SynchroniseInRange(const Airspaces &master,
       }
     }
     if (!found && other.IsActive()) {
-      Add(&v.GetAirspace());
+      /* both use the same projection, so the master's bounding box
+         is valid here */
+      OnAdd(other);
+      overflow.push_back(v);
       changed = true;
     }
   }
 
   // anything left in the self list are items that were not in the query,
   // so delete them --- including the clearances!
-  for (auto v = contents_self.begin(); v != contents_self.end();) {
-    gcc_unused bool found = false;
-    for (auto t = airspace_tree.begin(); t != airspace_tree.end(); ) {
-      if (&t->GetAirspace() == &v->GetAirspace()) {
-        AirspaceTree::const_iterator new_t = t;
-        ++new_t;
-        airspace_tree.erase_exact(*t);
-        t = new_t;
-        found = true;
-      } else {
-        ++t;
-      }
+  if (!contents_self.empty()) {
+    std::vector<const AbstractAirspace *> gone;
+    gone.reserve(contents_self.size());
+    for (const auto &v : contents_self) {
+      v.ClearClearance();
+      gone.push_back(&v.GetAirspace());
     }
-    assert(found);
-    v->ClearClearance();
-    v = contents_self.erase(v);
+    std::sort(gone.begin(), gone.end());
+
+    // drop them from the overflow list, and remember the others
+    // until the tree is rebuilt
+    const auto is_gone = [&gone](const Airspace &v){
+      return std::binary_search(gone.begin(), gone.end(), &v.GetAirspace());
+    };
+    for (const auto &v : airspace_tree)
+      if (is_gone(v))
+        removed.push_back(&v.GetAirspace());
+    std::sort(removed.begin(), removed.end());
+
+    overflow.erase(std::remove_if(overflow.begin(), overflow.end(), is_gone),
+                   overflow.end());
     changed = true;
   }
+
+  if (overflow.size() + removed.size() >
+      std::max(unsigned(MIN_PENDING_CHANGES),
+               unsigned(airspace_tree.size() / 4)))
+    Merge();
+
   if (changed)
-    Optimise();
+    ++serial;
   return changed;
 }
 
@@ -370,5 +506,5 @@ Airspaces::VisitInside(const GeoPoint &loc, AirspaceVisitor &visitor) const
       visitor.Visit(v);
   };
 
-  airspace_tree.visit_within_range(bb_target, 0, visitor2);
+  VisitTree(bb_target, 0, visitor2);
 }
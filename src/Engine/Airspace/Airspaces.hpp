@@ -32,34 +32,40 @@
 #include "Compiler.h"
 
 #include <deque>
+#include <algorithm>
+#include <vector>
 
 class RasterTerrain;
 class AirspaceVisitor;
 class AirspaceIntersectionVisitor;
 
 /**
- * Container for airspaces using kd-tree representation internally for
- * fast geospatial lookups.
+ * Container for airspaces using a packed R-tree representation
+ * internally for fast geospatial lookups.  The tree is rebuilt by
+ * Optimise() after airspaces have been added or removed.
  *
- * Complexity analysis (with kdtree):
+ * SynchroniseInRange() does not rebuild the tree for each change:
+ * added airspaces are kept in a small list which is scanned
+ * linearly, and removed ones are skipped, until there are enough
+ * changes to make a rebuild worthwhile.
+ *
+ * Complexity analysis (with R-tree, fan-out b):
+ *
+ *    Build:
+ *     O(n log(n))
  *
  *    Find within range (k points found):
- *     O(n^(3/4) + k)
+ *     O(log_b(n) + k) typical
  *
  *    Find intersecting:
- *     O(n^(3/4) + k)
- *
- *    Find nearest:
- *     O(log(n))
+ *     O(log_b(n) + k) typical
  *
- *  Without kd-tree:
+ *  Without R-tree:
  *
  *    Find within range:
  *     O(n)
  *    Find intersecting:
  *     O(n)
- *    Find nearest:
- *     O(n)
  */
 
 class Airspaces : public AirspacesInterface {
@@ -73,6 +79,34 @@ class Airspaces : public AirspacesInterface {
 
   std::deque<AbstractAirspace *> tmp_as;
 
+  /**
+   * Airspaces added by AddProjected() which are not yet in the tree.
+   */
+  std::deque<Airspace> tmp_projected;
+
+  /**
+   * The projection centre of the bounding boxes in #tmp_projected.
+   */
+  GeoPoint projected_center;
+
+  /**
+   * SynchroniseInRange() rebuilds the tree when the number of
+   * pending changes exceeds this, or a quarter of the tree size.
+   */
+  static constexpr unsigned MIN_PENDING_CHANGES = 16;
+
+  /**
+   * Airspaces added by SynchroniseInRange() which are not in the
+   * tree yet.  Queries scan them linearly.
+   */
+  AirspaceVector overflow;
+
+  /**
+   * Airspaces removed by SynchroniseInRange() which are still in the
+   * tree, sorted.  Queries skip them.
+   */
+  std::vector<const AbstractAirspace *> removed;
+
   /**
    * This attribute keeps track of changes to this project.  It is
    * used by the renderer cache.
@@ -115,6 +149,19 @@ public:
    */
   void Add(AbstractAirspace *asp);
 
+  /**
+   * Add an airspace whose border has already been projected, e.g. one
+   * loaded from a cache.  If Optimise() ends up with the same
+   * projection centre, the given bounding box is used as-is;
+   * otherwise the airspace is projected again.  All airspaces added
+   * between two Optimise() calls must use the same centre.
+   *
+   * @param box the bounding box of the projected border
+   * @param center the centre of the projection
+   */
+  void AddProjected(AbstractAirspace *asp, const FlatBoundingBox &box,
+                    const GeoPoint &center);
+
   /**
    * Re-organise the internal airspace tree after inserting/deleting.
    * Should be called after inserting/deleting airspaces prior to performing
@@ -131,7 +178,8 @@ public:
    * Size of airspace (in tree, not in temporary store) ---
    * must call optimise() before this for it to be accurate.
    *
-   * @return Number of airspaces in tree
+   * @return Number of airspaces in tree and in the list of airspaces
+   * added by SynchroniseInRange()
    */
   gcc_pure
   unsigned GetSize() const;
@@ -227,7 +275,9 @@ public:
                                         AirspacePredicate::always_true) const;
 
   /**
-   * Access first airspace in store, for use in iterators.
+   * Access first airspace in store, for use in iterators.  The
+   * pending changes of SynchroniseInRange() are only visible after
+   * Optimise().
    *
    * @return First airspace in store
    */
@@ -269,6 +319,36 @@ public:
                           const GeoPoint &location, fixed range,
                           const AirspacePredicate &condition =
                                 AirspacePredicate::always_true);
+
+private:
+  /**
+   * Common code for Add() and AddProjected().
+   */
+  void OnAdd(const AbstractAirspace &airspace);
+
+  /**
+   * Was the given airspace removed from the tree by
+   * SynchroniseInRange()?
+   */
+  gcc_pure
+  bool IsRemoved(const AbstractAirspace &airspace) const {
+    return !removed.empty() &&
+      std::binary_search(removed.begin(), removed.end(), &airspace);
+  }
+
+  /**
+   * Invoke the visitor for each airspace in the tree and in
+   * #overflow whose bounding box overlaps the given box grown by the
+   * given range, skipping the #removed ones.
+   */
+  template<typename V>
+  void VisitTree(const FlatBoundingBox &box, int range, V &visitor) const;
+
+  /**
+   * Rebuild the tree with the pending changes of
+   * SynchroniseInRange().  The bounding boxes are reused.
+   */
+  void Merge();
 };
 
 #endif
@@ -22,6 +22,9 @@
 
 #include "ContestManager.hpp"
 #include "Trace/Trace.hpp"
+#include "Util/Macros.hpp"
+
+#include <assert.h>
 
 ContestManager::ContestManager(const Contest _contest,
                                const Trace &trace_full,
@@ -117,6 +120,44 @@ RunContest(AbstractContest &_contest,
   return true;
 }
 
+bool
+ContestManager::RunContests(AbstractContest *const*contests, unsigned n,
+                            unsigned first_index, bool exhaustive)
+{
+  assert(first_index + n <= ARRAY_SIZE(stats.result));
+
+  if (parallel == nullptr || n < 2) {
+    bool retval = false;
+    for (unsigned i = 0; i < n; ++i)
+      retval |= RunContest(*contests[i], stats.result[first_index + i],
+                           stats.solution[first_index + i], exhaustive);
+    return retval;
+  }
+
+  /* each solver writes into its own slot of a private copy, which is
+     published when all of them are finished */
+  ContestStatistics tmp = stats;
+  bool found[ARRAY_SIZE(stats.result)];
+
+  parallel(n, [contests, first_index, exhaustive, &tmp, &found](unsigned i){
+      const unsigned j = first_index + i;
+      found[i] = RunContest(*contests[i], tmp.result[j], tmp.solution[j],
+                            exhaustive);
+    });
+
+  bool retval = false;
+  for (unsigned i = 0; i < n; ++i) {
+    if (found[i]) {
+      const unsigned j = first_index + i;
+      stats.result[j] = tmp.result[j];
+      stats.solution[j] = tmp.solution[j];
+      retval = true;
+    }
+  }
+
+  return retval;
+}
+
 bool
 ContestManager::UpdateIdle(bool exhaustive)
 {
@@ -151,12 +192,9 @@ ContestManager::UpdateIdle(bool exhaustive)
                          stats.solution[0], exhaustive);
     break;
 
-  case Contest::OLC_PLUS:
-    retval = RunContest(olc_classic, stats.result[0],
-                        stats.solution[0], exhaustive);
-
-    retval |= RunContest(olc_fai, stats.result[1],
-                         stats.solution[1], exhaustive);
+  case Contest::OLC_PLUS: {
+    AbstractContest *const contests[] = { &olc_classic, &olc_fai };
+    retval = RunContests(contests, ARRAY_SIZE(contests), 0, exhaustive);
 
     if (retval) {
       olc_plus.Feed(stats.result[0], stats.solution[0],
@@ -167,25 +205,28 @@ ContestManager::UpdateIdle(bool exhaustive)
     }
 
     break;
+  }
 
   case Contest::DMST:
     retval = RunContest(dmst_quad, stats.result[0],
                         stats.solution[0], exhaustive);
     break;
 
-  case Contest::XCONTEST:
-    retval = RunContest(xcontest_free, stats.result[0],
-                        stats.solution[0], exhaustive);
-    retval |= RunContest(xcontest_triangle, stats.result[1],
-                         stats.solution[1], exhaustive);
+  case Contest::XCONTEST: {
+    AbstractContest *const contests[] = {
+      &xcontest_free, &xcontest_triangle,
+    };
+    retval = RunContests(contests, ARRAY_SIZE(contests), 0, exhaustive);
     break;
+  }
 
-  case Contest::DHV_XC:
-    retval = RunContest(dhv_xc_free, stats.result[0],
-                        stats.solution[0], exhaustive);
-    retval |= RunContest(dhv_xc_triangle, stats.result[1],
-                         stats.solution[1], exhaustive);
+  case Contest::DHV_XC: {
+    AbstractContest *const contests[] = {
+      &dhv_xc_free, &dhv_xc_triangle,
+    };
+    retval = RunContests(contests, ARRAY_SIZE(contests), 0, exhaustive);
     break;
+  }
 
   case Contest::SIS_AT:
     retval = RunContest(sis_at, stats.result[0],
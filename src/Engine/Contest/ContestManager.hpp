@@ -36,6 +36,8 @@
 #include "Solvers/NetCoupe.hpp"
 #include "ContestStatistics.hpp"
 
+#include <functional>
+
 class Trace;
 
 /**
@@ -45,8 +47,24 @@ class ContestManager
 {
   friend class PrintHelper;
 
+public:
+  /**
+   * A function which invokes f(i) for each i in the range [0,n) and
+   * returns after all calls have finished.  The calls may run in
+   * parallel, e.g. RunParallel().
+   */
+  typedef void (*ParallelFunction)(unsigned n,
+                                   const std::function<void(unsigned)> &f);
+
+private:
   Contest contest;
 
+  /**
+   * If set, then independent solvers of the selected contest run in
+   * parallel.  See SetParallel().
+   */
+  ParallelFunction parallel = nullptr;
+
   ContestStatistics stats;
 
   OLCSprint olc_sprint;
@@ -96,6 +114,20 @@ public:
 
   void SetHandicap(unsigned handicap);
 
+  /**
+   * Run the independent solvers of a contest (e.g. the free distance
+   * and the triangle solver of XContest) in parallel, using the
+   * given function.  The solvers only read the #Trace objects, which
+   * must not be modified during UpdateIdle().  Their results are
+   * published in #ContestStatistics after all of them have finished.
+   *
+   * @param _parallel the function which runs the solvers, or nullptr
+   * to run them one after another on the calling thread
+   */
+  void SetParallel(ParallelFunction _parallel) {
+    parallel = _parallel;
+  }
+
   /**
    * Update internal states (non-essential) for housework,
    * or where functions are slow and would cause loss to real-time performance.
@@ -130,6 +162,16 @@ public:
   const ContestStatistics &GetStats() const {
     return stats;
   }
+
+private:
+  /**
+   * Run the given independent solvers, and store their results in
+   * #stats, beginning at the given index.
+   *
+   * @return true if at least one solver has found a new solution
+   */
+  bool RunContests(AbstractContest *const*contests, unsigned n,
+                   unsigned first_index, bool exhaustive);
 };
 
 #endif
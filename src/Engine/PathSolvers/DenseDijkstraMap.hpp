@@ -0,0 +1,249 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef DENSE_DIJKSTRA_MAP_HPP
+#define DENSE_DIJKSTRA_MAP_HPP
+
+#include "ScanTaskPoint.hpp"
+#include "Compiler.h"
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <iterator>
+
+#include <assert.h>
+#include <stddef.h>
+
+/**
+ * A "MapTemplate" for the #Dijkstra class which stores the edges of
+ * a #ScanTaskPoint search without hashing.  The values are stored in
+ * insertion order in a contiguous array, and a dense table indexed by
+ * stage number and point index locates them.  The table grows on
+ * demand and is kept between searches; a generation counter marks
+ * its slots obsolete, so Clear() does not need to touch it.
+ *
+ * Iterators remain valid when new values are inserted.
+ */
+struct DenseDijkstraMap {
+  template<typename Value>
+  class Bind {
+  public:
+    typedef std::pair<ScanTaskPoint, Value> value_type;
+
+  private:
+    typedef std::vector<value_type> EntryVector;
+
+    struct Slot {
+      /**
+       * The slot is only valid if this equals #Bind::generation.
+       */
+      unsigned generation;
+
+      /**
+       * The index in #entries.
+       */
+      unsigned position;
+    };
+
+    /**
+     * All values, in insertion order.
+     */
+    EntryVector entries;
+
+    /**
+     * The index table; the slot of a #ScanTaskPoint is at
+     * (stage_number * n_points + point_index).
+     */
+    std::vector<Slot> slots;
+
+    unsigned n_stages = 0, n_points = 0;
+
+    unsigned generation = 1;
+
+    template<typename V, typename E>
+    class Iterator {
+      friend class Bind;
+
+      E *entries;
+      size_t position;
+
+      Iterator(E &_entries, size_t _position)
+        :entries(&_entries), position(_position) {}
+
+    public:
+      typedef std::forward_iterator_tag iterator_category;
+      typedef V value_type;
+      typedef ptrdiff_t difference_type;
+      typedef V *pointer;
+      typedef V &reference;
+
+      Iterator() = default;
+
+      /**
+       * Allow converting a mutable iterator to a const one.
+       */
+      template<typename V2, typename E2>
+      Iterator(const Iterator<V2, E2> &other)
+        :entries(other.entries), position(other.position) {}
+
+      V &operator*() const {
+        return (*entries)[position];
+      }
+
+      V *operator->() const {
+        return &(*entries)[position];
+      }
+
+      Iterator &operator++() {
+        ++position;
+        return *this;
+      }
+
+      bool operator==(const Iterator &other) const {
+        return position == other.position;
+      }
+
+      bool operator!=(const Iterator &other) const {
+        return position != other.position;
+      }
+
+      template<typename V2, typename E2>
+      friend class Iterator;
+    };
+
+  public:
+    typedef Iterator<value_type, EntryVector> iterator;
+    typedef Iterator<const value_type, const EntryVector> const_iterator;
+
+    bool empty() const {
+      return entries.empty();
+    }
+
+    size_t size() const {
+      return entries.size();
+    }
+
+    iterator begin() {
+      return iterator(entries, 0);
+    }
+
+    iterator end() {
+      return iterator(entries, entries.size());
+    }
+
+    const_iterator begin() const {
+      return const_iterator(entries, 0);
+    }
+
+    const_iterator end() const {
+      return const_iterator(entries, entries.size());
+    }
+
+    void clear() {
+      entries.clear();
+
+      if (++generation == 0) {
+        /* wraparound: invalidate all slots explicitly */
+        std::fill(slots.begin(), slots.end(), Slot{0, 0});
+        generation = 1;
+      }
+    }
+
+    gcc_pure
+    iterator find(ScanTaskPoint p) {
+      const Slot *slot = FindSlot(p);
+      return slot != nullptr
+        ? iterator(entries, slot->position)
+        : end();
+    }
+
+    gcc_pure
+    const_iterator find(ScanTaskPoint p) const {
+      const Slot *slot = FindSlot(p);
+      return slot != nullptr
+        ? const_iterator(entries, slot->position)
+        : end();
+    }
+
+    /**
+     * Insert a new value.  Does nothing if the key exists already.
+     */
+    std::pair<iterator, bool> insert(const value_type &value) {
+      const ScanTaskPoint p = value.first;
+      if (p.GetStageNumber() >= n_stages || p.GetPointIndex() >= n_points)
+        Grow(p);
+
+      Slot &slot = GetSlot(p);
+      if (slot.generation == generation)
+        return std::make_pair(iterator(entries, slot.position), false);
+
+      slot.generation = generation;
+      slot.position = entries.size();
+      entries.push_back(value);
+      return std::make_pair(iterator(entries, slot.position), true);
+    }
+
+  private:
+    Slot &GetSlot(ScanTaskPoint p) {
+      assert(p.GetStageNumber() < n_stages);
+      assert(p.GetPointIndex() < n_points);
+
+      return slots[p.GetStageNumber() * n_points + p.GetPointIndex()];
+    }
+
+    gcc_pure
+    const Slot *FindSlot(ScanTaskPoint p) const {
+      if (p.GetStageNumber() >= n_stages || p.GetPointIndex() >= n_points)
+        return nullptr;
+
+      const Slot &slot =
+        slots[p.GetStageNumber() * n_points + p.GetPointIndex()];
+      return slot.generation == generation
+        ? &slot
+        : nullptr;
+    }
+
+    /**
+     * Enlarge the index table so it can hold the given point, and
+     * rebuild it from #entries.
+     */
+    void Grow(ScanTaskPoint p) {
+      n_stages = std::max(n_stages, p.GetStageNumber() + 1);
+      if (p.GetPointIndex() >= n_points)
+        n_points = std::max(std::max(n_points * 2, 64u),
+                            p.GetPointIndex() + 1);
+
+      slots.assign(n_stages * n_points, Slot{0, 0});
+      generation = 1;
+
+      for (unsigned i = 0, n = entries.size(); i < n; ++i) {
+        Slot &slot = GetSlot(entries[i].first);
+        slot.generation = generation;
+        slot.position = i;
+      }
+    }
+  };
+};
+
+#endif
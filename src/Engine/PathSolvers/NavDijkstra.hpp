@@ -25,11 +25,11 @@ Copyright_License {
 #define NAV_DIJKSTRA_HPP
 
 #include "Dijkstra.hpp"
+#include "DenseDijkstraMap.hpp"
 #include "ScanTaskPoint.hpp"
 #include "SolverResult.hpp"
 #include "Compiler.h"
 
-#include <unordered_map>
 #include <assert.h>
 
 /**
@@ -44,26 +44,7 @@ class NavDijkstra {
 protected:
   static constexpr unsigned MAX_STAGES = 32;
 
-  struct DijkstraMap {
-    struct Hash {
-      std::size_t operator()(ScanTaskPoint p) const {
-        return p.Key();
-      }
-    };
-
-    struct Equal {
-      std::size_t operator()(ScanTaskPoint a, ScanTaskPoint b) const {
-        return a.Key() == b.Key();
-      }
-    };
-
-    template<typename Value>
-    struct Bind : public std::unordered_map<ScanTaskPoint, Value,
-                                            Hash, Equal> {
-    };
-  };
-
-  typedef ::Dijkstra<ScanTaskPoint, DijkstraMap> Dijkstra;
+  typedef ::Dijkstra<ScanTaskPoint, DenseDijkstraMap> Dijkstra;
 
   Dijkstra dijkstra;
 
@@ -24,10 +24,14 @@ Copyright_License {
 #ifndef ASTAR_HPP
 #define ASTAR_HPP
 
+#include "GenerationHashTable.hpp"
 #include "Util/ReservablePriorityQueue.hpp"
 #include "Compiler.h"
 
-#include <unordered_map>
+#include <vector>
+#include <functional>
+
+#include <limits.h>
 
 #ifdef INSTRUMENT_TASK
 extern long count_astar_links;
@@ -73,31 +77,51 @@ struct AStarPriorityValue
  * AStar search algorithm, based on Dijkstra algorithm
  * Modifications by John Wharington to track optimal solution
  * @see http://en.giswiki.net/wiki/Dijkstra%27s_algorithm
+ *
+ * The value and the predecessor of each node are stored together in
+ * a #GenerationHashTable, which is kept between searches.
  */
 template <class Node, class Hash=std::hash<Node>,
           class KeyEqual=std::equal_to<Node>,
           bool m_min=true>
 class AStar
 {
-  typedef std::unordered_map<Node, AStarPriorityValue, Hash, KeyEqual> node_value_map;
-
-  typedef typename node_value_map::iterator node_value_iterator;
-  typedef typename node_value_map::const_iterator node_value_const_iterator;
-
-  typedef std::unordered_map<Node, Node, Hash, KeyEqual> node_parent_map;
+  struct Entry {
+    Node node;
+
+    /**
+     * The best predecessor found so far.
+     */
+    Node parent;
+
+    /**
+     * The value of the node.  It is updated by Push(), if a value
+     * lower than the current one is found.
+     */
+    AStarPriorityValue value;
+
+    Entry(const Node &_node, const Node &_parent,
+          const AStarPriorityValue &_value)
+      :node(_node), parent(_parent), value(_value) {}
+  };
 
-  typedef typename node_parent_map::iterator node_parent_iterator;
-  typedef typename node_parent_map::const_iterator node_parent_const_iterator;
+  struct GetEntryNode {
+    constexpr const Node &operator()(const Entry &entry) const {
+      return entry.node;
+    }
+  };
 
   struct NodeValue {
     AStarPriorityValue priority;
 
-    node_value_iterator iterator;
+    /**
+     * The index in #entries.
+     */
+    unsigned position;
 
     constexpr
-    NodeValue(const AStarPriorityValue &_priority,
-              node_value_iterator _iterator)
-      :priority(_priority), iterator(_iterator) {}
+    NodeValue(const AStarPriorityValue &_priority, unsigned _position)
+      :priority(_priority), position(_position) {}
   };
 
   struct Rank: public std::binary_function<NodeValue, NodeValue, bool>
@@ -109,23 +133,20 @@ class AStar
   };
 
   /**
-   * Stores the value of each node.  It is updated by push(), if a
-   * value lower than the current one is found.
+   * All nodes visited by this search, in insertion order.
    */
-  node_value_map node_values;
-
-  /**
-   * Stores the predecessor of each node.  It is maintained by
-   * set_predecessor().
-   */
-  node_parent_map node_parents;
+  GenerationHashTable<Entry, Node, GetEntryNode, Hash, KeyEqual> entries;
 
   /**
    * A sorted list of all possible node paths, lowest distance first.
    */
   reservable_priority_queue<NodeValue, std::vector<NodeValue>, Rank> q;
 
-  node_value_iterator cur;
+  /**
+   * The index of the node returned by the last Pop() call in
+   * #entries, or UINT_MAX.
+   */
+  unsigned cur = UINT_MAX;
 
 public:
   static constexpr unsigned DEFAULT_QUEUE_SIZE = 1024;
@@ -167,10 +188,8 @@ public:
     // Clear the search queue
     q.clear();
 
-    // Clear the node_parent_map
-    node_parents.clear();
-    // Clear the node_value_map
-    node_values.clear();
+    entries.Clear();
+    cur = UINT_MAX;
   }
 
   /**
@@ -198,15 +217,16 @@ public:
    *
    * @return Node for processing
    */
-  const Node &Pop() {
-    cur = q.top().iterator;
+  Node Pop() {
+    cur = q.top().position;
 
     do { // remove this item
       q.pop();
-    } while (!q.empty() && (q.top().priority > q.top().iterator->second));
+    } while (!q.empty() &&
+             (q.top().priority > entries[q.top().position].value));
     // and all lower rank than this
 
-    return cur->first;
+    return entries[cur].node;
   }
 
   /**
@@ -234,9 +254,8 @@ public:
    */
   gcc_pure
   Node GetPredecessor(const Node &node) const {
-    // Try to find the given node in the node_parent_map
-    node_parent_const_iterator it = node_parents.find(node);
-    if (it == node_parents.end())
+    const unsigned position = entries.Find(node);
+    if (position == UINT_MAX)
       // first entry
       // If the node wasn't found
       // -> Return the given node itself
@@ -244,7 +263,7 @@ public:
 
     // If the node was found
     // -> Return the parent node
-    return it->second;
+    return entries[position].parent;
   }
 
   /** Reserve queue size (if available) */
@@ -258,14 +277,14 @@ public:
    */
   gcc_pure
   AStarPriorityValue GetNodeValue(const Node &node) const {
-    node_value_const_iterator it = node_values.find(node);
-    if (cur->first == node)
-      return cur->second;
+    if (cur < entries.GetSize() && KeyEqual()(entries[cur].node, node))
+      return entries[cur].value;
 
-    if (it == node_values.end())
+    const unsigned position = entries.Find(node);
+    if (position == UINT_MAX)
       return AStarPriorityValue(0);
 
-    return it->second;
+    return entries[position].value;
   }
 
 private:
@@ -278,39 +297,23 @@ private:
    */
   void Push(const Node &node, const Node &parent,
             const AStarPriorityValue &edge_value) {
-    // Try to find the given node n in the node_value_map
-    node_value_iterator it = node_values.find(node);
-    if (it == node_values.end()) {
-      // first entry
-      // If the node wasn't found
-      // -> Insert a new node into the node_value_map
-      it = node_values.insert(std::make_pair(node, edge_value)).first;
-
-      // Remember the parent node
-      SetPredecessor(node, parent);
-    } else if (it->second > edge_value) {
-      // If the node was found and the new value is smaller
-      // -> Replace the value with the new one
-      it->second = edge_value;
-      // replace, it's bigger
-
-      // Remember the new parent node
-      SetPredecessor(node, parent);
-    } else
-      // If the node was found but the value is higher or equal
-      // -> Don't use this new leg
-      return;
-
-    q.push(NodeValue(edge_value, it));
-  }
+    // If the node wasn't found
+    // -> Insert a new entry, and remember the parent node
+    const auto i = entries.Emplace(node, node, parent, edge_value);
+    if (!i.second) {
+      Entry &entry = entries[i.first];
+      if (entry.value > edge_value) {
+        // If the node was found and the new value is smaller
+        // -> Replace the value and the parent node with the new ones
+        entry.value = edge_value;
+        entry.parent = parent;
+      } else
+        // If the node was found but the value is higher or equal
+        // -> Don't use this new leg
+        return;
+    }
 
-  void SetPredecessor(const Node &node, const Node &parent) {
-    // Try to find the given node in the node_parent_map
-    auto result = node_parents.insert(std::make_pair(node, parent));
-    if (!result.second)
-      // If the node was found
-      // -> Replace the according parent node with the new one
-      result.first->second = parent;
+    q.push(NodeValue(edge_value, i.first));
   }
 };
 
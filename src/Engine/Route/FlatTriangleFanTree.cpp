@@ -26,6 +26,10 @@
 #include "ReachFanParms.hpp"
 #include "Util/GlobalSliceAllocator.hpp"
 #include "Geo/Flat/FlatProjection.hpp"
+#include "Thread/Mutex.hpp"
+#include "Util/Macros.hpp"
+
+#include <algorithm>
 
 #define REACH_BUFFER 1
 #define REACH_SWEEP (ROUTEPOLAR_Q1-REACH_BUFFER)
@@ -34,6 +38,21 @@
 #define REACH_MIN_STEP 25
 #define REACH_MAX_VERTICES 2000
 
+/**
+ * The number of sectors the root fan is split into by
+ * FillReachSectors().  Each gets an equal share of the vertex and fan
+ * budget.  This is a constant (instead of the number of CPUs), so the
+ * result does not depend on the machine.
+ */
+#define REACH_SECTORS 4
+
+/**
+ * UpdateReach(): a ray of the root fan is considered unchanged if
+ * its end point moved by no more than this fraction of its length
+ * (but at least #REACH_MIN_STEP).
+ */
+#define REACH_UPDATE_TOLERANCE_SHIFT 5
+
 static bool
 AlmostTheSame(const FlatGeoPoint &p1, const FlatGeoPoint &p2)
 {
@@ -50,6 +69,12 @@ TooClose(const FlatGeoPoint &p1, const FlatGeoPoint &p2)
   return dmax < REACH_MIN_STEP;
 }
 
+/**
+ * Protects the #GlobalSliceAllocator of #LeafVector while the sectors
+ * are being solved in parallel, see FillReachSectors().
+ */
+static Mutex children_mutex;
+
 void
 FlatTriangleFanTree::CalcBB()
 {
@@ -95,18 +120,231 @@ FlatTriangleFanTree::FillReach(const AFlatGeoPoint &origin,
 {
   gaps_filled = false;
 
-  FillReach(origin, 0, ROUTEPOLAR_POINTS + 1, parms);
+  if (parms.parallel != nullptr) {
+    FillReachSectors(origin, parms);
+  } else {
+    FillReach(origin, 0, ROUTEPOLAR_POINTS + 1, parms);
 
-  for (parms.set_depth = 0; parms.set_depth < REACH_MAX_DEPTH;
-      ++parms.set_depth)
-    if (!FillDepth(origin, parms))
-      // stop searching
-      break;
+    for (parms.set_depth = 0; parms.set_depth < REACH_MAX_DEPTH;
+         ++parms.set_depth)
+      if (!FillDepth(origin, parms))
+        // stop searching
+        break;
+  }
 
   // this boundingbox update visits the tree recursively
   CalcBB();
 }
 
+/**
+ * Returns the first of the n items which belong to the given sector.
+ */
+gcc_const
+static unsigned
+SectorBegin(unsigned sector, unsigned n)
+{
+  return sector * n / REACH_SECTORS;
+}
+
+void
+FlatTriangleFanTree::FillReachSectors(const AFlatGeoPoint &origin,
+                                      ReachFanParms &parms)
+{
+  assert(depth == 0);
+  assert(parms.parallel != nullptr);
+
+  const AGeoPoint ao(parms.projection.Unproject(origin), origin.altitude);
+  height = fill_height = origin.altitude;
+
+  /* the rays of the root fan are independent of each other */
+  FlatGeoPoint rays[ROUTEPOLAR_POINTS + 1];
+  parms.parallel(REACH_SECTORS, [&parms, &ao, &rays](unsigned sector){
+      const unsigned end = SectorBegin(sector + 1, ARRAY_SIZE(rays));
+      for (unsigned i = SectorBegin(sector, ARRAY_SIZE(rays)); i < end; ++i)
+        rays[i] = parms.reach_intercept(i, ao);
+    });
+
+  assert(vs.empty());
+  vs.reserve(ARRAY_SIZE(rays) + 1);
+  AddPoint(origin);
+  for (const auto &x : rays)
+    AddIntercept(origin, x);
+
+  gaps_filled = true;
+  if (vs.size() <= 2 || !parms.rpolars.IsTurningReachEnabled())
+    return;
+
+  /* the child fans of a sector only depend on its edges, so each
+     sector is searched to the full depth in a separate tree with a
+     copy of the root's vertices; the results are moved to this tree
+     afterwards */
+  const unsigned n_edges = vs.size() - 1;
+  FlatTriangleFanTree trees[REACH_SECTORS];
+  unsigned vertex_counters[REACH_SECTORS], fan_counters[REACH_SECTORS];
+
+  parms.parallel(REACH_SECTORS, [this, &origin, &parms, n_edges, &trees,
+                                 &vertex_counters, &fan_counters]
+                 (unsigned sector){
+      FlatTriangleFanTree &tree = trees[sector];
+      tree.vs = vs;
+      tree.height = tree.fill_height = height;
+      tree.gaps_filled = true;
+
+      bool edges[ROUTEPOLAR_POINTS + 2];
+      std::fill_n(edges, vs.size(), false);
+      std::fill(edges + 1 + SectorBegin(sector, n_edges),
+                edges + 1 + SectorBegin(sector + 1, n_edges), true);
+
+      /* charge the budget of the other sectors in advance */
+      ReachFanParms sector_parms(parms);
+      sector_parms.vertex_counter =
+        REACH_MAX_VERTICES - REACH_MAX_VERTICES / REACH_SECTORS;
+      sector_parms.fan_counter = REACH_MAX_FANS - REACH_MAX_FANS / REACH_SECTORS;
+
+      tree.FillGaps(origin, sector_parms, edges);
+
+      for (sector_parms.set_depth = 1;
+           sector_parms.set_depth < REACH_MAX_DEPTH;
+           ++sector_parms.set_depth)
+        if (!tree.FillDepth(origin, sector_parms))
+          break;
+
+      vertex_counters[sector] = sector_parms.vertex_counter -
+        (REACH_MAX_VERTICES - REACH_MAX_VERTICES / REACH_SECTORS);
+      fan_counters[sector] = sector_parms.fan_counter -
+        (REACH_MAX_FANS - REACH_MAX_FANS / REACH_SECTORS);
+    });
+
+  for (unsigned i = 0; i < REACH_SECTORS; ++i) {
+    children.splice(children.end(), trees[i].children);
+    parms.vertex_counter += vertex_counters[i];
+    parms.fan_counter += fan_counters[i];
+  }
+}
+
+gcc_const
+static int
+UpdateTolerance(int length)
+{
+  return std::max(REACH_MIN_STEP, length >> REACH_UPDATE_TOLERANCE_SHIFT);
+}
+
+gcc_pure
+static bool
+RayMoved(const FlatGeoPoint &origin, const FlatGeoPoint &before,
+         const FlatGeoPoint &after)
+{
+  const FlatGeoPoint r = before - origin;
+  const FlatGeoPoint k = after - before;
+  return std::max(abs(k.x), abs(k.y)) >
+    UpdateTolerance(std::max(abs(r.x), abs(r.y)));
+}
+
+bool
+FlatTriangleFanTree::IsShiftTolerable(RoughAltitude delta,
+                                      const ReachFanParms &parms) const
+{
+  /* the vertices of a fan move roughly by the glide distance of the
+     height change since they were calculated */
+  const RoughAltitude shift = height + delta - fill_height;
+  const double distance =
+    parms.rpolars.CalcMaxGlideDistance(shift < RoughAltitude(0)
+                                       ? RoughAltitude(0) - shift
+                                       : shift);
+
+  const int length = std::max(bb_children.GetRight() - bb_children.GetLeft(),
+                              bb_children.GetTop() - bb_children.GetBottom());
+  return distance <=
+    UpdateTolerance(length) * parms.projection.GetApproximateScale();
+}
+
+bool
+FlatTriangleFanTree::UpdateReach(const AFlatGeoPoint &origin,
+                                 ReachFanParms &parms)
+{
+  assert(depth == 0);
+
+  const unsigned n = vs.size();
+  if (n != ROUTEPOLAR_POINTS + 2)
+    /* not a tree created by FillReach() */
+    return false;
+
+  FlatGeoPoint before[ROUTEPOLAR_POINTS + 2];
+  std::copy(vs.begin(), vs.end(), before);
+  const RoughAltitude delta_height = origin.altitude - height;
+
+  vs.clear();
+  FillReach(origin, 0, ROUTEPOLAR_POINTS + 1, parms);
+  if (vs.size() != n)
+    /* duplicate vertices were removed */
+    return false;
+
+  /* a sector is the edge between two consecutive vertices; it needs
+     to be searched again if one of its rays has moved, or if the
+     height change has deformed one of its child fans too much */
+  bool moved[ROUTEPOLAR_POINTS + 2], sectors[ROUTEPOLAR_POINTS + 2];
+  moved[0] = false;
+  for (unsigned i = 1; i < n; ++i)
+    moved[i] = RayMoved(before[0], before[i], vs[i]);
+
+  sectors[0] = false;
+  for (unsigned i = 1; i < n; ++i)
+    sectors[i] = moved[i - 1] || moved[i];
+
+  for (const auto &child : children)
+    if (child.vs.front() == before[0] ||
+        !child.IsShiftTolerable(delta_height, parms))
+      /* a fan which starts at the origin has moved with it */
+      sectors[child.sector] = true;
+
+  const unsigned n_sectors = std::count(sectors, sectors + n, true);
+
+  if (n_sectors > n / 2)
+    /* cheaper to start from scratch */
+    return false;
+
+  children.remove_if([&sectors](const FlatTriangleFanTree &child){
+      return sectors[child.sector];
+    });
+
+  for (auto &child : children)
+    child.ShiftHeight(delta_height);
+
+  CountFans(parms);
+
+  if (n_sectors > 0) {
+    FillGaps(origin, parms, sectors);
+
+    /* the new children have not been searched yet */
+    for (parms.set_depth = 1; parms.set_depth < REACH_MAX_DEPTH;
+         ++parms.set_depth)
+      if (!FillDepth(origin, parms))
+        break;
+  }
+
+  CalcBB();
+  return true;
+}
+
+void
+FlatTriangleFanTree::ShiftHeight(RoughAltitude delta)
+{
+  height += delta;
+
+  for (auto &child : children)
+    child.ShiftHeight(delta);
+}
+
+void
+FlatTriangleFanTree::CountFans(ReachFanParms &parms) const
+{
+  for (const auto &child : children) {
+    parms.vertex_counter += child.vs.size();
+    parms.fan_counter++;
+    child.CountFans(parms);
+  }
+}
+
 void
 FlatTriangleFanTree::DummyReach(const AFlatGeoPoint &ao)
 {
@@ -143,7 +381,7 @@ FlatTriangleFanTree::FillReach(const AFlatGeoPoint &origin, const int index_low,
                                const int index_high, ReachFanParms &parms)
 {
   const AGeoPoint ao(parms.projection.Unproject(origin), origin.altitude);
-  height = origin.altitude;
+  height = fill_height = origin.altitude;
 
   // fill vector
   if (depth) {
@@ -156,22 +394,28 @@ FlatTriangleFanTree::FillReach(const AFlatGeoPoint &origin, const int index_low,
   assert(vs.empty());
   vs.reserve(index_high - index_low + 1);
   AddPoint(origin);
-  for (int index = index_low; index < index_high; ++index) {
-    const FlatGeoPoint x = parms.reach_intercept(index, ao);
-    /* hao: if reach_intercept() did not find anything reasonable it returns
-     *      a FlatGeoPoint that is almost the same as origin, but differs
-     *      +/- 1 due to conversion errors. The resulting polygon can have
-     *      overlapping edges causing triangulation failures.
-     */
-    if (AlmostTheSame(origin, x))
-      AddPoint(origin);
-    else
-      AddPoint(x);
-  }
+  for (int index = index_low; index < index_high; ++index)
+    AddIntercept(origin, parms.reach_intercept(index, ao));
+}
+
+void
+FlatTriangleFanTree::AddIntercept(const FlatGeoPoint &origin,
+                                  const FlatGeoPoint &x)
+{
+  /* hao: if reach_intercept() did not find anything reasonable it returns
+   *      a FlatGeoPoint that is almost the same as origin, but differs
+   *      +/- 1 due to conversion errors. The resulting polygon can have
+   *      overlapping edges causing triangulation failures.
+   */
+  if (AlmostTheSame(origin, x))
+    AddPoint(origin);
+  else
+    AddPoint(x);
 }
 
 void
-FlatTriangleFanTree::FillGaps(const AFlatGeoPoint &origin, ReachFanParms &parms)
+FlatTriangleFanTree::FillGaps(const AFlatGeoPoint &origin, ReachFanParms &parms,
+                              const bool *sectors)
 {
   // worth checking for gaps?
   if (vs.size() > 2 && parms.rpolars.IsTurningReachEnabled()) {
@@ -186,8 +430,12 @@ FlatTriangleFanTree::FillGaps(const AFlatGeoPoint &origin, ReachFanParms &parms)
         continue;
 
       const RouteLink e(RoutePoint(*x, RoughAltitude(0)), o, parms.projection);
+      const unsigned sector = x - vs.cbegin();
+
       // check if children need to be added
-      CheckGap(origin, e_last, e, parms);
+      if ((sectors == nullptr || sectors[sector]) &&
+          CheckGap(origin, e_last, e, parms))
+        children.back().sector = sector;
 
       e_last = e;
     }
@@ -252,7 +500,11 @@ FlatTriangleFanTree::CheckGap(const AFlatGeoPoint &n, const RouteLink &e_1,
     index_right = e_long.polar_index + REACH_SWEEP;
   }
 
-  children.emplace_back(depth + 1);
+  {
+    const ScopeLock protect(children_mutex);
+    children.emplace_back(depth + 1);
+  }
+
   FlatTriangleFanTree &child = children.back();
 
   for (auto f = f0; f < 0.9; f += 0.1) {
@@ -277,6 +529,7 @@ FlatTriangleFanTree::CheckGap(const AFlatGeoPoint &n, const RouteLink &e_1,
   }
 
   // don't need the child
+  const ScopeLock protect(children_mutex);
   children.pop_back();
 
   return false;
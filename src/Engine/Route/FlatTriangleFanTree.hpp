@@ -55,16 +55,29 @@ protected:
   FlatBoundingBox bb_children;
   LeafVector children;
   unsigned char depth;
+
+  /**
+   * The index of the parent's vertex at the end of the edge this fan
+   * was created from, see FillGaps().
+   */
+  unsigned char sector;
+
   bool gaps_filled;
 
+  /**
+   * The height at which the vertices were calculated.  This differs
+   * from #height after UpdateReach() has shifted the fan.
+   */
+  RoughAltitude fill_height;
+
 public:
   friend class PrintHelper;
 
   FlatTriangleFanTree(const unsigned char _depth = 0)
     :FlatTriangleFan(),
      bb_children(FlatGeoPoint(0,0)),
-     depth(_depth),
-     gaps_filled(false) {}
+     depth(_depth), sector(0),
+     gaps_filled(false), fill_height(0) {}
 
   void Clear() {
     FlatTriangleFan::Clear();
@@ -80,6 +93,18 @@ public:
   void FillReach(const AFlatGeoPoint &origin, ReachFanParms &parms);
   void DummyReach(const AFlatGeoPoint &origin);
 
+  /**
+   * Update a tree created by FillReach() for a slightly different
+   * origin.  The rays of the root fan are calculated again; the
+   * child fans of all sectors whose rays did not move by more than a
+   * tolerance are kept (with adjusted height), and only the gaps of
+   * the other sectors are searched again.
+   *
+   * @return false if too much has changed; the tree is then in an
+   * undefined state and must be filled again with FillReach()
+   */
+  bool UpdateReach(const AFlatGeoPoint &origin, ReachFanParms &parms);
+
   /**
    * Basic check for a state created by DummyReach().  If this method
    * returns true, then calls to FindPositiveArrival() are supposed to
@@ -95,7 +120,13 @@ public:
                  ReachFanParms &parms);
 
   bool FillDepth(const AFlatGeoPoint &origin, ReachFanParms &parms);
-  void FillGaps(const AFlatGeoPoint &origin, ReachFanParms &parms);
+
+  /**
+   * @param sectors if not nullptr, then only the edges ending at the
+   * vertices flagged in this array are checked
+   */
+  void FillGaps(const AFlatGeoPoint &origin, ReachFanParms &parms,
+                const bool *sectors=nullptr);
 
   bool CheckGap(const AFlatGeoPoint &n, const RouteLink &e_1,
                 const RouteLink &e_2, ReachFanParms &parms);
@@ -113,6 +144,27 @@ public:
   gcc_pure
   RoughAltitude DirectArrival(const FlatGeoPoint &dest,
                               const ReachFanParms &parms) const;
+
+private:
+  /**
+   * The implementation of FillReach() for ReachFanParms::parallel:
+   * the rays of the root fan are cast, and then the gaps of each
+   * sector are searched to the full depth, all sectors in parallel.
+   */
+  void FillReachSectors(const AFlatGeoPoint &origin, ReachFanParms &parms);
+
+  void AddIntercept(const FlatGeoPoint &origin, const FlatGeoPoint &x);
+
+  /**
+   * Can this fan be kept if its height changes by the given delta,
+   * or has the glide distance changed too much?
+   */
+  gcc_pure
+  bool IsShiftTolerable(RoughAltitude delta,
+                        const ReachFanParms &parms) const;
+
+  void ShiftHeight(RoughAltitude delta);
+  void CountFans(ReachFanParms &parms) const;
 };
 
 #endif
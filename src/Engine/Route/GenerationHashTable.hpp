@@ -0,0 +1,233 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_GENERATION_HASH_TABLE_HPP
+#define XCSOAR_GENERATION_HASH_TABLE_HPP
+
+#include "Compiler.h"
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <functional>
+
+#include <assert.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * A hash table for containers which are cleared often, e.g. during
+ * each route search.  The values are stored in a contiguous array in
+ * insertion order, located by an open-addressing hash table with
+ * linear probing.  Clear() keeps both and only increments a
+ * generation counter which marks all hash table slots obsolete.
+ *
+ * @param GetKey a function object which returns the key of a value
+ */
+template <class Value, class Key, class GetKey,
+          class Hash=std::hash<Key>, class KeyEqual=std::equal_to<Key>>
+class GenerationHashTable
+{
+  struct Slot {
+    /**
+     * The slot is only occupied if this equals
+     * #GenerationHashTable::generation.
+     */
+    unsigned generation;
+
+    /**
+     * The index in #values.
+     */
+    unsigned position;
+  };
+
+  static constexpr unsigned MIN_SLOTS_BITS = 10;
+
+  /**
+   * All values, in insertion order.
+   */
+  std::vector<Value> values;
+
+  /**
+   * The hash table; its size is a power of two, and it is kept at
+   * most half full.
+   */
+  std::vector<Slot> slots;
+
+  unsigned slots_bits = 0;
+
+  unsigned generation = 1;
+
+public:
+  gcc_pure
+  unsigned GetSize() const {
+    return values.size();
+  }
+
+  /**
+   * Returns the value at the given position (in insertion order).
+   */
+  Value &operator[](unsigned position) {
+    assert(position < values.size());
+
+    return values[position];
+  }
+
+  const Value &operator[](unsigned position) const {
+    assert(position < values.size());
+
+    return values[position];
+  }
+
+  void Clear() {
+    values.clear();
+
+    if (++generation == 0) {
+      /* wraparound: invalidate all slots explicitly */
+      std::fill(slots.begin(), slots.end(), Slot{0, 0});
+      generation = 1;
+    }
+  }
+
+  /**
+   * Look up the given key.
+   *
+   * @return the position of its value, or UINT_MAX if there is none
+   */
+  gcc_pure
+  unsigned Find(const Key &key) const {
+    if (slots.empty())
+      return UINT_MAX;
+
+    const unsigned mask = slots.size() - 1;
+    for (unsigned i = GetSlotIndex(key);; i = (i + 1) & mask) {
+      const Slot &slot = slots[i];
+      if (slot.generation != generation)
+        return UINT_MAX;
+
+      if (KeyEqual()(GetKey()(values[slot.position]), key))
+        return slot.position;
+    }
+  }
+
+  /**
+   * Look up the given key, and if there is no value yet, append one
+   * constructed from the given arguments.
+   *
+   * @return the position of the value, and true if it was inserted
+   */
+  template<typename... Args>
+  std::pair<unsigned, bool> Emplace(const Key &key, Args&&... args) {
+    if ((values.size() + 1) * 2 > slots.size())
+      Grow();
+
+    Slot &slot = FindSlot(key);
+    if (slot.generation == generation)
+      return std::make_pair(slot.position, false);
+
+    slot.generation = generation;
+    slot.position = values.size();
+    values.emplace_back(std::forward<Args>(args)...);
+    return std::make_pair(slot.position, true);
+  }
+
+private:
+  gcc_pure
+  unsigned GetSlotIndex(const Key &key) const {
+    /* Fibonacci hashing spreads the bits of weak hash functions over
+       the whole table */
+    return unsigned((uint64_t(Hash()(key)) * 0x9e3779b97f4a7c15ull)
+                    >> (64 - slots_bits));
+  }
+
+  /**
+   * Find the slot for the given key.  If there is no value with this
+   * key, the returned slot is unoccupied.
+   */
+  Slot &FindSlot(const Key &key) {
+    assert(!slots.empty());
+
+    const unsigned mask = slots.size() - 1;
+    for (unsigned i = GetSlotIndex(key);; i = (i + 1) & mask) {
+      Slot &slot = slots[i];
+      if (slot.generation != generation ||
+          KeyEqual()(GetKey()(values[slot.position]), key))
+        return slot;
+    }
+  }
+
+  /**
+   * Double the size of the hash table, and rebuild it from #values.
+   */
+  void Grow() {
+    slots_bits = slots_bits < MIN_SLOTS_BITS
+      ? MIN_SLOTS_BITS
+      : slots_bits + 1;
+    slots.assign(size_t(1) << slots_bits, Slot{0, 0});
+    generation = 1;
+
+    for (unsigned i = 0, n = values.size(); i < n; ++i) {
+      Slot &slot = FindSlot(GetKey()(values[i]));
+      slot.generation = generation;
+      slot.position = i;
+    }
+  }
+};
+
+/**
+ * A #GenerationHashTable whose values are their own keys.
+ */
+template <class T, class Hash=std::hash<T>,
+          class KeyEqual=std::equal_to<T>>
+class GenerationHashSet {
+  struct Identity {
+    constexpr const T &operator()(const T &value) const {
+      return value;
+    }
+  };
+
+  GenerationHashTable<T, T, Identity, Hash, KeyEqual> table;
+
+public:
+  gcc_pure
+  unsigned GetSize() const {
+    return table.GetSize();
+  }
+
+  void Clear() {
+    table.Clear();
+  }
+
+  /**
+   * Add a value to the set.
+   *
+   * @return true if the value was added, false if it was already in
+   * the set
+   */
+  bool Insert(const T &value) {
+    return table.Emplace(value, value).second;
+  }
+};
+
+#endif
@@ -26,44 +26,96 @@
 #include "ReachFanParms.hpp"
 #include "ReachResult.hpp"
 
+#include <stdlib.h>
+
+/**
+ * Incremental mode: the maximum distance [m] of the origin from the
+ * origin of the last full solution.
+ */
+static constexpr double REACH_UPDATE_MAX_DISTANCE = 500;
+
+/**
+ * Incremental mode: the maximum height difference [m] to the last
+ * full solution.
+ */
+static constexpr int REACH_UPDATE_MAX_HEIGHT = 50;
+
+/**
+ * Incremental mode: the maximum relative difference of the glide
+ * ratio in any direction.
+ */
+static constexpr double REACH_UPDATE_POLAR_TOLERANCE = 0.02;
+
+/**
+ * Incremental mode: solve from scratch after this many updates, to
+ * limit the accumulated error.
+ */
+static constexpr unsigned REACH_UPDATE_MAX_COUNT = 30;
+
 void
 ReachFan::Reset()
 {
   root.Clear();
   terrain_base = 0;
+  updatable = false;
+  n_updates = 0;
 }
 
 bool
-ReachFan::Solve(const AGeoPoint origin, const RoutePolars &rpolars,
-                const RasterMap* terrain, const bool do_solve)
+ReachFan::CanUpdate(const AGeoPoint &origin, const RoutePolars &rpolars,
+                    const RasterMap *terrain) const
 {
-  Reset();
+  if (!updatable || n_updates >= REACH_UPDATE_MAX_COUNT)
+    return false;
 
-  // initialise projection
-  projection = FlatProjection(origin);
+  if (terrain != full_terrain ||
+      (terrain != nullptr && terrain->GetSerial() != full_terrain_serial))
+    /* new terrain tiles have been loaded */
+    return false;
+
+  if (abs((int)origin.altitude - (int)full_origin.altitude) >
+      REACH_UPDATE_MAX_HEIGHT)
+    return false;
 
+  const FlatGeoPoint p = projection.ProjectInteger(origin);
+  if (p.Distance(full_origin) * projection.GetApproximateScale() >
+      REACH_UPDATE_MAX_DISTANCE)
+    return false;
+
+  return rpolars.IsGlideSimilar(full_rpolars, REACH_UPDATE_POLAR_TOLERANCE);
+}
+
+bool
+ReachFan::Update(const AGeoPoint &origin, const RoutePolars &rpolars,
+                 const RasterMap *terrain)
+{
   const short h = terrain
     ? terrain->GetHeight(origin)
     : RasterBuffer::TERRAIN_INVALID;
   const RoughAltitude h2(RasterBuffer::IsSpecial(h) ? 0 : h);
 
+  if (!RasterBuffer::IsInvalid(h) &&
+      (origin.altitude <= h2 + rpolars.GetSafetyHeight()))
+    /* Solve() handles this special case */
+    return false;
+
   ReachFanParms parms(rpolars, projection, (int)terrain_base, terrain);
   const AFlatGeoPoint ao(projection.ProjectInteger(origin), origin.altitude);
 
-  if (!RasterBuffer::IsInvalid(h) &&
-      (origin.altitude <= h2 + rpolars.GetSafetyHeight())) {
-    terrain_base = h2;
-    root.DummyReach(ao);
+  if (!root.UpdateReach(ao, parms))
     return false;
-  }
 
-  if (do_solve)
-    root.FillReach(ao, parms);
-  else
-    root.DummyReach(ao);
+  ++n_updates;
+  UpdateTerrainBase(ao, h, parms);
+  return true;
+}
 
+void
+ReachFan::UpdateTerrainBase(const AFlatGeoPoint &ao, short h,
+                            ReachFanParms &parms)
+{
   if (!RasterBuffer::IsInvalid(h)) {
-    parms.terrain_base = (int)h2;
+    parms.terrain_base = RasterBuffer::IsSpecial(h) ? 0 : h;
     parms.terrain_counter = 1;
   } else {
     parms.terrain_base = 0;
@@ -74,6 +126,53 @@ ReachFan::Solve(const AGeoPoint origin, const RoutePolars &rpolars,
     root.UpdateTerrainBase(ao, parms);
 
   terrain_base = parms.terrain_base;
+}
+
+bool
+ReachFan::Solve(const AGeoPoint origin, const RoutePolars &rpolars,
+                const RasterMap* terrain, const bool do_solve,
+                const bool incremental)
+{
+  if (incremental && do_solve && CanUpdate(origin, rpolars, terrain)) {
+    if (Update(origin, rpolars, terrain))
+      return true;
+  }
+
+  Reset();
+
+  // initialise projection
+  projection = FlatProjection(origin);
+
+  const short h = terrain
+    ? terrain->GetHeight(origin)
+    : RasterBuffer::TERRAIN_INVALID;
+  const RoughAltitude h2(RasterBuffer::IsSpecial(h) ? 0 : h);
+
+  ReachFanParms parms(rpolars, projection, (int)terrain_base, terrain);
+  const AFlatGeoPoint ao(projection.ProjectInteger(origin), origin.altitude);
+
+  if (!RasterBuffer::IsInvalid(h) &&
+      (origin.altitude <= h2 + rpolars.GetSafetyHeight())) {
+    terrain_base = h2;
+    root.DummyReach(ao);
+    return false;
+  }
+
+  if (do_solve) {
+    parms.parallel = parallel;
+    root.FillReach(ao, parms);
+
+    updatable = true;
+    n_updates = 0;
+    full_origin = ao;
+    full_rpolars = rpolars;
+    full_terrain = terrain;
+    if (terrain != nullptr)
+      full_terrain_serial = terrain->GetSerial();
+  } else
+    root.DummyReach(ao);
+
+  UpdateTerrainBase(ao, h, parms);
   return true;
 }
 
@@ -25,9 +25,11 @@
 
 #include "Geo/Flat/FlatProjection.hpp"
 #include "FlatTriangleFanTree.hpp"
+#include "RoutePolars.hpp"
+#include "ReachFanParms.hpp"
 #include "Rough/RoughAltitude.hpp"
+#include "Util/Serial.hpp"
 
-class RoutePolars;
 class RasterMap;
 class GeoBounds;
 struct ReachResult;
@@ -38,8 +40,32 @@ class ReachFan
   FlatTriangleFanTree root;
   RoughAltitude terrain_base;
 
+  /**
+   * Can the current solution be updated by an incremental Solve()
+   * call?  The following attributes describe the last full solution.
+   */
+  bool updatable;
+
+  /**
+   * The number of incremental updates since the last full solution.
+   */
+  unsigned n_updates;
+
+  AFlatGeoPoint full_origin;
+  RoutePolars full_rpolars;
+  const RasterMap *full_terrain;
+  Serial full_terrain_serial;
+
+  /**
+   * If set, then the sectors of a full solution are solved in
+   * parallel.  See SetParallel().
+   */
+  ReachFanParms::ParallelFunction parallel;
+
 public:
-  ReachFan():terrain_base(0) {}
+  ReachFan()
+    :terrain_base(0), updatable(false), n_updates(0),
+     parallel(nullptr) {}
 
   friend class PrintHelper;
 
@@ -49,8 +75,44 @@ public:
 
   void Reset();
 
+  /**
+   * Solve the sectors of the root fan in parallel, using the given
+   * function.  The terrain is only read, and it must not be modified
+   * during Solve().
+   *
+   * @param _parallel the function which runs the sectors, or nullptr
+   * to solve the fan on the calling thread
+   */
+  void SetParallel(ReachFanParms::ParallelFunction _parallel) {
+    parallel = _parallel;
+  }
+
+  /**
+   * @param incremental if true, then the previous solution may be
+   * updated instead of solving from scratch, if the origin, the glide
+   * performance and the terrain are nearly the same
+   */
   bool Solve(const AGeoPoint origin, const RoutePolars &rpolars,
-             const RasterMap *terrain, const bool do_solve = true);
+             const RasterMap *terrain, const bool do_solve = true,
+             const bool incremental = false);
+
+  /**
+   * Can the current solution be updated by an incremental Solve()
+   * call at the given origin?  If not, Solve() falls back to a full
+   * solution.
+   */
+  gcc_pure
+  bool CanUpdate(const AGeoPoint &origin, const RoutePolars &rpolars,
+                 const RasterMap *terrain) const;
+
+  /**
+   * Returns the number of incremental updates since the last full
+   * solution; zero means that the last Solve() call has solved from
+   * scratch.
+   */
+  unsigned GetUpdateCount() const {
+    return n_updates;
+  }
 
   bool FindPositiveArrival(const AGeoPoint dest, const RoutePolars &rpolars,
                            ReachResult &result_r) const;
@@ -63,6 +125,13 @@ public:
   RoughAltitude GetTerrainBase() const {
     return terrain_base;
   }
+
+private:
+  bool Update(const AGeoPoint &origin, const RoutePolars &rpolars,
+              const RasterMap *terrain);
+
+  void UpdateTerrainBase(const AFlatGeoPoint &ao, short h,
+                         ReachFanParms &parms);
 };
 
 #endif
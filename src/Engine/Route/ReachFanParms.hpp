@@ -25,10 +25,20 @@
 
 #include "Route/RoutePolars.hpp"
 
+#include <functional>
+
 class FlatProjection;
 class RasterMap;
 
 struct ReachFanParms {
+  /**
+   * A function which invokes f(i) for each i in the range [0,n) and
+   * returns after all calls have finished.  The calls may run in
+   * parallel, e.g. RunParallel().
+   */
+  typedef void (*ParallelFunction)(unsigned n,
+                                   const std::function<void(unsigned)> &f);
+
   const RoutePolars &rpolars;
   const FlatProjection &projection;
   const RasterMap* terrain;
@@ -38,6 +48,12 @@ struct ReachFanParms {
   unsigned vertex_counter;
   unsigned char set_depth;
 
+  /**
+   * If set, then FlatTriangleFanTree::FillReach() solves the sectors
+   * of the root fan with this function.
+   */
+  ParallelFunction parallel;
+
   ReachFanParms(const RoutePolars& _rpolars,
                 const FlatProjection &_projection,
                 const short _terrain_base,
@@ -47,7 +63,8 @@ struct ReachFanParms {
     terrain_counter(0),
     fan_counter(0),
     vertex_counter(0),
-    set_depth(0) {};
+    set_depth(0),
+    parallel(nullptr) {};
 
   FlatGeoPoint reach_intercept(const int index, const AGeoPoint& ao) const {
     return rpolars.ReachIntercept(index, ao, terrain, projection);
@@ -26,7 +26,6 @@
 
 RoutePlanner::RoutePlanner()
   :terrain(NULL), planner(0),
-   unique_links(50000),
    reach_polar_mode(RoutePlannerConfig::Polar::TASK)
 {
   Reset();
@@ -46,7 +45,7 @@ RoutePlanner::Reset()
   dirty = true;
   solution_route.clear();
   planner.Clear();
-  unique_links.clear();
+  unique_links.Clear();
   h_min = RoughAltitude(-1);
   h_max = RoughAltitude(0);
   search_hull.clear();
@@ -56,12 +55,24 @@ RoutePlanner::Reset()
 bool
 RoutePlanner::SolveReach(const AGeoPoint &origin,
                          const RoutePlannerConfig &config,
-                         const RoughAltitude h_ceiling, const bool do_solve)
+                         const RoughAltitude h_ceiling, const bool do_solve,
+                         const bool incremental)
 {
   rpolars_reach.SetConfig(config, origin.altitude, h_ceiling);
   reach_polar_mode = config.reach_polar_mode;
 
-  return reach.Solve(origin, rpolars_reach, terrain, do_solve);
+  return reach.Solve(origin, rpolars_reach, terrain, do_solve, incremental);
+}
+
+bool
+RoutePlanner::CanUpdateReach(const AGeoPoint &origin,
+                             const RoutePlannerConfig &config,
+                             const RoughAltitude h_ceiling) const
+{
+  RoutePolars rpolars = rpolars_reach;
+  rpolars.SetConfig(config, origin.altitude, h_ceiling);
+
+  return reach.CanUpdate(origin, rpolars, terrain);
 }
 
 bool
@@ -160,7 +171,7 @@ RoutePlanner::Solve(const AGeoPoint &origin, const AGeoPoint &destination,
 
   }
 
-  count_unique = unique_links.size();
+  count_unique = unique_links.GetSize();
 
   if (retval) {
     // correct solution for rounding
@@ -181,7 +192,7 @@ RoutePlanner::Solve(const AGeoPoint &origin, const AGeoPoint &destination,
   }
 
   planner.Clear();
-  unique_links.clear();
+  unique_links.Clear();
   // m_search_hull.clear();
   return retval;
 }
@@ -277,7 +288,7 @@ RoutePlanner::LinkCleared(const RouteLink &e)
 bool
 RoutePlanner::IsSetUnique(const RouteLinkBase &e)
 {
-  const bool inserted = unique_links.insert(e).second;
+  const bool inserted = unique_links.Insert(e);
   if (inserted)
     return true;
 
@@ -27,13 +27,13 @@
 #include "Route.hpp"
 #include "RouteLink.hpp"
 #include "AStar.hpp"
+#include "GenerationHashTable.hpp"
 #include "Geo/Flat/FlatProjection.hpp"
 #include "Geo/SearchPointVector.hpp"
 #include "ReachFan.hpp"
 
 #include <utility>
 #include <algorithm>
-#include <unordered_set>
 
 class GlidePolar;
 
@@ -124,7 +124,7 @@ private:
    */
   SearchPointVector search_hull;
 
-  typedef std::unordered_set<RouteLinkBase, RouteLinkBaseHasher> RouteLinkSet;
+  typedef GenerationHashSet<RouteLinkBase, RouteLinkBaseHasher> RouteLinkSet;
 
   /** Links that have been visited during solution */
   RouteLinkSet unique_links;
@@ -180,6 +180,13 @@ public:
    */
   void ClearReach();
 
+  /**
+   * See ReachFan::SetParallel().
+   */
+  void SetParallel(ReachFanParms::ParallelFunction parallel) {
+    reach.SetParallel(parallel);
+  }
+
   /**
    * Find the optimal path.  Works in reverse time order, from the
    * origin (where you want to fly to) back to the destination (where you
@@ -201,11 +208,30 @@ public:
    *
    * @param origin The start of the search (current aircraft location)
    * @param do_solve actually solve or just perform minimal calculations
+   * @param incremental allow updating the previous solution instead
+   * of solving from scratch, see ReachFan::Solve()
    *
    * @return True if reach was scanned
    */
   bool SolveReach(const AGeoPoint &origin, const RoutePlannerConfig &config,
-                  RoughAltitude h_ceiling, bool do_solve=true);
+                  RoughAltitude h_ceiling, bool do_solve=true,
+                  bool incremental=false);
+
+  /**
+   * Can an incremental SolveReach() call at the given origin update
+   * the current reach?  See ReachFan::CanUpdate().
+   */
+  gcc_pure
+  bool CanUpdateReach(const AGeoPoint &origin,
+                      const RoutePlannerConfig &config,
+                      RoughAltitude h_ceiling) const;
+
+  /**
+   * See ReachFan::GetUpdateCount().
+   */
+  unsigned GetReachUpdateCount() const {
+    return reach.GetUpdateCount();
+  }
 
   /** Visit reach */
   void AcceptInRange(const GeoBounds &bounds,
@@ -26,6 +26,10 @@
 #include "Geo/Flat/FlatProjection.hpp"
 #include "Terrain/RasterMap.hpp"
 
+#include <algorithm>
+
+#include <math.h>
+
 #define MC_CEILING_PENALTY_FACTOR 5.0
 
 GeoPoint
@@ -238,6 +242,39 @@ RoutePolars::CalcGlideArrival(const AFlatGeoPoint& origin,
   return origin.altitude - CalcVHeight(e);
 }
 
+bool
+RoutePolars::IsGlideSimilar(const RoutePolars &other, double tolerance) const
+{
+  if (config.safety_height_terrain != other.config.safety_height_terrain ||
+      config.IsTurningReachEnabled() != other.config.IsTurningReachEnabled())
+    return false;
+
+  for (unsigned i = 0; i < ROUTEPOLAR_POINTS; ++i) {
+    const auto &a = polar_glide.GetPoint(i), &b = other.polar_glide.GetPoint(i);
+    if (a.valid != b.valid)
+      return false;
+
+    if (fabs(a.inv_gradient - b.inv_gradient) >
+        tolerance * std::max(a.inv_gradient, b.inv_gradient))
+      return false;
+  }
+
+  return true;
+}
+
+double
+RoutePolars::CalcMaxGlideDistance(const RoughAltitude height) const
+{
+  double inv_gradient = 0;
+  for (unsigned i = 0; i < ROUTEPOLAR_POINTS; ++i) {
+    const auto &p = polar_glide.GetPoint(i);
+    if (p.valid)
+      inv_gradient = std::max(inv_gradient, p.inv_gradient);
+  }
+
+  return height * inv_gradient;
+}
+
 FlatGeoPoint
 RoutePolars::ReachIntercept(const int index, const AGeoPoint& origin,
                              const RasterMap* map,
@@ -247,7 +284,11 @@ RoutePolars::ReachIntercept(const int index, const AGeoPoint& origin,
   const RoughAltitude altitude = origin.altitude - GetSafetyHeight();
   const AGeoPoint m_origin((GeoPoint)origin, altitude);
   const GeoPoint dest = MSLIntercept(index, m_origin, proj);
-  const GeoPoint p = valid ?
-    map->Intersection(m_origin, (short)altitude, (short)altitude, dest) : dest;
-  return proj.ProjectInteger(p);
+  if (!valid)
+    return proj.ProjectInteger(dest);
+
+  const GeoPoint p =
+    map->Intersection(m_origin, (short)altitude, (short)altitude, dest);
+  /* no intersection: the glide reaches the MSL intercept */
+  return proj.ProjectInteger(p.IsValid() ? p : dest);
 }
@@ -234,6 +234,25 @@ public:
     return RoughAltitude(config.safety_height_terrain);
   }
 
+  /**
+   * Check whether the pure glide performance and the reach settings
+   * of both objects are nearly the same, i.e. whether a reach
+   * solution calculated with one of them may be reused for the
+   * other.
+   *
+   * @param tolerance the maximum relative difference of the glide
+   * ratio in any direction
+   */
+  gcc_pure
+  bool IsGlideSimilar(const RoutePolars &other, double tolerance) const;
+
+  /**
+   * Calculate the distance [m] which can be glided with the given
+   * height loss in the best direction.
+   */
+  gcc_pure
+  double CalcMaxGlideDistance(RoughAltitude height) const;
+
   FlatGeoPoint ReachIntercept(const int index, const AGeoPoint& p,
                               const RasterMap* map,
                               const FlatProjection &proj) const;
@@ -22,10 +22,44 @@ Copyright_License {
 */
 
 #include "FlarmNetDatabase.hpp"
+#include "FlarmNetReader.hpp"
+#include "OS/FileMapping.hpp"
 #include "Util/StringUtil.hpp"
 
+#include <algorithm>
+
 #include <assert.h>
 
+FlarmNetDatabase::FlarmNetDatabase() = default;
+
+FlarmNetDatabase::~FlarmNetDatabase() = default;
+
+void
+FlarmNetDatabase::Clear()
+{
+  entries.clear();
+  callsign_index.clear();
+  records.clear();
+  cache.reset();
+  decoded.clear();
+  strings.clear();
+  mappings.clear();
+  optimised = true;
+}
+
+const TCHAR *
+FlarmNetDatabase::Intern(const TCHAR *s) const
+{
+  tstring key(s);
+
+  const ScopeLock protect(mutex);
+  auto i = strings.lower_bound(key);
+  if (i == strings.end() || *i != key)
+    i = strings.emplace_hint(i, std::move(key));
+
+  return i->c_str();
+}
+
 void
 FlarmNetDatabase::Insert(const FlarmNetRecord &record)
 {
@@ -34,21 +68,166 @@ FlarmNetDatabase::Insert(const FlarmNetRecord &record)
     /* ignore malformed records */
     return;
 
-  map.insert(std::make_pair(id, record));
+  records.push_back(record);
+
+  Entry entry;
+  entry.id = id;
+  entry.callsign = record.callsign;
+  entry.line = nullptr;
+  entry.record = &records.back();
+  entries.push_back(entry);
+
+  optimised = false;
 }
 
-const FlarmNetRecord *
-FlarmNetDatabase::FindFirstRecordByCallSign(const TCHAR *cn) const
+void
+FlarmNetDatabase::Insert(FlarmId id, const TCHAR *callsign, const char *line)
+{
+  assert(line != nullptr);
+
+  if (!id.IsDefined())
+    /* ignore malformed records */
+    return;
+
+  Entry entry;
+  entry.id = id;
+  entry.callsign = callsign;
+  entry.line = line;
+  entry.record = nullptr;
+  entries.push_back(entry);
+
+  optimised = false;
+}
+
+void
+FlarmNetDatabase::AddMapping(std::unique_ptr<FileMapping> &&mapping)
+{
+  mappings.push_back(std::move(mapping));
+}
+
+void
+FlarmNetDatabase::Optimise()
+{
+  if (optimised)
+    return;
+
+  /* the stable sort keeps duplicates in insertion order, so
+     std::unique() keeps the first one */
+  std::stable_sort(entries.begin(), entries.end(),
+                   [](const Entry &a, const Entry &b) {
+                     return a.id < b.id;
+                   });
+  const auto duplicates =
+    std::unique(entries.begin(), entries.end(),
+                [](const Entry &a, const Entry &b) {
+                  return a.id == b.id;
+                });
+  if (duplicates != entries.end()) {
+    entries.erase(duplicates, entries.end());
+
+    /* copy only the records which are still referenced, to free the
+       ones of the duplicates */
+    std::deque<FlarmNetRecord> kept;
+    for (Entry &entry : entries) {
+      if (entry.record != nullptr) {
+        kept.push_back(*entry.record);
+        entry.record = &kept.back();
+      }
+    }
+
+    /* swapping does not move the elements */
+    records.swap(kept);
+  }
+
+  entries.shrink_to_fit();
+
+  callsign_index.resize(entries.size());
+  for (unsigned i = 0; i < entries.size(); ++i)
+    callsign_index[i] = i;
+
+  std::sort(callsign_index.begin(), callsign_index.end(),
+            [this](unsigned a, unsigned b) {
+              int cmp = _tcscmp(entries[a].callsign, entries[b].callsign);
+              return cmp != 0 ? cmp < 0 : a < b;
+            });
+
+  /* the positions have changed; records decoded so far are
+     discarded and will be decoded again */
+  decoded.clear();
+  cache.reset(new std::atomic<const FlarmNetRecord *>[entries.size()]);
+  for (unsigned i = 0; i < entries.size(); ++i)
+    cache[i].store(entries[i].record, std::memory_order_relaxed);
+
+  optimised = true;
+}
+
+const FlarmNetRecord &
+FlarmNetDatabase::GetRecord(unsigned i) const
 {
-  for (const auto &i : map) {
-    assert(i.first.IsDefined());
+  assert(optimised);
+  assert(i < entries.size());
 
-    const FlarmNetRecord &record = i.second;
-    if (StringIsEqual(record.callsign, cn))
-      return &record;
+  const FlarmNetRecord *record = cache[i].load(std::memory_order_acquire);
+  return record != nullptr
+    ? *record
+    : Decode(i);
+}
+
+const FlarmNetRecord &
+FlarmNetDatabase::Decode(unsigned i) const
+{
+  assert(entries[i].line != nullptr);
+
+  /* decode without holding the lock, which Intern() needs */
+  FlarmNetRecord record;
+  FlarmNetReader::LoadRecord(record, entries[i].line, *this);
+
+  const ScopeLock protect(mutex);
+
+  /* another thread may have decoded it meanwhile */
+  const FlarmNetRecord *result = cache[i].load(std::memory_order_relaxed);
+  if (result == nullptr) {
+    decoded.push_back(record);
+    result = &decoded.back();
+    cache[i].store(result, std::memory_order_release);
   }
 
-  return NULL;
+  return *result;
+}
+
+const FlarmNetRecord *
+FlarmNetDatabase::FindRecordById(FlarmId id) const
+{
+  assert(optimised);
+
+  auto i = std::lower_bound(entries.begin(), entries.end(), id,
+                            [](const Entry &entry, FlarmId id) {
+                              return entry.id < id;
+                            });
+  return i != entries.end() && i->id == id
+    ? &GetRecord(i - entries.begin())
+    : nullptr;
+}
+
+std::vector<unsigned>::const_iterator
+FlarmNetDatabase::LowerBoundCallSign(const TCHAR *cn) const
+{
+  assert(optimised);
+
+  return std::lower_bound(callsign_index.begin(), callsign_index.end(), cn,
+                          [this](unsigned i, const TCHAR *cn) {
+                            return _tcscmp(entries[i].callsign, cn) < 0;
+                          });
+}
+
+const FlarmNetRecord *
+FlarmNetDatabase::FindFirstRecordByCallSign(const TCHAR *cn) const
+{
+  auto i = LowerBoundCallSign(cn);
+  return i != callsign_index.end() &&
+    StringIsEqual(entries[*i].callsign, cn)
+    ? &GetRecord(*i)
+    : nullptr;
 }
 
 unsigned
@@ -58,13 +237,10 @@ FlarmNetDatabase::FindRecordsByCallSign(const TCHAR *cn,
 {
   unsigned count = 0;
 
-  for (const auto &i : map) {
-    assert(i.first.IsDefined());
-
-    const FlarmNetRecord &record = i.second;
-    if (StringIsEqual(record.callsign, cn))
-      array[count++] = &record;
-  }
+  for (auto i = LowerBoundCallSign(cn), end = callsign_index.end();
+       i != end && count < size && StringIsEqual(entries[*i].callsign, cn);
+       ++i)
+    array[count++] = &GetRecord(*i);
 
   return count;
 }
@@ -75,13 +251,26 @@ FlarmNetDatabase::FindIdsByCallSign(const TCHAR *cn, FlarmId array[],
 {
   unsigned count = 0;
 
-  for (const auto &i : map) {
-    assert(i.first.IsDefined());
+  for (auto i = LowerBoundCallSign(cn), end = callsign_index.end();
+       i != end && count < size && StringIsEqual(entries[*i].callsign, cn);
+       ++i)
+    array[count++] = entries[*i].id;
 
-    const FlarmNetRecord &record = i.second;
-    if (StringIsEqual(record.callsign, cn))
-      array[count++] = i.first;
-  }
+  return count;
+}
+
+unsigned
+FlarmNetDatabase::FindRecordsByCallSignPrefix(const TCHAR *prefix,
+                                              const FlarmNetRecord *array[],
+                                              unsigned size) const
+{
+  unsigned count = 0;
+
+  for (auto i = LowerBoundCallSign(prefix), end = callsign_index.end();
+       i != end && count < size &&
+         StringStartsWith(entries[*i].callsign, prefix);
+       ++i)
+    array[count++] = &GetRecord(*i);
 
   return count;
 }
@@ -26,48 +26,170 @@ Copyright_License {
 
 #include "FlarmId.hpp"
 #include "FlarmNetRecord.hpp"
+#include "Thread/Mutex.hpp"
+#include "Util/tstring.hpp"
 #include "Compiler.h"
 
-#include <map>
+#include <vector>
+#include <deque>
+#include <set>
+#include <memory>
+#include <atomic>
+
 #include <tchar.h>
 
+class FileMapping;
+
 /**
  * An in-memory representation of the FlarmNet.org database.
+ *
+ * The database is one array of compact entries sorted by FLARM id,
+ * with an array of indices sorted by callsign, which allows binary
+ * searches for both.  The full #FlarmNetRecord is stored separately;
+ * for a file loaded with FlarmNetReader::MapFile(), it is decoded
+ * from the mapped file only when it is first looked up.  Airfield
+ * and plane type names repeat a lot, so each distinct one is stored
+ * only once.
+ *
+ * After inserting records, call Optimise() before doing lookups.
+ * Lookups and Intern() may be called from any thread at the same
+ * time; a record which has already been decoded is returned without
+ * locking.  Modifications (Insert(), Optimise() and Clear()) need
+ * exclusive access, and they invalidate all records returned before.
  */
 class FlarmNetDatabase {
-  typedef std::map<FlarmId, FlarmNetRecord> RecordMap;
-  RecordMap map;
+  struct Entry {
+    FlarmId id;
+
+    StaticString<LatinBufferSize(4)> callsign;
+
+    /**
+     * The line of a mapped file this record is decoded from on
+     * demand, or nullptr.
+     */
+    const char *line;
+
+    /**
+     * The record passed to Insert(), or nullptr if it is decoded
+     * from #line.
+     */
+    const FlarmNetRecord *record;
+  };
+
+  /**
+   * All entries, sorted by id (after Optimise()).
+   */
+  std::vector<Entry> entries;
+
+  /**
+   * Indices into #entries, sorted by callsign, and entries with the
+   * same callsign by id.
+   */
+  std::vector<unsigned> callsign_index;
+
+  /**
+   * Storage for the records passed to Insert(); a std::deque does
+   * not move its elements when it grows.
+   */
+  std::deque<FlarmNetRecord> records;
+
+  /**
+   * One slot per entry, pointing to its record, or nullptr if it has
+   * not been decoded yet.  Lookups read it without locking; a slot
+   * only ever changes from nullptr to a record in #decoded, which is
+   * published with release semantics while holding #mutex.
+   */
+  mutable std::unique_ptr<std::atomic<const FlarmNetRecord *>[]> cache;
+
+  /**
+   * Storage for the records decoded on demand.
+   */
+  mutable std::deque<FlarmNetRecord> decoded;
+
+  /**
+   * The interned strings referenced by the records.
+   */
+  mutable std::set<tstring> strings;
+
+  /**
+   * The files which undecoded entries point into.
+   */
+  std::vector<std::unique_ptr<FileMapping>> mappings;
+
+  /**
+   * Protects #decoded and #strings.
+   */
+  mutable Mutex mutex;
+
+  /**
+   * Are #entries and #callsign_index up to date?
+   */
+  bool optimised = true;
 
 public:
+  FlarmNetDatabase();
+  ~FlarmNetDatabase();
+
   bool IsEmpty() const {
-    return map.empty();
+    return entries.empty();
   }
 
-  void Clear() {
-    map.clear();
+  unsigned GetSize() const {
+    return entries.size();
   }
 
+  void Clear();
+
+  /**
+   * Returns a copy of the given string which lives as long as this
+   * object (until Clear() is called).  Equal strings share the same
+   * copy.  This method is thread-safe.
+   */
+  const TCHAR *Intern(const TCHAR *s) const;
+
+  /**
+   * Add a record.  The strings #FlarmNetRecord::airfield and
+   * #FlarmNetRecord::plane_type must have been obtained from
+   * Intern().  If there is already a record with the same id, the
+   * old one is kept.
+   */
   void Insert(const FlarmNetRecord &record);
 
+  /**
+   * Add a record which will be decoded from the given line of a
+   * mapped file when it is first looked up.
+   */
+  void Insert(FlarmId id, const TCHAR *callsign, const char *line);
+
+  /**
+   * Take ownership of a mapped file which was passed to Insert().
+   */
+  void AddMapping(std::unique_ptr<FileMapping> &&mapping);
+
+  /**
+   * Sort the records and build the index.  Must be called after
+   * Insert() and before any lookup.
+   */
+  void Optimise();
+
+  /**
+   * Returns the record at the given position; records are ordered
+   * by id.
+   */
+  const FlarmNetRecord &GetRecord(unsigned i) const;
+
   /**
    * Finds a FLARMNetRecord object based on the given FLARM id
    * @param id FLARM id
    * @return FLARMNetRecord object
    */
-  gcc_pure
-  const FlarmNetRecord *FindRecordById(FlarmId id) const {
-    auto i = map.find(id);
-    return i != map.end()
-      ? &i->second
-      : NULL;
-  }
+  const FlarmNetRecord *FindRecordById(FlarmId id) const;
 
   /**
    * Finds a FLARMNetRecord object based on the given Callsign
    * @param cn Callsign
    * @return FLARMNetRecord object
    */
-  gcc_pure
   const FlarmNetRecord *FindFirstRecordByCallSign(const TCHAR *cn) const;
 
   unsigned FindRecordsByCallSign(const TCHAR *cn,
@@ -76,13 +198,26 @@ public:
   unsigned FindIdsByCallSign(const TCHAR *cn, FlarmId array[],
                              unsigned size) const;
 
-  RecordMap::const_iterator begin() const {
-    return map.begin();
-  }
+  /**
+   * Finds the records whose callsign begins with the given prefix,
+   * ordered by callsign.
+   */
+  unsigned FindRecordsByCallSignPrefix(const TCHAR *prefix,
+                                       const FlarmNetRecord *array[],
+                                       unsigned size) const;
 
-  RecordMap::const_iterator end() const {
-    return map.end();
-  }
+private:
+  /**
+   * Decode the record of the given entry and store it in #cache.
+   */
+  const FlarmNetRecord &Decode(unsigned i) const;
+
+  /**
+   * Returns the position of the first entry in #callsign_index whose
+   * callsign is not less than the given string.
+   */
+  std::vector<unsigned>::const_iterator
+  LowerBoundCallSign(const TCHAR *cn) const;
 };
 
 #endif
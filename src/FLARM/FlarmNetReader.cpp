@@ -24,18 +24,23 @@ Copyright_License {
 #include "FlarmNetReader.hpp"
 #include "FlarmNetRecord.hpp"
 #include "FlarmNetDatabase.hpp"
+#include "FlarmId.hpp"
 #include "Util/StringUtil.hpp"
 #include "Util/CharUtil.hpp"
 #include "Util/Error.hxx"
 #include "IO/LineReader.hpp"
 #include "IO/FileLineReader.hpp"
+#include "OS/FileMapping.hpp"
 
 #ifndef _UNICODE
 #include "Util/UTF8.hpp"
 #endif
 
+#include <memory>
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 /**
  * Decodes the FlarmNet.org file and puts the wanted
@@ -96,31 +101,40 @@ LoadString(const char *bytes, size_t length, StaticString<size> &dest)
 }
 
 /**
- * Reads next FlarmNet.org file entry and returns the pointer to
- * a new FlarmNetRecord instance or NULL on error.
- *
- * The caller is responsible for deleting the object again!
+ * The length of a record line, not including the line ending.
  */
-static bool
-LoadRecord(FlarmNetRecord &record, const char *line)
-{
-  if (strlen(line) < 172)
-    return false;
+static constexpr size_t RECORD_LENGTH = 172;
 
-  LoadString(line, 6, record.id);
-  LoadString(line + 12, 21, record.pilot);
-  LoadString(line + 54, 21, record.airfield);
-  LoadString(line + 96, 21, record.plane_type);
-  LoadString(line + 138, 7, record.registration);
-  LoadString(line + 152, 3, record.callsign);
-  LoadString(line + 158, 7, record.frequency);
+template<size_t size>
+static void
+LoadCallSign(const char *line, StaticString<size> &callsign)
+{
+  LoadString(line + 152, 3, callsign);
 
   // Terminate callsign string on first whitespace
-  for (TCHAR *i = record.callsign.buffer(); *i != _T('\0'); ++i)
+  for (TCHAR *i = callsign.buffer(); *i != _T('\0'); ++i)
     if (IsWhitespaceFast(*i))
       *i = _T('\0');
+}
 
-  return true;
+void
+FlarmNetReader::LoadRecord(FlarmNetRecord &record, const char *line,
+                           const FlarmNetDatabase &database)
+{
+  StaticString<LatinBufferSize(22)> buffer;
+
+  LoadString(line, 6, record.id);
+  LoadString(line + 12, 21, record.pilot);
+
+  LoadString(line + 54, 21, buffer);
+  record.airfield = database.Intern(buffer);
+
+  LoadString(line + 96, 21, buffer);
+  record.plane_type = database.Intern(buffer);
+
+  LoadString(line + 138, 7, record.registration);
+  LoadCallSign(line, record.callsign);
+  LoadString(line + 158, 7, record.frequency);
 }
 
 unsigned
@@ -133,13 +147,17 @@ FlarmNetReader::LoadFile(NLineReader &reader, FlarmNetDatabase &database)
 
   int itemCount = 0;
   while ((line = reader.ReadLine()) != NULL) {
+    if (strlen(line) < RECORD_LENGTH)
+      continue;
+
     FlarmNetRecord record;
-    if (LoadRecord(record, line)) {
-      database.Insert(record);
-      itemCount++;
-    }
+    LoadRecord(record, line, database);
+    database.Insert(record);
+    itemCount++;
   }
 
+  database.Optimise();
+
   return itemCount;
 }
 
@@ -152,3 +170,51 @@ FlarmNetReader::LoadFile(const TCHAR *path, FlarmNetDatabase &database)
 
   return LoadFile(file, database);
 }
+
+unsigned
+FlarmNetReader::MapFile(const TCHAR *path, FlarmNetDatabase &database)
+{
+  std::unique_ptr<FileMapping> mapping(new FileMapping(path));
+  if (mapping->error())
+    return 0;
+
+  const char *p = (const char *)mapping->data();
+  const char *const end = (const char *)mapping->end();
+
+  unsigned n = 0;
+  bool first = true;
+
+  while (p < end) {
+    const char *const line = p;
+    const char *eol = (const char *)memchr(p, '\n', end - p);
+    if (eol == nullptr)
+      eol = end;
+
+    p = eol + 1;
+
+    if (first) {
+      /* skip first line */
+      first = false;
+      continue;
+    }
+
+    if (size_t(eol - line) < RECORD_LENGTH)
+      continue;
+
+    /* only decode the fields needed for the index now; the rest is
+       decoded by FlarmNetDatabase::GetRecord() */
+    StaticString<LatinBufferSize(7)> id;
+    LoadString(line, 6, id);
+
+    StaticString<LatinBufferSize(4)> callsign;
+    LoadCallSign(line, callsign);
+
+    database.Insert(FlarmId::Parse(id, nullptr), callsign, line);
+    ++n;
+  }
+
+  database.AddMapping(std::move(mapping));
+  database.Optimise();
+
+  return n;
+}
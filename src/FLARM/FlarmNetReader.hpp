@@ -26,6 +26,7 @@ Copyright_License {
 
 #include <tchar.h>
 
+struct FlarmNetRecord;
 class FlarmNetDatabase;
 class NLineReader;
 
@@ -49,6 +50,24 @@ namespace FlarmNetReader
    * @return the number of records read from the file
    */
   unsigned LoadFile(const TCHAR *path, FlarmNetDatabase &database);
+
+  /**
+   * Maps the FlarmNet.org file into memory and indexes its records.
+   * Only the id and the callsign are decoded now; the other fields
+   * are decoded when a record is first looked up.  The mapping is
+   * owned by the database.
+   *
+   * @param path the path of the file
+   * @return the number of records found in the file
+   */
+  unsigned MapFile(const TCHAR *path, FlarmNetDatabase &database);
+
+  /**
+   * Decodes one record line, which must be at least 172 characters
+   * long.  Airfield and plane type are interned in the database.
+   */
+  void LoadRecord(FlarmNetRecord &record, const char *line,
+                  const FlarmNetDatabase &database);
 };
 
 #endif
@@ -27,6 +27,8 @@ Copyright_License {
 #include "Util/StaticString.hxx"
 #include "Compiler.h"
 
+#include <tchar.h>
+
 class FlarmId;
 
 constexpr
@@ -54,11 +56,17 @@ struct FlarmNetRecord {
   /**< Name 15 bytes */
   StaticString<LatinBufferSize(22)> pilot;
 
-  /**< Airfield 4 bytes */
-  StaticString<LatinBufferSize(22)> airfield;
-
-  /**< Aircraft type 1 byte */
-  StaticString<LatinBufferSize(22)> plane_type;
+  /**
+   * Airfield 4 bytes; an interned string owned by the
+   * #FlarmNetDatabase, because many records share it
+   */
+  const TCHAR *airfield = _T("");
+
+  /**
+   * Aircraft type 1 byte; an interned string owned by the
+   * #FlarmNetDatabase
+   */
+  const TCHAR *plane_type = _T("");
 
   /**< Registration 7 bytes */
   StaticString<LatinBufferSize(8)> registration;
@@ -34,20 +34,20 @@ Copyright_License {
 #include "Profile/FlarmProfile.hpp"
 #include "Profile/Current.hpp"
 #include "LogFile.hpp"
+#include "LocalPath.hpp"
 #include "Util/Error.hxx"
 
+#include <windef.h> // for MAX_PATH
+
 /**
  * Loads the FLARMnet file
  */
 static void
 LoadFLARMnet(FlarmNetDatabase &db)
 {
-  NLineReader *reader = OpenDataTextFileA(_T("data.fln"), IgnoreError());
-  if (reader == NULL)
-    return;
-
-  unsigned num_records = FlarmNetReader::LoadFile(*reader, db);
-  delete reader;
+  TCHAR buffer[MAX_PATH];
+  unsigned num_records =
+    FlarmNetReader::MapFile(LocalPath(buffer, _T("data.fln")), db);
 
   if (num_records > 0)
     LogFormat("%u FLARMnet ids found", num_records);
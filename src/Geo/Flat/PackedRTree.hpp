@@ -0,0 +1,280 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+ */
+
+#ifndef XCSOAR_FLAT_PACKED_RTREE_HPP
+#define XCSOAR_FLAT_PACKED_RTREE_HPP
+
+#include "FlatBoundingBox.hpp"
+#include "Compiler.h"
+
+#include <vector>
+#include <algorithm>
+#include <iterator>
+
+#include <assert.h>
+#include <math.h>
+
+/**
+ * A static R-tree of objects with a #FlatBoundingBox.  It is
+ * bulk-loaded with the "Sort-Tile-Recursive" algorithm (Leutenegger
+ * et al. 1997), and all nodes and values are stored in contiguous
+ * arrays, which makes building and querying a lot cheaper than with
+ * a dynamic tree.  The tree cannot be modified after it has been
+ * built; call Load() again to replace its contents.
+ *
+ * @param T the value type; it must be convertible to a const
+ * #FlatBoundingBox reference
+ * @param FANOUT the maximum number of children of a node
+ */
+template<typename T, unsigned FANOUT=16>
+class PackedRTree {
+  static_assert(FANOUT >= 2, "Fan-out too small");
+
+  struct Node {
+    FlatBoundingBox box;
+
+    /**
+     * The index of the first child.  The children of a leaf node are
+     * values, the children of all other nodes are nodes.
+     */
+    unsigned first;
+
+    /**
+     * The number of children.
+     */
+    unsigned count;
+  };
+
+  /**
+   * All values, sorted so each leaf node refers to a contiguous range.
+   */
+  std::vector<T> values;
+
+  /**
+   * All nodes, level by level, from the leaves to the root.  The root
+   * is the last element.  The children of a node are contiguous.
+   */
+  std::vector<Node> nodes;
+
+  /**
+   * The number of leaf nodes, i.e. the index of the first inner node.
+   */
+  unsigned n_leaves = 0;
+
+public:
+  typedef typename std::vector<T>::const_iterator const_iterator;
+
+  bool empty() const {
+    return values.empty();
+  }
+
+  size_t size() const {
+    return values.size();
+  }
+
+  /**
+   * The values are iterated in the order of the leaf nodes, which is
+   * unspecified.
+   */
+  const_iterator begin() const {
+    return values.begin();
+  }
+
+  const_iterator end() const {
+    return values.end();
+  }
+
+  void clear() {
+    values.clear();
+    nodes.clear();
+    n_leaves = 0;
+  }
+
+  /**
+   * Returns the number of bytes allocated by the tree.
+   */
+  gcc_pure
+  size_t GetMemoryUsage() const {
+    return values.capacity() * sizeof(T) + nodes.capacity() * sizeof(Node);
+  }
+
+  /**
+   * Replace the contents with the given values and build the tree.
+   */
+  void Load(std::vector<T> &&_values) {
+    values = std::move(_values);
+    nodes.clear();
+    n_leaves = 0;
+
+    if (values.empty())
+      return;
+
+    /* the leaf level */
+    SortTiles(values.begin(), values.end(),
+              [](const T &value) -> const FlatBoundingBox & {
+                return value;
+              });
+
+    nodes.reserve(CountNodes(values.size()));
+    Pack(values.begin(), values.end(), 0,
+         [](const T &value) -> const FlatBoundingBox & {
+           return value;
+         });
+    n_leaves = nodes.size();
+
+    /* the inner levels, until only the root is left */
+    unsigned level_begin = 0;
+    while (nodes.size() - level_begin > 1) {
+      const unsigned level_end = nodes.size();
+
+      SortTiles(nodes.begin() + level_begin, nodes.end(),
+                [](const Node &node) -> const FlatBoundingBox & {
+                  return node.box;
+                });
+      Pack(nodes.begin() + level_begin, nodes.begin() + level_end,
+           level_begin,
+           [](const Node &node) -> const FlatBoundingBox & {
+             return node.box;
+           });
+
+      level_begin = level_end;
+    }
+  }
+
+  /**
+   * Invoke the visitor for each value whose bounding box overlaps the
+   * given box grown by the given range in all directions.  Touching
+   * boxes are considered overlapping.
+   *
+   * @param visitor a function object which is invoked with a const
+   * reference to the value
+   */
+  template<typename V>
+  void VisitWithinRange(const FlatBoundingBox &box, int range,
+                        V &&visitor) const {
+    if (nodes.empty())
+      return;
+
+    const FlatBoundingBox query(FlatGeoPoint(box.GetLeft() - range,
+                                             box.GetBottom() - range),
+                                FlatGeoPoint(box.GetRight() + range,
+                                             box.GetTop() + range));
+
+    const unsigned root = nodes.size() - 1;
+    if (Overlaps(nodes[root].box, query))
+      Visit(root, query, visitor);
+  }
+
+private:
+  gcc_const
+  static bool Overlaps(const FlatBoundingBox &a, const FlatBoundingBox &b) {
+    return a.GetLeft() <= b.GetRight() && a.GetRight() >= b.GetLeft() &&
+      a.GetBottom() <= b.GetTop() && a.GetTop() >= b.GetBottom();
+  }
+
+  /**
+   * Calculate the total number of nodes of a tree with the given
+   * number of values.
+   */
+  gcc_const
+  static unsigned CountNodes(unsigned n) {
+    unsigned total = 0;
+    do {
+      n = (n + FANOUT - 1) / FANOUT;
+      total += n;
+    } while (n > 1);
+    return total;
+  }
+
+  /**
+   * Sort the elements into vertical slices by the x coordinate of
+   * their centres, and each slice by the y coordinate, so that each
+   * run of #FANOUT elements is a compact tile.
+   */
+  template<typename I, typename B>
+  static void SortTiles(I begin, I end, B get_box) {
+    typedef typename std::iterator_traits<I>::value_type E;
+
+    const unsigned n = end - begin;
+    const unsigned n_parents = (n + FANOUT - 1) / FANOUT;
+    const unsigned n_slices = (unsigned)ceil(sqrt((double)n_parents));
+    const unsigned slice_size = n_slices * FANOUT;
+
+    /* compare the centres multiplied by 2, which avoids rounding */
+    std::sort(begin, end, [get_box](const E &a, const E &b){
+        const FlatBoundingBox &ba = get_box(a), &bb = get_box(b);
+        return ba.GetLeft() + ba.GetRight() < bb.GetLeft() + bb.GetRight();
+      });
+
+    for (I i = begin; i != end;) {
+      const I slice_end = i + std::min(slice_size, unsigned(end - i));
+      std::sort(i, slice_end, [get_box](const E &a, const E &b){
+          const FlatBoundingBox &ba = get_box(a), &bb = get_box(b);
+          return ba.GetBottom() + ba.GetTop() < bb.GetBottom() + bb.GetTop();
+        });
+      i = slice_end;
+    }
+  }
+
+  /**
+   * Create one parent node for each run of #FANOUT elements and
+   * append it to #nodes.  The capacity of #nodes must be large
+   * enough, because the elements may be nodes, too.
+   *
+   * @param offset the index of the first element
+   */
+  template<typename I, typename B>
+  void Pack(I begin, I end, unsigned offset, B get_box) {
+    const unsigned n = end - begin;
+
+    for (unsigned i = 0; i < n; i += FANOUT) {
+      assert(nodes.size() < nodes.capacity());
+
+      Node node;
+      node.first = offset + i;
+      node.count = std::min(FANOUT, n - i);
+      node.box = get_box(begin[i]);
+      for (unsigned j = 1; j < node.count; ++j)
+        node.box.Merge(get_box(begin[i + j]));
+
+      nodes.push_back(node);
+    }
+  }
+
+  template<typename V>
+  void Visit(unsigned i, const FlatBoundingBox &query, V &visitor) const {
+    const Node &node = nodes[i];
+    const unsigned end = node.first + node.count;
+
+    if (i < n_leaves) {
+      for (unsigned j = node.first; j < end; ++j)
+        if (Overlaps(values[j], query))
+          visitor(values[j]);
+    } else {
+      for (unsigned j = node.first; j < end; ++j)
+        if (Overlaps(nodes[j].box, query))
+          Visit(j, query, visitor);
+    }
+  }
+};
+
+#endif
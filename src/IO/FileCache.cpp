@@ -23,6 +23,7 @@ Copyright_License {
 
 #include "FileCache.hpp"
 #include "OS/FileUtil.hpp"
+#include "OS/FileMapping.hpp"
 #include "Compatibility/path.h"
 #include "Compiler.h"
 
@@ -184,6 +185,28 @@ FileCache::Load(const TCHAR *name, const TCHAR *original_path)
   return file;
 }
 
+FileMapping *
+FileCache::LoadMapping(const TCHAR *name, const TCHAR *original_path)
+{
+  /* validate the cache file header */
+  FILE *file = Load(name, original_path);
+  if (file == nullptr)
+    return nullptr;
+
+  fclose(file);
+
+  TCHAR path[PathBufferSize(name)];
+  MakeCachePath(path, name);
+
+  FileMapping *mapping = new FileMapping(path);
+  if (mapping->error()) {
+    delete mapping;
+    return nullptr;
+  }
+
+  return mapping;
+}
+
 FILE *
 FileCache::Save(const TCHAR *name, const TCHAR *original_path)
 {
@@ -27,6 +27,8 @@ Copyright_License {
 #include <stdio.h>
 #include <tchar.h>
 
+class FileMapping;
+
 class FileCache {
   TCHAR *cache_path;
   size_t cache_path_length;
@@ -43,6 +45,17 @@ public:
   void Flush(const TCHAR *name);
   FILE *Load(const TCHAR *name, const TCHAR *original_path);
 
+  /**
+   * Like Load(), but map the whole cache file into memory.  Offsets
+   * within the mapping are absolute file offsets, i.e. the values
+   * returned by ftell() while the file was being written after
+   * Save().
+   *
+   * @return a #FileMapping which must be freed by the caller, or
+   * nullptr if the cache is missing or stale
+   */
+  FileMapping *LoadMapping(const TCHAR *name, const TCHAR *original_path);
+
   FILE *Save(const TCHAR *name, const TCHAR *original_path);
   bool Commit(const TCHAR *name, FILE *file);
   void Cancel(const TCHAR *name, FILE *file);
@@ -34,6 +34,12 @@ Copyright_License {
 #include <tchar.h>
 #endif
 
+#ifdef HAVE_POSIX
+#include <unistd.h>
+#elif defined(WIN32)
+#include <io.h>
+#endif
+
 class FileHandle {
 private:
   FILE *file;
@@ -86,6 +92,23 @@ public:
     return fflush(file) == 0;
   }
 
+  /**
+   * Like Flush(), but additionally wait until the operating system
+   * has written all data to the physical device.
+   */
+  bool Sync() {
+    if (!Flush())
+      return false;
+
+#ifdef HAVE_POSIX
+    return fsync(fileno(file)) == 0;
+#elif defined(WIN32)
+    return _commit(_fileno(file)) == 0;
+#else
+    return true;
+#endif
+  }
+
   bool Seek(long offset, int whence) {
     assert(file != nullptr);
     return fseek(file, offset, whence) == 0;
@@ -0,0 +1,218 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "AsyncLineWriter.hpp"
+#include "OS/Clock.hpp"
+
+#include <algorithm>
+
+#include <string.h>
+
+#ifdef HAVE_POSIX
+static constexpr char line_ending[] = "\n";
+#else
+static constexpr char line_ending[] = "\r\n";
+#endif
+
+AsyncLineWriter::AsyncLineWriter(const TCHAR *path)
+  :Thread("AsyncLineWriter"),
+   file(path, _T("wb")),
+   slots(new Slot[QUEUE_SIZE]),
+   enqueue_position(0), dequeue_position(0),
+   n_dropped(0), wakeup(false),
+   buffer(new char[BLOCK_SIZE])
+{
+  for (unsigned i = 0; i < QUEUE_SIZE; ++i)
+    slots[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+AsyncLineWriter::~AsyncLineWriter()
+{
+  assert(!IsDefined());
+}
+
+void
+AsyncLineWriter::StopAndJoin()
+{
+  {
+    const ScopeLock protect(mutex);
+    stop = true;
+    cond.signal();
+  }
+
+  Join();
+}
+
+bool
+AsyncLineWriter::WriteLine(const char *line)
+{
+  const size_t length = strlen(line);
+  if (length > MAX_LINE) {
+    n_dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  size_t position = enqueue_position.load(std::memory_order_relaxed);
+  Slot *slot;
+  while (true) {
+    slot = &slots[position & (QUEUE_SIZE - 1)];
+    const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+    const ptrdiff_t difference = ptrdiff_t(sequence) - ptrdiff_t(position);
+
+    if (difference == 0) {
+      /* the slot is free; try to claim it */
+      if (enqueue_position.compare_exchange_weak(position, position + 1,
+                                                 std::memory_order_relaxed))
+        break;
+    } else if (difference < 0) {
+      /* the writer thread has not consumed this slot yet: the queue
+         is full */
+      n_dropped.fetch_add(1, std::memory_order_relaxed);
+      Wakeup();
+      return false;
+    } else
+      /* another producer was faster */
+      position = enqueue_position.load(std::memory_order_relaxed);
+  }
+
+  /* the writer thread cannot pass this slot before it is filled, so
+     this difference is never negative */
+  const size_t depth =
+    position - dequeue_position.load(std::memory_order_relaxed);
+
+  memcpy(slot->data, line, length);
+  slot->length = length;
+  slot->sequence.store(position + 1, std::memory_order_release);
+
+  if (depth >= QUEUE_SIZE / 2)
+    Wakeup();
+
+  return true;
+}
+
+void
+AsyncLineWriter::Wakeup()
+{
+  if (wakeup.exchange(true, std::memory_order_relaxed))
+    /* already requested */
+    return;
+
+  const ScopeLock protect(mutex);
+  cond.signal();
+}
+
+void
+AsyncLineWriter::Drain()
+{
+  size_t position = dequeue_position.load(std::memory_order_relaxed);
+
+  while (true) {
+    Slot &slot = slots[position & (QUEUE_SIZE - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+      /* empty, or the producer has not finished copying yet */
+      break;
+
+    Append(slot.data, slot.length);
+    Append(line_ending, sizeof(line_ending) - 1);
+
+    slot.sequence.store(position + QUEUE_SIZE, std::memory_order_release);
+    dequeue_position.store(++position, std::memory_order_relaxed);
+  }
+}
+
+void
+AsyncLineWriter::Append(const char *data, size_t length)
+{
+  while (length > 0) {
+    /* fill the buffer only up to the next block boundary of the
+       file, so all full writes are aligned */
+    const size_t limit = BLOCK_SIZE - file_position % BLOCK_SIZE;
+    assert(buffer_fill < limit);
+
+    const size_t n = std::min(length, limit - buffer_fill);
+    memcpy(buffer.get() + buffer_fill, data, n);
+    buffer_fill += n;
+    data += n;
+    length -= n;
+
+    if (buffer_fill == limit)
+      WriteBuffer();
+  }
+}
+
+void
+AsyncLineWriter::WriteBuffer()
+{
+  if (buffer_fill == 0)
+    return;
+
+  /* errors are ignored; there is nobody to report them to, and the
+     thread must keep draining the queue */
+  if (file.IsOpen())
+    file.Write(buffer.get(), 1, buffer_fill);
+
+  file_position += buffer_fill;
+  unsynced_bytes += buffer_fill;
+  buffer_fill = 0;
+}
+
+void
+AsyncLineWriter::Sync()
+{
+  WriteBuffer();
+
+  if (unsynced_bytes > 0 && file.IsOpen())
+    file.Sync();
+
+  unsynced_bytes = 0;
+  last_sync_ms = MonotonicClockMS();
+}
+
+void
+AsyncLineWriter::Run()
+{
+  last_sync_ms = MonotonicClockMS();
+
+  const ScopeLock protect(mutex);
+
+  while (true) {
+    const bool stopping = stop;
+
+    {
+      const ScopeUnlock unlock(mutex);
+
+      wakeup.store(false, std::memory_order_relaxed);
+      Drain();
+
+      if (stopping || unsynced_bytes >= SYNC_BYTES ||
+          MonotonicClockMS() - last_sync_ms >= SYNC_INTERVAL_MS)
+        Sync();
+    }
+
+    if (stopping)
+      break;
+
+    if (!stop && !wakeup.load(std::memory_order_relaxed))
+      cond.timed_wait(mutex, POLL_INTERVAL_MS);
+  }
+}
@@ -0,0 +1,221 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_ASYNC_LINE_WRITER_HPP
+#define XCSOAR_ASYNC_LINE_WRITER_HPP
+
+#include "IO/FileHandle.hpp"
+#include "Thread/Thread.hpp"
+#include "Thread/Mutex.hpp"
+#include "Thread/Cond.hxx"
+#include "Compiler.h"
+
+#include <atomic>
+#include <memory>
+
+#include <stddef.h>
+#include <tchar.h>
+
+/**
+ * Appends lines to a text file in a dedicated thread, so a slow
+ * storage device never blocks the threads which produce the lines.
+ *
+ * WriteLine() copies the line into a bounded lock-free queue, which
+ * may be fed by any number of threads.  The writer thread drains the
+ * queue into a buffer and writes it in blocks of #BLOCK_SIZE bytes,
+ * aligned to the file offset.  A partially filled block is only
+ * written when the file gets synced, which happens after
+ * #SYNC_INTERVAL_MS or after #SYNC_BYTES bytes.
+ *
+ * If the queue is full, the line is discarded and counted; the
+ * producer never waits.
+ */
+class AsyncLineWriter final : Thread {
+public:
+  /**
+   * The maximum length of a line, not including the line ending.
+   * Longer lines are discarded.
+   */
+  static constexpr size_t MAX_LINE = 255;
+
+  /**
+   * The number of lines the queue can hold; must be a power of two.
+   */
+  static constexpr unsigned QUEUE_SIZE = 1024;
+
+  static constexpr size_t BLOCK_SIZE = 16384;
+
+  static constexpr unsigned SYNC_INTERVAL_MS = 2000;
+  static constexpr size_t SYNC_BYTES = 16 * BLOCK_SIZE;
+
+private:
+  static_assert((QUEUE_SIZE & (QUEUE_SIZE - 1)) == 0,
+                "QUEUE_SIZE must be a power of two");
+
+  /**
+   * How often does the thread wake up to drain the queue?
+   */
+  static constexpr unsigned POLL_INTERVAL_MS = 250;
+
+  /**
+   * A slot of the queue.  The sequence number tells which "lap" of
+   * the ring buffer it belongs to, and whether it has been filled
+   * (see Dmitry Vyukov's bounded MPMC queue).
+   */
+  struct Slot {
+    std::atomic<size_t> sequence;
+    unsigned length;
+    char data[MAX_LINE];
+  };
+
+  FileHandle file;
+
+  std::unique_ptr<Slot[]> slots;
+
+  /**
+   * The position of the next slot to be filled by a producer.
+   */
+  std::atomic<size_t> enqueue_position;
+
+  /**
+   * The position of the next slot to be consumed by the writer
+   * thread.  Only the writer thread modifies it; it is atomic only
+   * for GetQueueDepth().
+   */
+  std::atomic<size_t> dequeue_position;
+
+  std::atomic<unsigned> n_dropped;
+
+  /**
+   * Has a producer asked the thread to wake up early?  This limits
+   * locking the mutex to once per wakeup.
+   */
+  std::atomic<bool> wakeup;
+
+  /**
+   * Protects #stop, and is used with #cond to let the thread sleep.
+   */
+  Mutex mutex;
+  Cond cond;
+
+  bool stop = false;
+
+  /**
+   * Data which has been taken from the queue, but has not been
+   * written yet.  Only accessed by the writer thread.
+   */
+  std::unique_ptr<char[]> buffer;
+  size_t buffer_fill = 0;
+
+  /**
+   * The number of bytes written to #file so far.
+   */
+  size_t file_position = 0;
+
+  /**
+   * The number of bytes written since the last sync, and the time
+   * of the last sync.
+   */
+  size_t unsynced_bytes = 0;
+  unsigned last_sync_ms;
+
+public:
+  /**
+   * Create the file, replacing an existing one.  The caller must check
+   * IsOpen() and then call Start().
+   */
+  explicit AsyncLineWriter(const TCHAR *path);
+
+  /**
+   * The thread must have been stopped with StopAndJoin().
+   */
+  ~AsyncLineWriter();
+
+  bool IsOpen() const {
+    return file.IsOpen();
+  }
+
+  void Start() {
+    Thread::Start();
+  }
+
+  /**
+   * Write all queued lines, sync the file and wait for the thread to
+   * exit.  Lines submitted afterwards are not written.
+   */
+  void StopAndJoin();
+
+  /**
+   * Submit a line for writing, without the line ending.  This
+   * method is thread-safe and does not block.
+   *
+   * @return false if the line has been discarded, because the queue
+   * was full or the line was too long
+   */
+  bool WriteLine(const char *line);
+
+  /**
+   * Returns the number of lines which have been discarded by
+   * WriteLine().
+   */
+  gcc_pure
+  unsigned GetDroppedLines() const {
+    return n_dropped.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Returns the number of lines waiting in the queue.
+   */
+  gcc_pure
+  unsigned GetQueueDepth() const {
+    const size_t dequeue = dequeue_position.load(std::memory_order_relaxed);
+    const size_t enqueue = enqueue_position.load(std::memory_order_relaxed);
+    return enqueue > dequeue ? enqueue - dequeue : 0;
+  }
+
+private:
+  void Wakeup();
+
+  /**
+   * Move all queued lines into the buffer, and write full blocks.
+   */
+  void Drain();
+
+  void Append(const char *data, size_t length);
+
+  /**
+   * Write the buffer to the file, but not beyond the next block
+   * boundary of the file.
+   */
+  void WriteBuffer();
+
+  /**
+   * Write everything and sync the file.
+   */
+  void Sync();
+
+  /* virtual methods from class Thread */
+  void Run() override;
+};
+
+#endif
@@ -22,8 +22,9 @@ Copyright_License {
 */
 
 #include "Logger/NMEALogger.hpp"
-#include "IO/TextWriter.hpp"
+#include "Logger/AsyncLineWriter.hpp"
 #include "LocalPath.hpp"
+#include "LogFile.hpp"
 #include "Time/BrokenDateTime.hpp"
 #include "Thread/Mutex.hpp"
 #include "OS/FileUtil.hpp"
@@ -32,21 +33,34 @@ Copyright_License {
 #include <windef.h> // for MAX_PATH
 #include <stdio.h>
 
+#include <atomic>
+
 namespace NMEALogger
 {
+  /**
+   * Protects the creation of #writer.
+   */
   static Mutex mutex;
-  static TextWriter *writer;
+
+  /**
+   * The file is written by a separate thread, so a slow storage
+   * device does not delay the port threads calling Log().
+   */
+  static std::atomic<AsyncLineWriter *> writer;
 
   bool enabled = false;
 
-  static bool Start();
+  static AsyncLineWriter *Start();
 }
 
-bool
+AsyncLineWriter *
 NMEALogger::Start()
 {
-  if (writer != nullptr)
-    return true;
+  const ScopeLock protect(mutex);
+
+  AsyncLineWriter *w = writer.load(std::memory_order_relaxed);
+  if (w != nullptr)
+    return w;
 
   BrokenDateTime dt = BrokenDateTime::NowUTC();
   assert(dt.IsPlausible());
@@ -60,14 +74,25 @@ NMEALogger::Start()
   Directory::Create(LocalPath(buffer, _T("logs")));
 
   const auto path = LocalPath(buffer, _T("logs"), name);
-  writer = new TextWriter(path, false);
-  return writer != nullptr;
+  w = new AsyncLineWriter(path);
+  w->Start();
+  writer.store(w, std::memory_order_release);
+  return w;
 }
 
 void
 NMEALogger::Shutdown()
 {
-  delete writer;
+  AsyncLineWriter *w = writer.exchange(nullptr);
+  if (w == nullptr)
+    return;
+
+  w->StopAndJoin();
+
+  if (w->GetDroppedLines() > 0)
+    LogFormat("NMEA logger dropped %u lines", w->GetDroppedLines());
+
+  delete w;
 }
 
 void
@@ -76,7 +101,9 @@ NMEALogger::Log(const char *text)
   if (!enabled)
     return;
 
-  ScopeLock protect(mutex);
-  if (Start())
-    writer->WriteLine(text);
+  AsyncLineWriter *w = writer.load(std::memory_order_acquire);
+  if (w == nullptr)
+    w = Start();
+
+  w->WriteLine(text);
 }
@@ -25,6 +25,7 @@ Copyright_License {
 #include "Terrain/RasterTerrain.hpp"
 #include "Topography/Thread.hpp"
 #include "Terrain/Thread.hpp"
+#include "Terrain/PrefetchGlue.hpp"
 #include "Interface.hpp"
 #include "Profile/Profile.hpp"
 #include "Screen/Layout.hpp"
@@ -123,7 +124,9 @@ GlueMapWindow::UpdateScreenBounds()
      display is enabled */
   if (terrain_thread != nullptr &&
       visible_projection.IsValid())
-    terrain_thread->Trigger(visible_projection);
+    terrain_thread->Trigger(visible_projection,
+                            GetTerrainPrefetch(CommonInterface::Basic(),
+                                               CommonInterface::Calculated()));
 }
 
 void
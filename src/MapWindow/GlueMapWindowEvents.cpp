@@ -34,6 +34,7 @@ Copyright_License {
 #include "Util/Clamp.hpp"
 #include "Event/Idle.hpp"
 #include "Topography/Thread.hpp"
+#include "Profiler/Profiler.hpp"
 
 #ifdef USE_X11
 #include "Event/Globals.hpp"
@@ -461,7 +462,7 @@ GlueMapWindow::Render(Canvas &canvas, const PixelRect &rc)
   MapWindow::Render(canvas, rc);
 
   if (IsNearSelf()) {
-    draw_sw.Mark("DrawGlueMisc");
+    const ProfileScope scope("DrawGlueMisc");
     if (GetMapSettings().show_thermal_profile)
       DrawThermalBand(canvas, rc);
     DrawStallRatio(canvas, rc);
@@ -28,6 +28,7 @@ Copyright_License {
 #include "Terrain/RasterWeatherCache.hpp"
 #include "Computer/GlideComputer.hpp"
 #include "Operation/Operation.hpp"
+#include "Profiler/Profiler.hpp"
 
 #ifdef ENABLE_OPENGL
 #include "Screen/OpenGL/Scissor.hpp"
@@ -160,9 +161,10 @@ MapWindow::OnPaintBuffer(Canvas &canvas)
   GLCanvasScissor scissor(canvas);
 #endif
 
+  const ProfileScope scope("PaintMap");
+
   // Render the moving map
   Render(canvas, GetClientRect());
-  draw_sw.Finish();
 
 #ifndef ENABLE_OPENGL
   /* save the generation number which was active when rendering had
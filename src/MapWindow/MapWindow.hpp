@@ -31,7 +31,6 @@ Copyright_License {
 #include "Screen/BufferCanvas.hpp"
 #endif
 #include "Renderer/LabelBlock.hpp"
-#include "Screen/StopWatch.hpp"
 #include "MapWindowBlackboard.hpp"
 #include "Renderer/AirspaceLabelRenderer.hpp"
 #include "Renderer/BackgroundRenderer.hpp"
@@ -161,12 +160,6 @@ protected:
   unsigned scale_buffer = 0;
 #endif
 
-  /**
-   * The #StopWatch used to benchmark the DrawThread,
-   * i.e. OnPaintBuffer().
-   */
-  ScreenStopWatch draw_sw;
-
   friend class DrawThread;
 
 public:
@@ -26,6 +26,7 @@ Copyright_License {
 #include "Topography/CachedTopographyRenderer.hpp"
 #include "Renderer/AircraftRenderer.hpp"
 #include "Renderer/WaveRenderer.hpp"
+#include "Profiler/Profiler.hpp"
 
 #ifdef HAVE_NOAA
 #include "Weather/NOAAStore.hpp"
@@ -143,37 +144,37 @@ MapWindow::Render(Canvas &canvas, const PixelRect &rc)
       aircraft_pos = render_projection.GeoToScreen(basic.location);
 
   // Render terrain, groundline and topography
-  draw_sw.Mark("RenderTerrain");
+  ProfileScope scope("RenderTerrain");
   RenderTerrain(canvas);
 
-  draw_sw.Mark("RenderTopography");
+  scope.Next("RenderTopography");
   RenderTopography(canvas);
 
-  draw_sw.Mark("RenderFinalGlideShading");
+  scope.Next("RenderFinalGlideShading");
   RenderFinalGlideShading(canvas);
 
   // Render track bearing (projected track ground/air relative)
-  draw_sw.Mark("DrawTrackBearing");
+  scope.Next("DrawTrackBearing");
   RenderTrackBearing(canvas, aircraft_pos);
 
   // Render airspace
-  draw_sw.Mark("RenderAirspace");
+  scope.Next("RenderAirspace");
   RenderAirspace(canvas);
 
   // Render task, waypoints
-  draw_sw.Mark("DrawContest");
+  scope.Next("DrawContest");
   DrawContest(canvas);
 
-  draw_sw.Mark("DrawTask");
+  scope.Next("DrawTask");
   DrawTask(canvas);
 
-  draw_sw.Mark("DrawWaypoints");
+  scope.Next("DrawWaypoints");
   DrawWaypoints(canvas);
 
-  draw_sw.Mark("DrawNOAAStations");
+  scope.Next("DrawNOAAStations");
   RenderNOAAStations(canvas);
 
-  draw_sw.Mark("RenderMisc1");
+  scope.Next("RenderMisc1");
   // Render weather/terrain max/min values
   DrawTaskOffTrackIndicator(canvas);
 
@@ -187,14 +188,14 @@ MapWindow::Render(Canvas &canvas, const PixelRect &rc)
   DrawThermalEstimate(canvas);
 
   // Render topography on top of airspace, to keep the text readable
-  draw_sw.Mark("RenderTopographyLabels");
+  scope.Next("RenderTopographyLabels");
   RenderTopographyLabels(canvas);
 
   // Render glide through terrain range
-  draw_sw.Mark("RenderGlide");
+  scope.Next("RenderGlide");
   RenderGlide(canvas);
 
-  draw_sw.Mark("RenderMisc2");
+  scope.Next("RenderMisc2");
 
   DrawBestCruiseTrack(canvas, aircraft_pos);
 
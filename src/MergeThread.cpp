@@ -28,6 +28,7 @@ Copyright_License {
 #include "NMEA/MoreData.hpp"
 #include "Audio/VarioGlue.hpp"
 #include "Device/MultipleDevices.hpp"
+#include "Profiler/Profiler.hpp"
 
 MergeThread::MergeThread(DeviceBlackboard &_device_blackboard)
   :WorkerThread("MergeThread", 150, 50, 20),
@@ -59,6 +60,8 @@ MergeThread::Process()
 void
 MergeThread::Tick()
 {
+  Profiler::RegisterThread("MergeThread");
+
   bool gps_updated, calculated_updated;
 
 #ifdef HAVE_PCM_PLAYER
@@ -67,6 +70,7 @@ MergeThread::Tick()
 #endif
 
   {
+    const ProfileScope scope("Merge");
     ScopeLock protect(device_blackboard.mutex);
 
     Process();
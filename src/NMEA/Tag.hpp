@@ -0,0 +1,62 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_NMEA_TAG_HPP
+#define XCSOAR_NMEA_TAG_HPP
+
+#include <stdint.h>
+
+/**
+ * A sentence type (e.g. "$PFLAA") packed into an integer, which
+ * allows dispatching with a "switch" statement instead of a chain of
+ * string comparisons:
+ *
+ * <pre>
+ *   switch (NMEATag(type)) {
+ *   case NMEATag("$PFLAA"):
+ *     ...
+ *   }
+ * </pre>
+ *
+ * The compiler builds the lookup (a jump table or a binary search)
+ * at compile time, and rejects duplicate tags.  Tags are unique for
+ * strings of up to #MAX_NMEA_TAG characters; longer strings are
+ * mapped to 0, which never matches a valid tag.
+ */
+typedef uint64_t NMEATagValue;
+
+static constexpr unsigned MAX_NMEA_TAG = sizeof(NMEATagValue);
+
+constexpr
+static inline NMEATagValue
+NMEATag(const char *p, unsigned i=0, NMEATagValue value=0)
+{
+  return p[i] == 0
+    ? value
+    : (i == MAX_NMEA_TAG
+       ? 0
+       : NMEATag(p, i + 1,
+                 value | (NMEATagValue((unsigned char)p[i]) << (8 * i))));
+}
+
+#endif
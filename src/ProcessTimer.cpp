@@ -45,6 +45,7 @@ Copyright_License {
 #include "Tracking/TrackingGlue.hpp"
 #include "Operation/MessageOperationEnvironment.hpp"
 #include "Event/Idle.hpp"
+#include "Profiler/Glue.hpp"
 
 static void
 MessageProcessTimer()
@@ -196,6 +197,8 @@ CommonProcessTimer()
 
   MessageProcessTimer();
   SystemProcessTimer();
+
+  ProfilerGlue::ProcessTimer();
 }
 
 static void
@@ -0,0 +1,102 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Glue.hpp"
+#include "Profiler.hpp"
+#include "TraceWriter.hpp"
+#include "IO/TextWriter.hpp"
+#include "LocalPath.hpp"
+#include "Time/BrokenDateTime.hpp"
+#include "Time/PeriodClock.hpp"
+#include "OS/FileUtil.hpp"
+#include "Util/StaticString.hxx"
+#include "LogFile.hpp"
+
+#include <windef.h> // for MAX_PATH
+
+namespace ProfilerGlue {
+  static TextWriter *file;
+  static Profiler::TraceWriter *trace;
+
+  /**
+   * Limits how often the trace file is written.  Each ring buffer
+   * holds several seconds of spans, so this must be well below that.
+   */
+  static PeriodClock flush_clock;
+}
+
+bool
+ProfilerGlue::StartTrace()
+{
+  StopTrace();
+
+  BrokenDateTime dt = BrokenDateTime::NowUTC();
+  assert(dt.IsPlausible());
+
+  StaticString<64> name;
+  name.Format(_T("%04u-%02u-%02u_%02u-%02u-%02u.trace.json"),
+              dt.year, dt.month, dt.day,
+              dt.hour, dt.minute, dt.second);
+
+  TCHAR buffer[MAX_PATH];
+  Directory::Create(LocalPath(buffer, _T("logs")));
+
+  const auto path = LocalPath(buffer, _T("logs"), name);
+  file = new TextWriter(path, false);
+  if (!file->IsOpen()) {
+    LogFormat(_T("Failed to create %s"), path);
+    delete file;
+    file = nullptr;
+    return false;
+  }
+
+  Profiler::SetEnabled(true);
+  trace = new Profiler::TraceWriter(*file);
+  flush_clock.Update();
+  return true;
+}
+
+void
+ProfilerGlue::StopTrace()
+{
+  if (trace == nullptr)
+    return;
+
+  delete trace;
+  trace = nullptr;
+  delete file;
+  file = nullptr;
+}
+
+bool
+ProfilerGlue::IsTracing()
+{
+  return trace != nullptr;
+}
+
+void
+ProfilerGlue::ProcessTimer()
+{
+  if (trace != nullptr && flush_clock.CheckUpdate(1000))
+    trace->Flush();
+}
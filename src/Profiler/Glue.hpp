@@ -0,0 +1,57 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_PROFILER_GLUE_HPP
+#define XCSOAR_PROFILER_GLUE_HPP
+
+#include "Compiler.h"
+
+/**
+ * Glue code which writes the profiler spans to a trace file in the
+ * "logs" directory.  All functions must be called from the main
+ * thread.
+ */
+namespace ProfilerGlue {
+  /**
+   * Enable the profiler and begin writing a new trace file.
+   *
+   * @return false if the file could not be created
+   */
+  bool StartTrace();
+
+  /**
+   * Finish the trace file (if one is being written).  The profiler
+   * stays enabled.
+   */
+  void StopTrace();
+
+  gcc_pure
+  bool IsTracing();
+
+  /**
+   * Called periodically; appends new spans to the trace file.
+   */
+  void ProcessTimer();
+};
+
+#endif
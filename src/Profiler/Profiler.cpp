@@ -0,0 +1,244 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Profiler.hpp"
+#include "Thread/Handle.hpp"
+#include "Thread/Mutex.hpp"
+
+#include <assert.h>
+#include <string.h>
+
+namespace Profiler {
+  /**
+   * One element of a ring buffer.  The span is stored in atomic
+   * fields, and #sequence tells readers whether they have copied a
+   * consistent span (a sequence lock), because the owning thread may
+   * overwrite it at any time.
+   */
+  struct Slot {
+    /**
+     * The position of the span in the thread's sequence of spans plus
+     * one, or 0 while the span is being written.  Position 0xffffffff
+     * is indistinguishable from "being written", and is discarded.
+     */
+    std::atomic<unsigned> sequence;
+
+    std::atomic<const char *> name;
+    std::atomic<uint64_t> start;
+    std::atomic<unsigned> duration;
+
+    void Store(unsigned position, const Span &span) {
+      sequence.store(0, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+
+      name.store(span.name, std::memory_order_relaxed);
+      start.store(span.start, std::memory_order_relaxed);
+      duration.store(span.duration, std::memory_order_relaxed);
+
+      sequence.store(position + 1, std::memory_order_release);
+    }
+
+    /**
+     * Copy the span at the given position.
+     *
+     * @return false if the slot does not contain that span (anymore)
+     */
+    bool Load(unsigned position, Span &span) const {
+      if (sequence.load(std::memory_order_acquire) != position + 1)
+        return false;
+
+      span.name = name.load(std::memory_order_relaxed);
+      span.start = start.load(std::memory_order_relaxed);
+      span.duration = duration.load(std::memory_order_relaxed);
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return sequence.load(std::memory_order_relaxed) == position + 1;
+    }
+  };
+
+  struct ThreadBuffer {
+    ThreadHandle handle;
+    const char *name;
+
+    /**
+     * The ring buffer; nullptr until the profiler gets enabled.  It
+     * is never freed.
+     */
+    std::atomic<Slot *> slots;
+
+    /**
+     * The number of spans ever written.  Only the owning thread
+     * modifies it.
+     */
+    std::atomic<unsigned> head;
+  };
+
+  std::atomic<bool> enabled(false);
+
+  /**
+   * Protects registration and allocation.  Recording and reading do
+   * not use it.
+   */
+  static Mutex mutex;
+
+  static ThreadBuffer threads[MAX_THREADS];
+
+  /**
+   * The number of initialised elements in #threads.
+   */
+  static std::atomic<unsigned> n_threads(0);
+
+  gcc_pure
+  static ThreadBuffer *FindCurrent();
+
+  static void Allocate(ThreadBuffer &thread);
+}
+
+Profiler::ThreadBuffer *
+Profiler::FindCurrent()
+{
+  const unsigned n = n_threads.load(std::memory_order_acquire);
+  const ThreadHandle current = ThreadHandle::GetCurrent();
+  for (unsigned i = 0; i < n; ++i)
+    if (threads[i].handle == current)
+      return &threads[i];
+
+  return nullptr;
+}
+
+void
+Profiler::Allocate(ThreadBuffer &thread)
+{
+  if (thread.slots.load(std::memory_order_relaxed) == nullptr)
+    thread.slots.store(new Slot[CAPACITY](), std::memory_order_release);
+}
+
+void
+Profiler::SetEnabled(bool value)
+{
+  const ScopeLock protect(mutex);
+
+  if (value) {
+    const unsigned n = n_threads.load(std::memory_order_relaxed);
+    for (unsigned i = 0; i < n; ++i)
+      Allocate(threads[i]);
+  }
+
+  enabled.store(value, std::memory_order_relaxed);
+}
+
+bool
+Profiler::RegisterThread(const char *name)
+{
+  if (FindCurrent() != nullptr)
+    return true;
+
+  const ScopeLock protect(mutex);
+
+  const unsigned n = n_threads.load(std::memory_order_relaxed);
+  for (unsigned i = 0; i < n; ++i) {
+    if (strcmp(threads[i].name, name) == 0) {
+      threads[i].handle = ThreadHandle::GetCurrent();
+      return true;
+    }
+  }
+
+  if (n >= MAX_THREADS)
+    return false;
+
+  ThreadBuffer &thread = threads[n];
+  thread.handle = ThreadHandle::GetCurrent();
+  thread.name = name;
+  if (IsEnabled())
+    Allocate(thread);
+
+  n_threads.store(n + 1, std::memory_order_release);
+  return true;
+}
+
+void
+Profiler::Record(const char *name, uint64_t start, uint64_t end)
+{
+  ThreadBuffer *thread = FindCurrent();
+  if (thread == nullptr)
+    return;
+
+  Slot *slots = thread->slots.load(std::memory_order_acquire);
+  if (slots == nullptr)
+    return;
+
+  const unsigned head = thread->head.load(std::memory_order_relaxed);
+  slots[head & (CAPACITY - 1)].Store(head,
+                                     {name, start, unsigned(end - start)});
+  thread->head.store(head + 1, std::memory_order_release);
+}
+
+unsigned
+Profiler::GetThreadCount()
+{
+  return n_threads.load(std::memory_order_acquire);
+}
+
+const char *
+Profiler::GetThreadName(unsigned thread)
+{
+  assert(thread < GetThreadCount());
+
+  return threads[thread].name;
+}
+
+void
+Profiler::Read(unsigned i, unsigned &cursor, std::vector<Span> &dest)
+{
+  assert(i < GetThreadCount());
+
+  const ThreadBuffer &thread = threads[i];
+  const Slot *slots = thread.slots.load(std::memory_order_acquire);
+  if (slots == nullptr)
+    return;
+
+  const unsigned head = thread.head.load(std::memory_order_acquire);
+  unsigned begin = cursor;
+  if (head - begin > CAPACITY)
+    /* the writer has overtaken us */
+    begin = head - CAPACITY;
+
+  /* skip the spans which are overwritten while we are copying
+     them */
+  Span span;
+  for (unsigned j = begin; j != head; ++j)
+    if (slots[j & (CAPACITY - 1)].Load(j, span))
+      dest.push_back(span);
+
+  cursor = head;
+}
+
+void
+Profiler::ReadAll(unsigned i, std::vector<Span> &dest)
+{
+  assert(i < GetThreadCount());
+
+  const unsigned head = threads[i].head.load(std::memory_order_acquire);
+  unsigned cursor = head > CAPACITY ? head - CAPACITY : 0;
+  Read(i, cursor, dest);
+}
@@ -0,0 +1,176 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_PROFILER_HPP
+#define XCSOAR_PROFILER_HPP
+
+#include "OS/Clock.hpp"
+#include "Compiler.h"
+
+#include <atomic>
+#include <vector>
+
+#include <stdint.h>
+
+/**
+ * A light-weight profiler which records timing spans of a few named
+ * threads into per-thread ring buffers.  It is disabled by default,
+ * and then costs only one atomic load per #ProfileScope.
+ *
+ * Each ring buffer has only one writer (the thread which owns it), so
+ * recording does not need any lock.  Readers may lose spans which
+ * are overwritten while they are being copied, but they never see a
+ * corrupt one.
+ */
+namespace Profiler {
+  /**
+   * The maximum number of threads which can be registered.
+   */
+  static constexpr unsigned MAX_THREADS = 8;
+
+  /**
+   * The number of spans in each ring buffer.  Must be a power of
+   * two.
+   */
+  static constexpr unsigned CAPACITY = 4096;
+
+  static_assert((CAPACITY & (CAPACITY - 1)) == 0,
+                "CAPACITY must be a power of two");
+
+  struct Span {
+    /**
+     * The name of this span.  It must be a string literal (or
+     * otherwise live forever).
+     */
+    const char *name;
+
+    /**
+     * The start time [us] according to MonotonicClockUS().
+     */
+    uint64_t start;
+
+    /**
+     * The duration [us].
+     */
+    unsigned duration;
+  };
+
+  extern std::atomic<bool> enabled;
+
+  static inline bool IsEnabled() {
+    return enabled.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Switch recording on or off.  The ring buffers are allocated when
+   * the profiler is enabled for the first time.
+   */
+  void SetEnabled(bool value);
+
+  /**
+   * Register the calling thread, so its spans get recorded.  Spans
+   * of unregistered threads are discarded.  This is cheap if the
+   * thread has already been registered, so it may be called at the
+   * beginning of each iteration of a thread's main loop.
+   *
+   * If a thread with the same name has been registered before, it
+   * is assumed to have exited, and its ring buffer is taken over by
+   * the calling thread.
+   *
+   * @param name the name of the thread; it must be a string literal
+   * @return false if there are too many threads
+   */
+  bool RegisterThread(const char *name);
+
+  /**
+   * Record a span for the calling thread.  Use #ProfileScope instead
+   * of calling this function directly.
+   */
+  void Record(const char *name, uint64_t start, uint64_t end);
+
+  /**
+   * Returns the number of registered threads.
+   */
+  gcc_pure
+  unsigned GetThreadCount();
+
+  /**
+   * Returns the name of the specified thread.
+   */
+  gcc_pure
+  const char *GetThreadName(unsigned thread);
+
+  /**
+   * Copy the spans of the specified thread which have been recorded
+   * since the last call, and append them to the given vector.  Spans
+   * which have been overwritten in the meantime are lost.
+   *
+   * @param cursor the read position of the caller; initialise with
+   * 0 and pass the same variable again to continue
+   */
+  void Read(unsigned thread, unsigned &cursor, std::vector<Span> &dest);
+
+  /**
+   * Copy all spans of the specified thread which are currently in its
+   * ring buffer.
+   */
+  void ReadAll(unsigned thread, std::vector<Span> &dest);
+};
+
+/**
+ * Records the time from construction to destruction as a span of the
+ * current thread.  Does nothing if the profiler is disabled.
+ */
+class ProfileScope {
+  const char *name;
+  uint64_t start;
+
+public:
+  explicit ProfileScope(const char *_name)
+    :name(_name), start(Profiler::IsEnabled() ? MonotonicClockUS() : 0) {}
+
+  ~ProfileScope() {
+    if (start != 0)
+      Profiler::Record(name, start, MonotonicClockUS());
+  }
+
+  ProfileScope(const ProfileScope &) = delete;
+  ProfileScope &operator=(const ProfileScope &) = delete;
+
+  /**
+   * Finish the current span and begin a new one with the given name.
+   * This allows measuring consecutive steps without nesting blocks.
+   */
+  void Next(const char *_name) {
+    if (start != 0) {
+      const uint64_t now = MonotonicClockUS();
+      Profiler::Record(name, start, now);
+      start = now;
+    } else if (Profiler::IsEnabled())
+      start = MonotonicClockUS();
+
+    name = _name;
+  }
+};
+
+#endif
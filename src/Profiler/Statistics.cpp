@@ -0,0 +1,83 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Statistics.hpp"
+
+#include <algorithm>
+
+#include <assert.h>
+#include <string.h>
+
+/**
+ * Returns the nearest-rank percentile of a sorted range.
+ */
+gcc_pure
+static unsigned
+Percentile(const Profiler::Span *begin, unsigned n, unsigned percent)
+{
+  assert(n > 0);
+
+  unsigned rank = (n * percent + 99) / 100;
+  if (rank < 1)
+    rank = 1;
+
+  return begin[rank - 1].duration;
+}
+
+std::vector<Profiler::SpanStatistics>
+Profiler::CalculateStatistics(std::vector<Span> &spans)
+{
+  std::sort(spans.begin(), spans.end(), [](const Span &a, const Span &b){
+      const int cmp = strcmp(a.name, b.name);
+      return cmp < 0 || (cmp == 0 && a.duration < b.duration);
+    });
+
+  std::vector<SpanStatistics> result;
+
+  for (auto i = spans.begin(), end = spans.end(); i != end;) {
+    auto j = std::find_if(i, end, [i](const Span &span){
+        return strcmp(span.name, i->name) != 0;
+      });
+
+    const unsigned n = j - i;
+    result.push_back({i->name, n,
+          Percentile(&*i, n, 50),
+          Percentile(&*i, n, 95),
+          Percentile(&*i, n, 99)});
+    i = j;
+  }
+
+  return result;
+}
+
+std::vector<Profiler::SpanStatistics>
+Profiler::CalculateStatistics()
+{
+  std::vector<Span> spans;
+
+  const unsigned n = GetThreadCount();
+  for (unsigned i = 0; i < n; ++i)
+    ReadAll(i, spans);
+
+  return CalculateStatistics(spans);
+}
@@ -0,0 +1,65 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_PROFILER_STATISTICS_HPP
+#define XCSOAR_PROFILER_STATISTICS_HPP
+
+#include "Profiler.hpp"
+
+#include <vector>
+
+namespace Profiler {
+  /**
+   * Duration percentiles of all spans with the same name.
+   */
+  struct SpanStatistics {
+    const char *name;
+
+    /**
+     * The number of spans.
+     */
+    unsigned count;
+
+    /**
+     * The 50th, 95th and 99th percentile of the durations [us],
+     * using the nearest-rank method.
+     */
+    unsigned p50, p95, p99;
+  };
+
+  /**
+   * Calculate statistics for each distinct span name.
+   *
+   * @param spans the spans; the vector will be reordered
+   * @return the statistics, sorted by name
+   */
+  std::vector<SpanStatistics> CalculateStatistics(std::vector<Span> &spans);
+
+  /**
+   * Calculate statistics over the current contents of all ring
+   * buffers.
+   */
+  std::vector<SpanStatistics> CalculateStatistics();
+};
+
+#endif
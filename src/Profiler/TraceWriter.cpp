@@ -0,0 +1,108 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "TraceWriter.hpp"
+#include "JSON/Writer.hpp"
+
+#include <algorithm>
+
+/**
+ * All spans use this process id.
+ */
+static constexpr int PID = 1;
+
+static void
+WriteTime(TextWriter &writer, uint64_t value)
+{
+  writer.Format("%llu", (unsigned long long)value);
+}
+
+Profiler::TraceWriter::TraceWriter(TextWriter &_writer)
+  :writer(_writer)
+{
+  std::fill_n(cursors, MAX_THREADS, 0u);
+
+  writer.Write("{\"traceEvents\":[");
+}
+
+Profiler::TraceWriter::~TraceWriter()
+{
+  Flush();
+  writer.Write("]}");
+  writer.NewLine();
+}
+
+void
+Profiler::TraceWriter::BeginEvent()
+{
+  if (first)
+    first = false;
+  else
+    writer.Write(',');
+
+  writer.NewLine();
+}
+
+void
+Profiler::TraceWriter::Flush()
+{
+  const unsigned n = GetThreadCount();
+
+  /* thread name metadata, once for each new thread */
+  for (; n_named_threads < n; ++n_named_threads) {
+    BeginEvent();
+
+    JSON::ObjectWriter object(writer);
+    object.WriteElement("name", JSON::WriteString, "thread_name");
+    object.WriteElement("ph", JSON::WriteString, "M");
+    object.WriteElement("pid", JSON::WriteInteger, PID);
+    object.WriteElement("tid", JSON::WriteUnsigned, n_named_threads);
+
+    object.BeginElement("args");
+    {
+      JSON::ObjectWriter args(writer);
+      args.WriteElement("name", JSON::WriteString,
+                        GetThreadName(n_named_threads));
+    }
+    object.EndElement();
+  }
+
+  for (unsigned i = 0; i < n; ++i) {
+    buffer.clear();
+    Read(i, cursors[i], buffer);
+
+    for (const Span &span : buffer) {
+      BeginEvent();
+
+      JSON::ObjectWriter object(writer);
+      object.WriteElement("name", JSON::WriteString, span.name);
+      object.WriteElement("ph", JSON::WriteString, "X");
+      object.WriteElement("pid", JSON::WriteInteger, PID);
+      object.WriteElement("tid", JSON::WriteUnsigned, i);
+      object.WriteElement("ts", WriteTime, span.start);
+      object.WriteElement("dur", JSON::WriteUnsigned, span.duration);
+    }
+  }
+
+  writer.Flush();
+}
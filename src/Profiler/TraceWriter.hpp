@@ -0,0 +1,73 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_PROFILER_TRACE_WRITER_HPP
+#define XCSOAR_PROFILER_TRACE_WRITER_HPP
+
+#include "Profiler.hpp"
+
+#include <vector>
+
+class TextWriter;
+
+namespace Profiler {
+  /**
+   * Writes the recorded spans in the Chrome trace-event JSON format,
+   * which can be loaded into chrome://tracing or Perfetto.  Each call
+   * to Flush() appends the spans which were recorded since the
+   * previous call, so long sessions can be written without losing
+   * spans, as long as Flush() is called often enough.  The file is
+   * complete after the destructor has run.
+   */
+  class TraceWriter {
+    TextWriter &writer;
+
+    /**
+     * The read position in each thread's ring buffer.
+     */
+    unsigned cursors[MAX_THREADS];
+
+    /**
+     * The number of threads whose names have been written.
+     */
+    unsigned n_named_threads = 0;
+
+    bool first = true;
+
+    std::vector<Span> buffer;
+
+  public:
+    explicit TraceWriter(TextWriter &_writer);
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter &) = delete;
+    TraceWriter &operator=(const TraceWriter &) = delete;
+
+    void Flush();
+
+  private:
+    void BeginEvent();
+  };
+};
+
+#endif
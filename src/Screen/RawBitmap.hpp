@@ -158,6 +158,17 @@ public:
 #endif
   }
 
+  /**
+   * Returns a pointer to the specified row, counting from the top.
+   */
+  RawColor *GetRow(unsigned y) {
+#ifndef USE_GDI
+    return GetBuffer() + y * corrected_width;
+#else
+    return GetBuffer() + (height - 1 - y) * corrected_width;
+#endif
+  }
+
   void SetDirty() {
 #ifdef ENABLE_OPENGL
     dirty = true;
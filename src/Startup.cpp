@@ -93,6 +93,8 @@ Copyright_License {
 #include "Units/Units.hpp"
 #include "Formatter/UserGeoPointFormatter.hpp"
 #include "Thread/Debug.hpp"
+#include "Profiler/Profiler.hpp"
+#include "Profiler/Glue.hpp"
 #include "Util/Error.hxx"
 
 #ifdef USE_LUA
@@ -180,6 +182,8 @@ Startup()
 {
   VerboseOperationEnvironment operation;
 
+  Profiler::RegisterThread("MainThread");
+
 #ifdef HAVE_DOWNLOAD_MANAGER
   Net::DownloadManager::Initialise();
 #endif
@@ -335,7 +339,7 @@ Startup()
   LoadConfiguredTopography(*topography, operation);
 
   // Read the waypoint files
-  WaypointGlue::LoadWaypoints(way_points, terrain, operation);
+  WaypointGlue::LoadWaypoints(way_points, terrain, file_cache, operation);
 
   // Read and parse the airfield info file
   WaypointDetails::ReadFileFromProfile(way_points, operation);
@@ -357,7 +361,7 @@ Startup()
 
   // Reads the airspace files
   ReadAirspace(airspace_database, terrain, computer_settings.pressure,
-               operation);
+               file_cache, operation);
 
   {
     const AircraftState aircraft_state =
@@ -513,6 +517,8 @@ Shutdown()
   delete flight_logger;
   flight_logger = nullptr;
 
+  ProfilerGlue::StopTrace();
+
   delete all_monitors;
   all_monitors = nullptr;
 
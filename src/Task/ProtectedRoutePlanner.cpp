@@ -63,10 +63,20 @@ void
 ProtectedRoutePlanner::SolveReach(const AGeoPoint &origin,
                                   const RoutePlannerConfig &config,
                                   const RoughAltitude h_ceiling,
-                                  const bool do_solve)
+                                  const bool do_solve,
+                                  const bool incremental)
 {
   ExclusiveLease lease(*this);
-  lease->SolveReach(origin, config, h_ceiling, do_solve);
+  lease->SolveReach(origin, config, h_ceiling, do_solve, incremental);
+}
+
+bool
+ProtectedRoutePlanner::CanUpdateReach(const AGeoPoint &origin,
+                                      const RoutePlannerConfig &config,
+                                      const RoughAltitude h_ceiling) const
+{
+  Lease lease(*this);
+  return lease->CanUpdateReach(origin, config, h_ceiling);
 }
 
 void
@@ -80,7 +80,13 @@ public:
                         const AGeoPoint &destination) const;
 
   void SolveReach(const AGeoPoint &origin, const RoutePlannerConfig &config,
-                  RoughAltitude h_ceiling, bool do_solve);
+                  RoughAltitude h_ceiling, bool do_solve,
+                  bool incremental=false);
+
+  gcc_pure
+  bool CanUpdateReach(const AGeoPoint &origin,
+                      const RoutePlannerConfig &config,
+                      RoughAltitude h_ceiling) const;
 
   void AcceptInRange(const GeoBounds &bounds,
                      TriangleFanVisitor &visitor) const;
@@ -63,13 +63,27 @@ RoutePlannerGlue::Solve(const AGeoPoint &origin,
 void
 RoutePlannerGlue::SolveReach(const AGeoPoint &origin,
                               const RoutePlannerConfig &config,
-                              const RoughAltitude h_ceiling, const bool do_solve)
+                              const RoughAltitude h_ceiling, const bool do_solve,
+                              const bool incremental)
 {
   if (terrain) {
     RasterTerrain::Lease lease(*terrain);
-    planner.SolveReach(origin, config, h_ceiling, do_solve);
+    planner.SolveReach(origin, config, h_ceiling, do_solve, incremental);
   } else {
-    planner.SolveReach(origin, config, h_ceiling, do_solve);
+    planner.SolveReach(origin, config, h_ceiling, do_solve, incremental);
+  }
+}
+
+bool
+RoutePlannerGlue::CanUpdateReach(const AGeoPoint &origin,
+                                 const RoutePlannerConfig &config,
+                                 const RoughAltitude h_ceiling) const
+{
+  if (terrain) {
+    RasterTerrain::Lease lease(*terrain);
+    return planner.CanUpdateReach(origin, config, h_ceiling);
+  } else {
+    return planner.CanUpdateReach(origin, config, h_ceiling);
   }
 }
 
@@ -59,6 +59,10 @@ public:
     planner.ClearReach();
   }
 
+  void SetParallel(ReachFanParms::ParallelFunction parallel) {
+    planner.SetParallel(parallel);
+  }
+
   void Reset() {
     planner.Reset();
   }
@@ -72,7 +76,17 @@ public:
   }
 
   void SolveReach(const AGeoPoint &origin, const RoutePlannerConfig &config,
-                  RoughAltitude h_ceiling, bool do_solve);
+                  RoughAltitude h_ceiling, bool do_solve,
+                  bool incremental=false);
+
+  gcc_pure
+  bool CanUpdateReach(const AGeoPoint &origin,
+                      const RoutePlannerConfig &config,
+                      RoughAltitude h_ceiling) const;
+
+  unsigned GetReachUpdateCount() const {
+    return planner.GetReachUpdateCount();
+  }
 
   bool FindPositiveArrival(const AGeoPoint &dest, ReachResult &result_r) const;
 
@@ -23,6 +23,8 @@ Copyright_License {
 
 #include "HeightMatrix.hpp"
 #include "RasterMap.hpp"
+#include "ShiftGrid.hpp"
+#include "Thread/Parallel.hpp"
 
 #ifdef ENABLE_OPENGL
 #include "Geo/GeoBounds.hpp"
@@ -57,29 +59,132 @@ HeightMatrix::SetSize(unsigned width, unsigned height,
           (height + quantisation_pixels - 1) / quantisation_pixels);
 }
 
+/**
+ * Scan a rectangle of cells row by row.
+ *
+ * @param cell_to_geo a function returning the #GeoPoint of the given
+ * cell
+ */
+template<typename F>
+static void
+FillRows(const RasterMap &map, short *data, unsigned width,
+         const PixelRect &rect, F &&cell_to_geo, bool interpolate)
+{
+  const unsigned rect_width = rect.right - rect.left;
+
+  short *p = data + rect.top * width + rect.left;
+  for (int y = rect.top; y < rect.bottom; ++y, p += width)
+    map.ScanLine(cell_to_geo(rect.left, y), cell_to_geo(rect.right, y),
+                 p, rect_width, interpolate);
+}
+
+/**
+ * Scan a rectangle of cells column by column.
+ */
+template<typename F>
+static void
+FillColumns(const RasterMap &map, short *data, unsigned width,
+            const PixelRect &rect, F &&cell_to_geo, bool interpolate)
+{
+  const unsigned rect_height = rect.bottom - rect.top;
+
+  AllocatedArray<short> column(rect_height);
+
+  for (int x = rect.left; x < rect.right; ++x) {
+    map.ScanLine(cell_to_geo(x, rect.top), cell_to_geo(x, rect.bottom),
+                 column.begin(), rect_height, interpolate);
+
+    short *p = data + rect.top * width + x;
+    for (unsigned i = 0; i < rect_height; ++i, p += width)
+      *p = column[i];
+  }
+}
+
+/**
+ * Scan a rectangle of cells.  The lines are scanned along the longer
+ * side of the rectangle, because RasterMap::ScanLine() needs at least
+ * two samples to produce useful results.
+ */
+template<typename F>
+static void
+FillRect(const RasterMap &map, short *data, unsigned width,
+         const PixelRect &rect, F &&cell_to_geo, bool interpolate)
+{
+  if (rect.right - rect.left >= rect.bottom - rect.top)
+    FillRows(map, data, width, rect, cell_to_geo, interpolate);
+  else
+    FillColumns(map, data, width, rect, cell_to_geo, interpolate);
+}
+
+/**
+ * Scan all cells row by row.  The rows are split into horizontal
+ * stripes which are scanned in parallel; the result does not depend
+ * on the number of stripes.
+ */
+template<typename F>
+static void
+FillStriped(const RasterMap &map, short *data,
+            unsigned width, unsigned height,
+            F &&cell_to_geo, bool interpolate, unsigned n_stripes)
+{
+  if (n_stripes > height)
+    n_stripes = height;
+
+  RunParallel(n_stripes, [&](unsigned i){
+      PixelRect rect;
+      rect.left = 0;
+      rect.right = width;
+      rect.top = height * i / n_stripes;
+      rect.bottom = height * (i + 1) / n_stripes;
+      FillRows(map, data, width, rect, cell_to_geo, interpolate);
+    });
+}
+
 #ifdef ENABLE_OPENGL
 
+/**
+ * Calculates the #GeoPoint of a cell of a matrix with the given size
+ * covering the given bounds.
+ */
+class CellToGeo {
+  Angle west, north, delta_x, delta_y;
+
+public:
+  CellToGeo(const GeoBounds &bounds, unsigned width, unsigned height)
+    :west(bounds.GetWest()), north(bounds.GetNorth()),
+     delta_x(bounds.GetWidth() / width),
+     delta_y(bounds.GetHeight() / height) {}
+
+  GeoPoint operator()(int x, int y) const {
+    return GeoPoint(west + delta_x * x, north - delta_y * y);
+  }
+};
+
 void
 HeightMatrix::Fill(const RasterMap &map, const GeoBounds &bounds,
-                   unsigned width, unsigned height, bool interpolate)
+                   unsigned width, unsigned height, bool interpolate,
+                   unsigned n_stripes)
 {
   SetSize(width, height);
 
-  const Angle delta_y = bounds.GetHeight() / height;
-  Angle latitude = bounds.GetNorth();
-  for (short *p = data.begin(), *const end = p + width * height;
-       p != end; p += width, latitude -= delta_y) {
-    map.ScanLine(GeoPoint(bounds.GetWest(), latitude),
-                 GeoPoint(bounds.GetEast(), latitude),
-                 p, width, interpolate);
-  }
+  FillStriped(map, data.begin(), width, height,
+              CellToGeo(bounds, width, height), interpolate, n_stripes);
+}
+
+void
+HeightMatrix::Fill(const RasterMap &map, const GeoBounds &bounds,
+                   const PixelRect &rect, bool interpolate)
+{
+  FillRect(map, data.begin(), width, rect,
+           CellToGeo(bounds, width, height), interpolate);
 }
 
 #else
 
 void
 HeightMatrix::Fill(const RasterMap &map, const WindowProjection &projection,
-                   unsigned quantisation_pixels, bool interpolate)
+                   unsigned quantisation_pixels, bool interpolate,
+                   unsigned n_stripes)
 {
   const unsigned screen_width = projection.GetScreenWidth();
   const unsigned screen_height = projection.GetScreenHeight();
@@ -87,13 +192,29 @@ HeightMatrix::Fill(const RasterMap &map, const WindowProjection &projection,
   SetSize((screen_width + quantisation_pixels - 1) / quantisation_pixels,
           (screen_height + quantisation_pixels - 1) / quantisation_pixels);
 
-  short *p = data.begin();
-  for (unsigned y = 0; y < screen_height;
-       y += quantisation_pixels, p += width) {
-    map.ScanLine(projection.ScreenToGeo(0, y),
-                 projection.ScreenToGeo(screen_width, y),
-                 p, width, interpolate);
-  }
+  const int q = quantisation_pixels;
+  FillStriped(map, data.begin(), width, height, [&](int x, int y){
+      return projection.ScreenToGeo(x * q, y * q);
+    }, interpolate, n_stripes);
+}
+
+void
+HeightMatrix::Fill(const RasterMap &map, const WindowProjection &projection,
+                   unsigned quantisation_pixels, RasterPoint offset,
+                   const PixelRect &rect, bool interpolate)
+{
+  const int q = quantisation_pixels;
+
+  FillRect(map, data.begin(), width, rect, [&](int x, int y){
+      return projection.ScreenToGeo(offset.x + x * q, offset.y + y * q);
+    }, interpolate);
 }
 
 #endif
+
+void
+HeightMatrix::Shift(int dx, int dy)
+{
+  ShiftGrid([this](unsigned y){ return data.begin() + y * width; },
+            width, height, dx, dy);
+}
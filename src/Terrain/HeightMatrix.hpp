@@ -25,6 +25,7 @@ Copyright_License {
 #define XCSOAR_TERRAIN_HEIGHT_MATRIX_HPP
 
 #include "Util/AllocatedArray.hpp"
+#include "Screen/Point.hpp"
 #include "Compiler.h"
 
 class RasterMap;
@@ -54,17 +55,49 @@ public:
 #ifdef ENABLE_OPENGL
   /**
    * Copy values from the #RasterMap to the buffer, north-up only.
+   *
+   * @param n_stripes the number of horizontal stripes which are
+   * scanned in parallel
    */
   void Fill(const RasterMap &map, const GeoBounds &bounds,
-            unsigned _width, unsigned _height, bool interpolate);
+            unsigned _width, unsigned _height, bool interpolate,
+            unsigned n_stripes=1);
+
+  /**
+   * Refill only the given rectangle of cells.  The matrix size must
+   * not have changed since the last Fill() call, and #bounds
+   * describes the area covered by the whole matrix.
+   */
+  void Fill(const RasterMap &map, const GeoBounds &bounds,
+            const PixelRect &rect, bool interpolate);
 #else
   /**
    * @param interpolate true enables interpolation of sub-pixel values
+   * @param n_stripes the number of horizontal stripes which are
+   * scanned in parallel
    */
   void Fill(const RasterMap &map, const WindowProjection &map_projection,
-            unsigned quantisation_pixels, bool interpolate);
+            unsigned quantisation_pixels, bool interpolate,
+            unsigned n_stripes=1);
+
+  /**
+   * Refill only the given rectangle of cells.  The matrix size must
+   * not have changed since the last Fill() call.  Cell (x,y)
+   * corresponds with the screen pixel (offset.x + x *
+   * quantisation_pixels, offset.y + y * quantisation_pixels).
+   */
+  void Fill(const RasterMap &map, const WindowProjection &map_projection,
+            unsigned quantisation_pixels, RasterPoint offset,
+            const PixelRect &rect, bool interpolate);
 #endif
 
+  /**
+   * Move all values by the given number of cells, i.e. the new cell
+   * (x,y) is the old cell (x-dx,y-dy).  The exposed cells must be
+   * refilled by the caller.
+   */
+  void Shift(int dx, int dy);
+
   unsigned GetWidth() const {
     return width;
   }
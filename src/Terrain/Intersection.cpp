@@ -58,7 +58,12 @@ RasterTileCache::FirstIntersection(const int x0, const int y0,
     // origin is outside overall bounds
     return false;
 
-  const short h_origin2 = GetFieldDirect(x0, y0).first;
+  LookupCounter counter(*this);
+
+  const auto field_origin = GetFieldDirect(x0, y0);
+  counter.Add(!field_origin.second);
+
+  const short h_origin2 = field_origin.first;
   if (RasterBuffer::IsInvalid(h_origin2)) {
     _location = location;
     _h = h_origin;
@@ -127,6 +132,7 @@ RasterTileCache::FirstIntersection(const int x0, const int y0,
         break; // outside bounds
 
       const auto field_direct = GetFieldDirect(location.x, location.y);
+      counter.Add(!field_direct.second);
       if (RasterBuffer::IsInvalid(field_direct.first))
         break;
 
@@ -274,6 +280,8 @@ RasterTileCache::Intersection(const int x0, const int y0,
     // origin is outside overall bounds
     return {-1, -1};
 
+  LookupCounter counter(*this);
+
   // line algorithm parameters
   const int dx = abs(x1-x0);
   const int dy = abs(y1-y0);
@@ -315,6 +323,7 @@ RasterTileCache::Intersection(const int x0, const int y0,
         break;
 
       const auto field_direct = GetFieldDirect(location.x, location.y);
+      counter.Add(!field_direct.second);
       if (RasterBuffer::IsInvalid(field_direct.first))
         break;
 
@@ -24,10 +24,15 @@ Copyright_License {
 #include "Loader.hpp"
 #include "RasterTileCache.hpp"
 #include "RasterProjection.hpp"
+#include "TileStore.hpp"
 #include "ZzipStream.hpp"
 #include "WorldFile.hpp"
 #include "Operation/Operation.hpp"
 #include "OS/ConvertPathName.hpp"
+#include "Thread/Parallel.hpp"
+#include "Util/AllocatedArray.hpp"
+
+#include <algorithm>
 
 extern "C" {
 #include "jasper/jp2/jp2_cod.h"
@@ -35,6 +40,23 @@ extern "C" {
 #include "jasper/jpc/jpc_t1cod.h"
 }
 
+inline bool
+TerrainLoader::IsTileSelected(unsigned index) const
+{
+  return raster_tile_cache.tiles.GetLinear(index).IsRequested() &&
+    index % n_workers == worker;
+}
+
+inline unsigned
+TerrainLoader::CountRequestedTiles() const
+{
+  const auto &request_tiles = raster_tile_cache.request_tiles;
+  return std::count_if(request_tiles.begin(), request_tiles.end(),
+                       [this](unsigned i){
+                         return raster_tile_cache.tiles.GetLinear(i).IsRequested();
+                       });
+}
+
 long
 TerrainLoader::SkipMarkerSegment(long file_offset) const
 {
@@ -54,8 +76,7 @@ TerrainLoader::SkipMarkerSegment(long file_offset) const
     return 0;
 
   long skip_to = segment->file_offset;
-  while (segment->IsTileSegment() &&
-         !raster_tile_cache.tiles.GetLinear(segment->tile).IsRequested()) {
+  while (segment->IsTileSegment() && !IsTileSelected(segment->tile)) {
     ++segment;
     if (segment >= raster_tile_cache.segments.end())
       /* last segment is hidden; shouldn't happen either, because we
@@ -161,9 +182,13 @@ TerrainLoader::SetSize(unsigned _width, unsigned _height,
                        unsigned _tile_width, unsigned _tile_height,
                        unsigned tile_columns, unsigned tile_rows)
 {
-  if (scan_overview)
+  if (scan_overview) {
     raster_tile_cache.SetSize(_width, _height, _tile_width, _tile_height,
                               tile_columns, tile_rows);
+
+    if (tile_store != nullptr)
+      tile_store->SetSize(tile_columns, tile_rows);
+  }
 }
 
 void
@@ -172,10 +197,13 @@ TerrainLoader::PutTileData(unsigned index,
                            unsigned end_x, unsigned end_y,
                            const struct jas_matrix &m)
 {
-  if (scan_overview)
+  if (scan_overview) {
     raster_tile_cache.PutOverviewTile(index, start_x, start_y,
                                       end_x, end_y, m);
-  else {
+
+    if (tile_store != nullptr)
+      tile_store->PutTile(index, start_x, start_y, m);
+  } else {
     const ScopeExclusiveLock lock(mutex);
     raster_tile_cache.PutTileData(index, m);
   }
@@ -223,8 +251,6 @@ LoadJPG2000(jas_stream_t *in, void *loader)
   opts.maxlyrs = JPC_MAXLYRS;
   opts.maxpkts = -1;
 
-  jpc_initluts();
-
   const auto dec = jpc_dec_create(&opts, in);
   if (dec == nullptr)
     return false;
@@ -273,6 +299,8 @@ TerrainLoader::LoadOverview(struct zzip_dir *dir,
 
   raster_tile_cache.Reset();
 
+  jpc_initluts();
+
   bool success = LoadJPG2000(dir, path);
 
   /* if we loaded the JPG2000 file successfully, but no bounds were
@@ -293,52 +321,81 @@ bool
 LoadTerrainOverview(struct zzip_dir *dir,
                     const char *path, const char *world_file,
                     RasterTileCache &raster_tile_cache,
-                    OperationEnvironment &env)
+                    OperationEnvironment &env,
+                    TileStoreWriter *tile_store)
 {
   /* fake a mutex - we don't need it for LoadTerrainOverview() */
   SharedMutex mutex;
 
-  TerrainLoader loader(mutex, raster_tile_cache, true, env);
+  TerrainLoader loader(mutex, raster_tile_cache, true, env, tile_store);
   return loader.LoadOverview(dir, path, world_file);
 }
 
 inline bool
-TerrainLoader::UpdateTiles(struct zzip_dir *dir, const char *path,
-                           int x, int y, unsigned radius)
+TerrainLoader::UpdateTiles(ConstBuffer<struct zzip_dir *> dirs,
+                           const char *path,
+                           int x, int y, unsigned radius,
+                           const TilePrefetch *prefetch)
 {
   assert(!scan_overview);
+  assert(!dirs.IsEmpty());
 
-  if (!raster_tile_cache.PollTiles(x, y, radius))
+  if (!raster_tile_cache.PollTiles(x, y, radius, prefetch))
     /* nothing to do */
     return true;
 
-  bool success = LoadJPG2000(dir, path);
+  /* initialise jasper's global lookup tables before any decoder
+     thread runs */
+  jpc_initluts();
+
+  /* each thread scans the whole code stream, but decodes only its
+     share of the requested tiles; more threads than tiles would only
+     waste time parsing the headers */
+  const unsigned n = std::min<unsigned>(dirs.size, CountRequestedTiles());
+
+  bool success;
+  if (n <= 1) {
+    success = LoadJPG2000(dirs[0], path);
+  } else {
+    AllocatedArray<bool> results(n);
+    RunParallel(n, [this, dirs, path, n, &results](unsigned i){
+        TerrainLoader loader(mutex, raster_tile_cache, false, env,
+                             nullptr, i, n);
+        results[i] = loader.LoadJPG2000(dirs[i], path);
+      });
+
+    success = std::all_of(results.begin(), results.end(),
+                          [](bool b){ return b; });
+  }
+
+  /* this bumps the Serial only once for the whole batch */
   raster_tile_cache.FinishTileUpdate();
   return success;
 }
 
 bool
-UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
+UpdateTerrainTiles(ConstBuffer<struct zzip_dir *> dirs, const char *path,
                    RasterTileCache &raster_tile_cache, SharedMutex &mutex,
-                   int x, int y, unsigned radius)
+                   int x, int y, unsigned radius,
+                   const TilePrefetch *prefetch)
 {
   if (!raster_tile_cache.IsValid())
     return false;
 
   NullOperationEnvironment env;
   TerrainLoader loader(mutex, raster_tile_cache, false, env);
-  return loader.UpdateTiles(dir, path, x, y, radius);
+  return loader.UpdateTiles(dirs, path, x, y, radius, prefetch);
 }
 
 bool
-UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
+UpdateTerrainTiles(ConstBuffer<struct zzip_dir *> dirs, const char *path,
                    RasterTileCache &raster_tile_cache, SharedMutex &mutex,
                    const RasterProjection &projection,
                    const GeoPoint &location, fixed radius)
 {
   const auto raster_location = projection.ProjectCoarse(location);
 
-  return UpdateTerrainTiles(dir, path, raster_tile_cache, mutex,
+  return UpdateTerrainTiles(dirs, path, raster_tile_cache, mutex,
                             raster_location.x, raster_location.y,
                             projection.DistancePixelsCoarse(radius));
 }
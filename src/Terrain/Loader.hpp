@@ -26,6 +26,7 @@ Copyright_License {
 
 #include "Thread/SharedMutex.hpp"
 #include "Math/fixed.hpp"
+#include "Util/ConstBuffer.hxx"
 
 #include <tchar.h>
 
@@ -33,6 +34,8 @@ struct zzip_dir;
 struct GeoPoint;
 class RasterTileCache;
 class RasterProjection;
+struct TilePrefetch;
+class TileStoreWriter;
 class OperationEnvironment;
 
 class TerrainLoader {
@@ -44,6 +47,19 @@ class TerrainLoader {
 
   OperationEnvironment &env;
 
+  /**
+   * If not nullptr, then all tiles decoded while scanning the
+   * overview are also written to this tile store.
+   */
+  TileStoreWriter *const tile_store;
+
+  /**
+   * When tiles are decoded by several threads in parallel, each
+   * #TerrainLoader instance handles only the requested tiles whose
+   * index modulo #n_workers equals #worker.
+   */
+  const unsigned worker, n_workers;
+
   /**
    * The number of remaining segments after the current one.
    */
@@ -52,14 +68,27 @@ class TerrainLoader {
 public:
   TerrainLoader(SharedMutex &_mutex, RasterTileCache &_rtc,
                 bool _scan_overview,
-                OperationEnvironment &_env)
+                OperationEnvironment &_env,
+                TileStoreWriter *_tile_store=nullptr,
+                unsigned _worker=0, unsigned _n_workers=1)
     :mutex(_mutex), raster_tile_cache(_rtc),
-     scan_overview(_scan_overview), env(_env) {}
+     scan_overview(_scan_overview), env(_env),
+     tile_store(_tile_store),
+     worker(_worker), n_workers(_n_workers) {}
 
   bool LoadOverview(struct zzip_dir *dir,
                     const char *path, const char *world_file);
-  bool UpdateTiles(struct zzip_dir *dir, const char *path,
-                   int x, int y, unsigned radius);
+
+  /**
+   * @param dirs one handle on the map file for each decoder thread
+   * (zzip handles must not be shared between threads); the number of
+   * handles determines the maximum number of threads
+   * @param prefetch an optional predicted flight path, see
+   * RasterTileCache::PollTiles()
+   */
+  bool UpdateTiles(ConstBuffer<struct zzip_dir *> dirs, const char *path,
+                   int x, int y, unsigned radius,
+                   const TilePrefetch *prefetch=nullptr);
 
   /* callback methods for libjasper (via jas_rtc.cpp) */
 
@@ -80,52 +109,87 @@ public:
                    const struct jas_matrix &m);
 
 private:
+  gcc_pure
+  bool IsTileSelected(unsigned index) const;
+
+  gcc_pure
+  unsigned CountRequestedTiles() const;
+
   bool LoadJPG2000(struct zzip_dir *dir, const char *path);
   void ParseBounds(const char *data);
 };
 
+/**
+ * Scan the whole JPEG2000 file and load the overview.
+ *
+ * @param tile_store if not nullptr, then all decoded tiles are
+ * written to this tile store
+ */
 bool
 LoadTerrainOverview(struct zzip_dir *dir,
                     const char *path, const char *world_file,
                     RasterTileCache &raster_tile_cache,
-                    OperationEnvironment &env);
+                    OperationEnvironment &env,
+                    TileStoreWriter *tile_store=nullptr);
 
 static inline bool
 LoadTerrainOverview(struct zzip_dir *dir,
                     RasterTileCache &tile_cache,
-                    OperationEnvironment &env)
+                    OperationEnvironment &env,
+                    TileStoreWriter *tile_store=nullptr)
 {
   return LoadTerrainOverview(dir, "terrain.jp2", "terrain.j2w",
-                             tile_cache, env);
+                             tile_cache, env, tile_store);
 }
 
+/**
+ * Load the tiles around the specified location.
+ *
+ * @param dirs one handle on the map file for each decoder thread; the
+ * requested tiles are distributed among up to dirs.size threads
+ * @param prefetch an optional predicted flight path, see
+ * RasterTileCache::PollTiles()
+ */
 bool
-UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
+UpdateTerrainTiles(ConstBuffer<struct zzip_dir *> dirs, const char *path,
                    RasterTileCache &raster_tile_cache, SharedMutex &mutex,
-                   int x, int y, unsigned radius);
+                   int x, int y, unsigned radius,
+                   const TilePrefetch *prefetch=nullptr);
 
 static inline bool
 UpdateTerrainTiles(struct zzip_dir *dir,
                    RasterTileCache &tile_cache, SharedMutex &mutex,
                    int x, int y, unsigned radius)
 {
-  return UpdateTerrainTiles(dir, "terrain.jp2", tile_cache, mutex,
+  return UpdateTerrainTiles(ConstBuffer<struct zzip_dir *>(&dir, 1),
+                            "terrain.jp2", tile_cache, mutex,
                             x, y, radius);
 }
 
 bool
-UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
+UpdateTerrainTiles(ConstBuffer<struct zzip_dir *> dirs, const char *path,
                    RasterTileCache &raster_tile_cache, SharedMutex &mutex,
                    const RasterProjection &projection,
                    const GeoPoint &location, fixed radius);
 
+static inline bool
+UpdateTerrainTiles(ConstBuffer<struct zzip_dir *> dirs,
+                   RasterTileCache &tile_cache, SharedMutex &mutex,
+                   const RasterProjection &projection,
+                   const GeoPoint &location, fixed radius)
+{
+  return UpdateTerrainTiles(dirs, "terrain.jp2", tile_cache, mutex,
+                            projection, location, radius);
+}
+
 static inline bool
 UpdateTerrainTiles(struct zzip_dir *dir,
                    RasterTileCache &tile_cache, SharedMutex &mutex,
                    const RasterProjection &projection,
                    const GeoPoint &location, fixed radius)
 {
-  return UpdateTerrainTiles(dir, "terrain.jp2", tile_cache, mutex,
+  return UpdateTerrainTiles(ConstBuffer<struct zzip_dir *>(&dir, 1),
+                            tile_cache, mutex,
                             projection, location, radius);
 }
 
@@ -0,0 +1,91 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_PREFETCH_HPP
+#define XCSOAR_TERRAIN_PREFETCH_HPP
+
+#include "Geo/GeoPoint.hpp"
+#include "Math/fixed.hpp"
+
+/**
+ * The predicted flight path.  Terrain tiles along this path are
+ * loaded with priority, so final glide, reach and route calculations
+ * ahead of the aircraft do not have to fall back to the
+ * low-resolution overview until the map catches up.
+ */
+struct TerrainPrefetch {
+  /**
+   * The current location of the aircraft.  If this is invalid, then
+   * prefetching is disabled.
+   */
+  GeoPoint location;
+
+  /**
+   * The predicted location if the aircraft keeps its current track
+   * and ground speed.  Invalid if the aircraft is not moving.
+   */
+  GeoPoint track_destination;
+
+  /**
+   * A point along the current task leg.  Invalid if there is no
+   * active task.
+   */
+  GeoPoint leg_destination;
+
+  /**
+   * Tiles within this distance [m] of the path are loaded.
+   */
+  fixed radius;
+
+  static TerrainPrefetch Invalid() {
+    return TerrainPrefetch{GeoPoint::Invalid(), GeoPoint::Invalid(),
+        GeoPoint::Invalid(), fixed(0)};
+  }
+
+  bool IsValid() const {
+    return location.IsValid();
+  }
+
+  /**
+   * Is the path close enough to the other one that reloading tiles
+   * would not make a difference?
+   */
+  gcc_pure
+  bool IsClose(const TerrainPrefetch &other, fixed tolerance) const {
+    return IsClose(location, other.location, tolerance) &&
+      IsClose(track_destination, other.track_destination, tolerance) &&
+      IsClose(leg_destination, other.leg_destination, tolerance);
+  }
+
+private:
+  gcc_pure
+  static bool IsClose(const GeoPoint &a, const GeoPoint &b,
+                      fixed tolerance) {
+    if (!a.IsValid() || !b.IsValid())
+      return a.IsValid() == b.IsValid();
+
+    return a.DistanceS(b) < tolerance;
+  }
+};
+
+#endif
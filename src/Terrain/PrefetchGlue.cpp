@@ -0,0 +1,61 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+ */
+
+
+#include "PrefetchGlue.hpp"
+#include "NMEA/Info.hpp"
+#include "NMEA/Derived.hpp"
+#include "Geo/GeoVector.hpp"
+
+#include <algorithm>
+
+TerrainPrefetch
+GetTerrainPrefetch(const NMEAInfo &basic, const DerivedInfo &calculated)
+{
+  if (!basic.location_available)
+    return TerrainPrefetch::Invalid();
+
+  /* look 5 minutes ahead, but not farther than 30 km */
+  static constexpr fixed LOOKAHEAD_TIME(300);
+  static constexpr fixed MAX_DISTANCE(30000);
+
+  TerrainPrefetch prefetch;
+  prefetch.location = basic.location;
+  prefetch.radius = fixed(3000);
+
+  prefetch.track_destination = basic.track_available &&
+    basic.MovementDetected()
+    ? GeoVector(std::min(fixed(basic.ground_speed) * LOOKAHEAD_TIME,
+                         MAX_DISTANCE),
+                basic.track).EndPoint(basic.location)
+    : GeoPoint::Invalid();
+
+  const GeoVector &leg =
+    calculated.task_stats.current_leg.vector_remaining;
+  prefetch.leg_destination = calculated.task_stats.task_valid &&
+    leg.IsValid()
+    ? GeoVector(std::min(leg.distance, MAX_DISTANCE),
+                leg.bearing).EndPoint(basic.location)
+    : GeoPoint::Invalid();
+
+  return prefetch;
+}
@@ -33,7 +33,10 @@ RasterBuffer::Resize(unsigned _width, unsigned _height)
 {
   assert(_width > 0 && _height > 0);
 
-  data.GrowDiscard(_width, _height);
+  storage.GrowDiscard(_width * _height);
+  data = storage.begin();
+  width = _width;
+  height = _height;
 }
 
 short
@@ -251,5 +254,5 @@ RasterBuffer::ScanLineChecked(unsigned ax, unsigned ay,
 short
 RasterBuffer::GetMaximum() const
 {
-  return IsDefined() ? *std::max_element(data.begin(), data.end()) : 0;
+  return IsDefined() ? *std::max_element(data, data + width * height) : 0;
 }
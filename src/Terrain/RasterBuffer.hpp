@@ -24,11 +24,14 @@ Copyright_License {
 #ifndef XCSOAR_RASTER_BUFFER_HPP
 #define XCSOAR_RASTER_BUFFER_HPP
 
-#include "Util/AllocatedGrid.hpp"
+#include "Util/AllocatedArray.hpp"
 #include "Compiler.h"
 
 #include <cstddef>
 
+#include <assert.h>
+#include <stdint.h>
+
 class RasterBuffer {
 public:
   /** invalid value for terrain */
@@ -66,26 +69,47 @@ public:
   }
 
 private:
-  AllocatedGrid<short> data;
+  /**
+   * The memory owned by this object.  It is empty if this buffer
+   * refers to foreign memory, see SetExternal().
+   */
+  AllocatedArray<short> storage;
+
+  /**
+   * Pointer to the first pixel; either points into #storage or to
+   * foreign memory.
+   */
+  const short *data = nullptr;
+
+  unsigned width = 0, height = 0;
 
 public:
   RasterBuffer() = default;
   RasterBuffer(unsigned _width, unsigned _height)
-    :data(_width, _height) {}
+    :storage(_width * _height), data(storage.begin()),
+     width(_width), height(_height) {}
 
   RasterBuffer(const RasterBuffer &) = delete;
   RasterBuffer &operator=(const RasterBuffer &) = delete;
 
   bool IsDefined() const {
-    return data.IsDefined();
+    return data != nullptr;
+  }
+
+  /**
+   * Does this buffer refer to memory it does not own (e.g. a file
+   * mapping)?  Such a buffer is read-only.
+   */
+  bool IsExternal() const {
+    return data != nullptr && storage.empty();
   }
 
   unsigned GetWidth() const {
-    return data.GetWidth();
+    return width;
   }
 
   unsigned GetHeight() const {
-    return data.GetHeight();
+    return height;
   }
 
   unsigned GetFineWidth() const {
@@ -97,23 +121,46 @@ public:
   }
 
   short *GetData() {
-    return data.begin();
+    assert(!IsExternal());
+
+    return storage.begin();
   }
 
   const short *GetData() const {
-    return data.begin();
+    return data;
   }
 
   const short *GetDataAt(unsigned x, unsigned y) const {
-    return data.GetPointerAt(x, y);
+    assert(x < width);
+    assert(y < height);
+
+    return data + y * width + x;
   }
 
   void Reset() {
-    data.Reset();
+    storage.ResizeDiscard(0);
+    data = nullptr;
+    width = height = 0;
   }
 
   void Resize(unsigned _width, unsigned _height);
 
+  /**
+   * Let this buffer refer to the specified (read-only) memory
+   * instead of allocating its own.  The caller is responsible for
+   * keeping the memory valid until Reset() is called or the object
+   * is destructed.
+   */
+  void SetExternal(const short *_data, unsigned _width, unsigned _height) {
+    assert(_data != nullptr);
+    assert(_width > 0 && _height > 0);
+
+    storage.ResizeDiscard(0);
+    data = _data;
+    width = _width;
+    height = _height;
+  }
+
   gcc_pure
   short GetInterpolated(unsigned lx, unsigned ly,
                         unsigned ix, unsigned iy) const;
@@ -23,7 +23,11 @@ Copyright_License {
 
 #include "Terrain/RasterRenderer.hpp"
 #include "Terrain/RasterMap.hpp"
+#include "Terrain/SlopeShading.hpp"
+#include "Terrain/ShiftGrid.hpp"
+#include "Thread/Parallel.hpp"
 #include "Math/FastMath.hpp"
+#include "Math/Util.hpp"
 #include "Util/Clamp.hpp"
 #include "Screen/Ramp.hpp"
 #include "Screen/Layout.hpp"
@@ -35,6 +39,15 @@ Copyright_License {
 
 #include <assert.h>
 #include <stdint.h>
+#include <stdlib.h>
+
+#include <algorithm>
+
+/**
+ * The default number of stripes is the number of CPU cores, but no
+ * more than this; more threads would only add overhead.
+ */
+static constexpr unsigned MAX_STRIPES = 4;
 
 /**
  * Interpolate between x and y with i/128, i.e. i/(1 << 7).
@@ -92,6 +105,7 @@ ContourInterval(const int h, const unsigned contour_height_scale)
 }
 
 RasterRenderer::RasterRenderer()
+  :n_stripes(std::min(GetCPUCount(), MAX_STRIPES))
 {
   // scale quantisation_pixels so resolution is not too high on old hardware
   // with large displays
@@ -104,7 +118,6 @@ RasterRenderer::~RasterRenderer()
 {
   delete[] color_table;
   delete image;
-  delete[] contour_column_base;
 }
 
 #ifdef ENABLE_OPENGL
@@ -140,9 +153,212 @@ RasterRenderer::BindAndGetTexture() const
 
 #endif
 
+/**
+ * Determine the cells which were exposed by HeightMatrix::Shift().
+ *
+ * @return the number of rectangles stored in #rects
+ */
+static unsigned
+GetExposedCells(unsigned width, unsigned height, int dx, int dy,
+                PixelRect rects[2])
+{
+  unsigned n = 0;
+
+  if (dy != 0) {
+    PixelRect &rc = rects[n++];
+    rc.left = 0;
+    rc.right = width;
+    rc.top = dy > 0 ? 0 : height + dy;
+    rc.bottom = dy > 0 ? dy : height;
+  }
+
+  if (dx != 0) {
+    /* the rows exposed by "dy" have already been covered above */
+    PixelRect &rc = rects[n++];
+    rc.left = dx > 0 ? 0 : width + dx;
+    rc.right = dx > 0 ? dx : width;
+    rc.top = dy > 0 ? dy : 0;
+    rc.bottom = dy < 0 ? height + dy : height;
+  }
+
+  return n;
+}
+
+/**
+ * Can the #HeightMatrix be moved by the given number of cells, or is
+ * a full scan cheaper (or necessary)?
+ */
+gcc_const
+static bool
+IsShiftable(unsigned width, unsigned height, int dx, int dy)
+{
+  /* the limits guarantee that each exposed rectangle is at least two
+     cells long, see RasterMap::ScanLine() */
+  return width >= 4 && height >= 4 &&
+    unsigned(abs(dx)) <= width / 2 && unsigned(abs(dy)) <= height / 2;
+}
+
+#ifdef ENABLE_OPENGL
+
+bool
+RasterRenderer::ScanMapIncremental(const RasterMap &map,
+                                   const WindowProjection &projection)
+{
+  const unsigned width = projection.GetScreenWidth() / quantisation_pixels;
+  const unsigned height = projection.GetScreenHeight() / quantisation_pixels;
+
+  if (!bounds.IsValid() || quantisation_pixels != last_quantisation_pixels ||
+      width != height_matrix.GetWidth() ||
+      height != height_matrix.GetHeight())
+    return false;
+
+  const GeoBounds new_bounds =
+    projection.GetScreenBounds().Scale(fixed(1.5));
+
+  const Angle delta_x = bounds.GetWidth() / width;
+  const Angle delta_y = bounds.GetHeight() / height;
+
+  /* zooming and rotating change the size of the bounds */
+  if ((new_bounds.GetWidth() - bounds.GetWidth()).Absolute() > delta_x ||
+      (new_bounds.GetHeight() - bounds.GetHeight()).Absolute() > delta_y)
+    return false;
+
+  /* the number of cells the view has moved east/south */
+  const int east = iround((new_bounds.GetWest() - bounds.GetWest())
+                          / delta_x);
+  const int south = iround((bounds.GetNorth() - new_bounds.GetNorth())
+                           / delta_y);
+  if (!IsShiftable(width, height, east, south))
+    return false;
+
+  /* keep the old grid, only move it by whole cells; the bounds are
+     large enough to cover the screen anyway */
+  bounds = GeoBounds(GeoPoint(bounds.GetWest() + delta_x * east,
+                              bounds.GetNorth() - delta_y * south),
+                     GeoPoint(bounds.GetEast() + delta_x * east,
+                              bounds.GetSouth() - delta_y * south));
+
+  ShiftHeightMatrix(map, -east, -south);
+  return true;
+}
+
+void
+RasterRenderer::ShiftHeightMatrix(const RasterMap &map, int dx, int dy)
+{
+  if (dx == 0 && dy == 0)
+    return;
+
+  height_matrix.Shift(dx, dy);
+
+  PixelRect rects[2];
+  const unsigned n = GetExposedCells(height_matrix.GetWidth(),
+                                     height_matrix.GetHeight(),
+                                     dx, dy, rects);
+  for (unsigned i = 0; i < n; ++i)
+    height_matrix.Fill(map, bounds, rects[i], true);
+
+  if (pending_shift.x != 0 || pending_shift.y != 0)
+    /* the image wasn't updated after the previous shift; too
+       complicated to keep track of, regenerate it completely */
+    image_invalid = true;
+
+  pending_shift.x += dx;
+  pending_shift.y += dy;
+}
+
+#else
+
+/**
+ * Divide and round to the nearest integer, with correct results for
+ * negative dividends.
+ */
+gcc_const
+static int
+RoundingDivide(int a, int b)
+{
+  assert(b > 0);
+
+  return (a >= 0 ? a + b / 2 : a - b / 2) / b;
+}
+
+bool
+RasterRenderer::ScanMapIncremental(const RasterMap &map,
+                                   const WindowProjection &projection)
+{
+  if (!anchor.IsValid() ||
+      projection.GetScreenWidth() != last_screen_width ||
+      projection.GetScreenHeight() != last_screen_height ||
+      projection.GetScale() != last_scale ||
+      projection.GetScreenAngle() != last_screen_angle)
+    return false;
+
+  const int q = quantisation_pixels;
+
+  /* locate the anchor cell in the new projection, and round its
+     position to whole cells */
+  const RasterPoint a = projection.GeoToScreen(anchor);
+  const RasterPoint cell(RoundingDivide(a.x, q), RoundingDivide(a.y, q));
+
+  const unsigned width = height_matrix.GetWidth();
+  const unsigned height = height_matrix.GetHeight();
+  const int dx = cell.x - anchor_cell.x, dy = cell.y - anchor_cell.y;
+  if (!IsShiftable(width, height, dx, dy) ||
+      /* re-anchor after panning far, because the projection is not
+         quite linear */
+      unsigned(abs(cell.x)) > width || unsigned(abs(cell.y)) > height)
+    return false;
+
+  anchor_cell = cell;
+  grid_offset.x = a.x - cell.x * q;
+  grid_offset.y = a.y - cell.y * q;
+
+  ShiftHeightMatrix(map, projection, dx, dy);
+  return true;
+}
+
+void
+RasterRenderer::ShiftHeightMatrix(const RasterMap &map,
+                                  const WindowProjection &projection,
+                                  int dx, int dy)
+{
+  if (dx == 0 && dy == 0)
+    return;
+
+  height_matrix.Shift(dx, dy);
+
+  PixelRect rects[2];
+  const unsigned n = GetExposedCells(height_matrix.GetWidth(),
+                                     height_matrix.GetHeight(),
+                                     dx, dy, rects);
+  for (unsigned i = 0; i < n; ++i)
+    height_matrix.Fill(map, projection, quantisation_pixels, grid_offset,
+                       rects[i], true);
+
+  if (pending_shift.x != 0 || pending_shift.y != 0)
+    /* the image wasn't updated after the previous shift; too
+       complicated to keep track of, regenerate it completely */
+    image_invalid = true;
+
+  pending_shift.x += dx;
+  pending_shift.y += dy;
+}
+
+#endif
+
 void
 RasterRenderer::ScanMap(const RasterMap &map, const WindowProjection &projection)
 {
+  if (&map != last_map) {
+    Invalidate();
+    last_map = &map;
+  } else if (ScanMapIncremental(map, projection))
+    /* the resolution calculated below depends only on the scale; keep
+       the old one, so the reused parts of the image stay consistent
+       with the new ones */
+    return;
+
+  image_invalid = true;
+
   // Coordinates of the MapWindow center
   unsigned x = projection.GetScreenWidth() / 2;
   unsigned y = projection.GetScreenHeight() / 2;
@@ -182,12 +398,22 @@ RasterRenderer::ScanMap(const RasterMap &map, const WindowProjection &projection
   height_matrix.Fill(map, bounds,
                      projection.GetScreenWidth() / quantisation_pixels,
                      projection.GetScreenHeight() / quantisation_pixels,
-                     true);
+                     true, n_stripes);
 
   last_quantisation_pixels = quantisation_pixels;
 #else
-  height_matrix.Fill(map, projection, quantisation_pixels, true);
+  height_matrix.Fill(map, projection, quantisation_pixels, true, n_stripes);
+
+  anchor = projection.ScreenToGeo(0, 0);
+  anchor_cell.x = anchor_cell.y = 0;
+  grid_offset.x = grid_offset.y = 0;
+  last_scale = projection.GetScale();
+  last_screen_angle = projection.GetScreenAngle();
+  last_screen_width = projection.GetScreenWidth();
+  last_screen_height = projection.GetScreenHeight();
 #endif
+
+  pending_shift.x = pending_shift.y = 0;
 }
 
 void
@@ -203,44 +429,136 @@ RasterRenderer::GenerateImage(bool do_shading,
     delete image;
     image = new RawBitmap(height_matrix.GetWidth(), height_matrix.GetHeight());
 
-    delete[] contour_column_base;
-    contour_column_base = new unsigned char[height_matrix.GetWidth()];
+    image_invalid = true;
   }
 
+  contour_column_base.GrowDiscard(height_matrix.GetWidth() * n_stripes);
+  shade_row.GrowDiscard(height_matrix.GetWidth() * n_stripes);
+
   if (quantisation_effective == 0) {
     do_shading = false;
     do_contour = false;
   }
 
+  const ImageParameters parameters{
+    do_shading, height_scale, contrast, brightness, sunazimuth, do_contour,
+  };
+  if (parameters != last_image_parameters) {
+    last_image_parameters = parameters;
+    image_invalid = true;
+  }
+
   const unsigned contour_height_scale = do_contour? height_scale * 2 : 16;
 
-  ContourStart(contour_height_scale);
+  const unsigned width = height_matrix.GetWidth();
+  const unsigned height = height_matrix.GetHeight();
+
+  if (image_invalid) {
+    const unsigned n = std::min(n_stripes, height);
+
+    RunParallel(n, [&](unsigned i){
+        PixelRect rect;
+        rect.left = 0;
+        rect.right = width;
+        rect.top = height * i / n;
+        rect.bottom = height * (i + 1) / n;
+        GenerateImage(rect, i, do_shading, height_scale,
+                      contrast, brightness, sunazimuth,
+                      contour_height_scale);
+      });
+  } else if (pending_shift.x != 0 || pending_shift.y != 0) {
+    const int dx = pending_shift.x, dy = pending_shift.y;
+    ShiftGrid([this](unsigned y){ return image->GetRow(y); },
+              width, height, dx, dy);
+
+    /* regenerate the exposed pixels, plus the ones whose slope or
+       contour calculation depends on exposed pixels, plus the ones
+       near the opposite edge, which were calculated with different
+       neighbours */
+    const int border = do_shading ? quantisation_effective : 0;
+    const int margin = border + 1;
+
+    PixelRect rects[4];
+    unsigned n = 0;
+
+    if (dx != 0) {
+      PixelRect &exposed = rects[n++];
+      exposed.top = 0;
+      exposed.bottom = height;
+      exposed.left = dx > 0 ? 0 : std::max(int(width) + dx - margin, 0);
+      exposed.right = dx > 0 ? std::min(dx + margin, int(width)) : width;
+
+      if (border > 0) {
+        PixelRect &edge = rects[n++];
+        edge.top = 0;
+        edge.bottom = height;
+        edge.left = dx > 0 ? width - border : 0;
+        edge.right = dx > 0 ? width : border;
+      }
+    }
+
+    if (dy != 0) {
+      PixelRect &exposed = rects[n++];
+      exposed.left = 0;
+      exposed.right = width;
+      exposed.top = dy > 0 ? 0 : std::max(int(height) + dy - margin, 0);
+      exposed.bottom = dy > 0 ? std::min(dy + margin, int(height)) : height;
+
+      if (border > 0) {
+        PixelRect &edge = rects[n++];
+        edge.left = 0;
+        edge.right = width;
+        edge.top = dy > 0 ? height - border : 0;
+        edge.bottom = dy > 0 ? height : border;
+      }
+    }
+
+    for (unsigned i = 0; i < n; ++i)
+      GenerateImage(rects[i], 0, do_shading, height_scale,
+                    contrast, brightness, sunazimuth, contour_height_scale);
+  }
+
+  image_invalid = false;
+  pending_shift.x = pending_shift.y = 0;
+
+  image->SetDirty();
+}
+
+void
+RasterRenderer::GenerateImage(const PixelRect &rect, unsigned stripe,
+                              bool do_shading,
+                              unsigned height_scale,
+                              int contrast, int brightness,
+                              const Angle sunazimuth,
+                              unsigned contour_height_scale)
+{
+  ContourStart(rect, stripe, do_shading, contour_height_scale);
 
   if (do_shading)
-    GenerateSlopeImage(height_scale, contrast, brightness,
+    GenerateSlopeImage(rect, stripe, height_scale, contrast, brightness,
                        sunazimuth, contour_height_scale);
   else
-    GenerateUnshadedImage(height_scale, contour_height_scale);
-
-  image->SetDirty();
+    GenerateUnshadedImage(rect, stripe, height_scale, contour_height_scale);
 }
 
 void
-RasterRenderer::GenerateUnshadedImage(unsigned height_scale,
+RasterRenderer::GenerateUnshadedImage(const PixelRect &rect, unsigned stripe,
+                                      unsigned height_scale,
                                       const unsigned contour_height_scale)
 {
-  const short *src = height_matrix.GetData();
   const RawColor *oColorBuf = color_table + 64 * 256;
-  RawColor *dest = image->GetTopRow();
+  unsigned char *const column_base =
+    contour_column_base.begin() + stripe * height_matrix.GetWidth();
 
-  for (unsigned y = height_matrix.GetHeight(); y > 0; --y) {
-    RawColor *p = dest;
-    dest = image->GetNextRow(dest);
+  for (int y = rect.top; y < rect.bottom; ++y) {
+    const short *src = height_matrix.GetRow(y) + rect.left;
+    RawColor *p = image->GetRow(y) + rect.left;
 
-    unsigned contour_row_base = ContourInterval(*src, contour_height_scale);
-    unsigned char *contour_this_column_base = contour_column_base;
+    unsigned contour_row_base =
+      ContourRowStart(rect.left, y, false, contour_height_scale);
+    unsigned char *contour_this_column_base = column_base + rect.left;
 
-    for (unsigned x = height_matrix.GetWidth(); x > 0; --x) {
+    for (unsigned x = rect.right - rect.left; x > 0; --x) {
       int h = *src++;
       if (gcc_likely(!RasterBuffer::IsSpecial(h))) {
         if (h < 0)
@@ -271,26 +589,14 @@ RasterRenderer::GenerateUnshadedImage(unsigned height_scale,
   }
 }
 
-/**
- * Clip the difference between two adjacent terrain height values to
- * sane bounds.  This works around integer overflows in the
- * GenerateSlopeImage() formula when the map file is broken, avoiding
- * the sqrt() call with a negative argument.
- */
-gcc_const
-static int
-ClipHeightDelta(int d)
-{
-  return Clamp(d, -512, 512);
-}
-
 // JMW: if zoomed right in (e.g. one unit is larger than terrain
 // grid), then increase the step size to be equal to the terrain
 // grid for purposes of calculating slope, to avoid shading problems
 // (gridding of display) This is why quantisation_effective is used instead of 1
 // previously.  for large zoom levels, quantisation_effective=1
 void
-RasterRenderer::GenerateSlopeImage(unsigned height_scale,
+RasterRenderer::GenerateSlopeImage(const PixelRect &rect, unsigned stripe,
+                                   unsigned height_scale,
                                    int contrast,
                                    const int sx, const int sy, const int sz,
                                    const unsigned contour_height_scale)
@@ -310,12 +616,24 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
              square will not overflow */
           8192u / (quantisation_effective * quantisation_effective));
 
-  const short *src = height_matrix.GetData();
+  const SlopeShadingParameters shading{
+    sx, sy, sz, contrast, height_slope_factor,
+  };
+
   const RawColor *oColorBuf = color_table + 64 * 256;
+  unsigned char *const column_base =
+    contour_column_base.begin() + stripe * height_matrix.GetWidth();
+  signed char *const shade =
+    shade_row.begin() + stripe * height_matrix.GetWidth();
 
-  RawColor *dest = image->GetTopRow();
+  /* the range of columns where the row kernel can be used */
+  const int kernel_left = std::max(border.left, rect.left);
+  const int kernel_right = std::min(border.right, rect.right);
+
+  for (unsigned y = rect.top; y < (unsigned)rect.bottom; ++y) {
+    const short *src = height_matrix.GetRow(y);
+    RawColor *p = image->GetRow(y) + rect.left;
 
-  for (unsigned y = 0; y < height_matrix.GetHeight(); ++y) {
     const unsigned row_plus_index = y < (unsigned)border.bottom
       ? quantisation_effective
       : height_matrix.GetHeight() - 1 - y;
@@ -327,13 +645,24 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
 
     const unsigned p31 = row_plus_index + row_minus_index;
 
-    RawColor *p = dest;
-    dest = image->GetNextRow(dest);
+    /* calculate the illumination of all pixels which have a full
+       horizontal neighbourhood in one pass; the vectorised kernel
+       is a lot faster than doing it pixel by pixel below */
+    if (kernel_right > kernel_left)
+      CalcSlopeShadingRow(shade + kernel_left,
+                          src + kernel_left - row_minus_offset,
+                          src + kernel_left,
+                          src + kernel_left + row_plus_offset,
+                          quantisation_effective, p31,
+                          kernel_right - kernel_left, shading);
+
+    src += rect.left;
 
-    unsigned contour_row_base = ContourInterval(*src, contour_height_scale);
-    unsigned char *contour_this_column_base = contour_column_base;
+    unsigned contour_row_base =
+      ContourRowStart(rect.left, y, true, contour_height_scale);
+    unsigned char *contour_this_column_base = column_base + rect.left;
 
-    for (unsigned x = 0; x < height_matrix.GetWidth(); ++x, ++src) {
+    for (unsigned x = rect.left; x < (unsigned)rect.right; ++x, ++src) {
       int h = *src;
       if (gcc_likely(!RasterBuffer::IsSpecial(h))) {
         if (h < 0)
@@ -389,25 +718,13 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
           continue;
         }
 
-        const int p32 = ClipHeightDelta(h_above - h_below);
-        const int p22 = ClipHeightDelta(h_right - h_left);
-
-        const unsigned p20 = column_plus_index + column_minus_index;
-
-        const int dd0 = p22 * int(p31);
-        const int dd1 = int(p20) * p32;
-        const unsigned dd2 = p20 * p31 * height_slope_factor;
-        const int num = (int(dd2) * sz + dd0 * sx + dd1 * sy);
-        const unsigned square_mag = dd0 * dd0 + dd1 * dd1 + dd2 * dd2;
-        const unsigned mag = (unsigned)sqrt((fixed)square_mag);
-        /* this is a workaround for a SIGFPE (division by zero)
-           observed by our users on some Android devices (e.g. Nexus
-           7), even though we did our best to make sure that the
-           integer arithmetics above can't overflow */
-        /* TODO: debug this problem and replace this workaround */
-        const int sval = num / int(mag|1);
-        const int sindex = (sval - sz) * contrast / 128;
-        *p++ = oColorBuf[h + 256 * Clamp(sindex, -63, 63)];
+        const int sindex = x >= (unsigned)border.left &&
+          x < (unsigned)border.right
+          ? shade[x]
+          : CalcSlopeShading(h_above, h_below, h_left, h_right,
+                             column_plus_index + column_minus_index, p31,
+                             shading);
+        *p++ = oColorBuf[h + 256 * sindex];
       } else if (RasterBuffer::IsWater(h)) {
         // we're in the water, so look up the color for water
         *p++ = oColorBuf[255];
@@ -422,7 +739,8 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
 }
 
 void
-RasterRenderer::GenerateSlopeImage(unsigned height_scale,
+RasterRenderer::GenerateSlopeImage(const PixelRect &rect, unsigned stripe,
+                                   unsigned height_scale,
                                    int contrast, int brightness,
                                    const Angle sunazimuth,
                                    const unsigned contour_height_scale)
@@ -434,7 +752,7 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
   const int sy = (int)(255 * fudgeelevation.fastcosine() * -sunazimuth.fastcosine());
   const int sz = (int)(255 * fudgeelevation.fastsine());
 
-  GenerateSlopeImage(height_scale, contrast,
+  GenerateSlopeImage(rect, stripe, height_scale, contrast,
                      sx, sy, sz, contour_height_scale);
 }
 
@@ -470,14 +788,65 @@ RasterRenderer::PrepareColorTable(const ColorRamp *color_ramp, bool do_water,
       color_table[i + (mag + 64) * 256] = color;
     }
   }
+
+  image_invalid = true;
+}
+
+bool
+RasterRenderer::IsContourCell(unsigned x, unsigned y, bool do_shading) const
+{
+  const unsigned width = height_matrix.GetWidth();
+  const unsigned height = height_matrix.GetHeight();
+  const short *src = height_matrix.GetRow(y) + x;
+
+  if (RasterBuffer::IsSpecial(*src))
+    return false;
+
+  if (!do_shading)
+    return true;
+
+  /* the same neighbours as in GenerateSlopeImage() */
+  const unsigned above = std::min(y, quantisation_effective);
+  const unsigned below = std::min(height - 1 - y, quantisation_effective);
+  const unsigned left = std::min(x, quantisation_effective);
+  const unsigned right = std::min(width - 1 - x, quantisation_effective);
+
+  return !RasterBuffer::IsSpecial(src[-int(above * width)]) &&
+    !RasterBuffer::IsSpecial(src[below * width]) &&
+    !RasterBuffer::IsSpecial(src[-int(left)]) &&
+    !RasterBuffer::IsSpecial(src[right]);
+}
+
+unsigned
+RasterRenderer::ContourRowStart(unsigned x, unsigned y, bool do_shading,
+                                const unsigned contour_height_scale) const
+{
+  /* the state is the interval of the nearest cell which was compared,
+     or of the first cell in the row */
+  while (x > 0 && !IsContourCell(x - 1, y, do_shading))
+    --x;
+
+  return ContourInterval(height_matrix.GetRow(y)[x > 0 ? x - 1 : 0],
+                         contour_height_scale);
 }
 
 void
-RasterRenderer::ContourStart(const unsigned contour_height_scale)
+RasterRenderer::ContourStart(const PixelRect &rect, unsigned stripe,
+                             bool do_shading,
+                             const unsigned contour_height_scale)
 {
-  // initialise column to first row
-  const short *src = height_matrix.GetData();
-  unsigned char *col_base = contour_column_base;
-  for (unsigned x = height_matrix.GetWidth(); x > 0; --x)
-    *col_base++ = ContourInterval(*src++, contour_height_scale);
+  /* initialise each column with the interval of the nearest cell
+     above which was compared, or of the first row; this makes a
+     rectangle look the same as if the whole image had been
+     generated */
+  unsigned char *col_base = contour_column_base.begin()
+    + stripe * height_matrix.GetWidth() + rect.left;
+  for (unsigned x = rect.left; x < unsigned(rect.right); ++x) {
+    unsigned y = rect.top;
+    while (y > 0 && !IsContourCell(x, y - 1, do_shading))
+      --y;
+
+    *col_base++ = ContourInterval(height_matrix.GetRow(y > 0 ? y - 1 : 0)[x],
+                                  contour_height_scale);
+  }
 }
@@ -26,14 +26,16 @@ Copyright_License {
 
 #include "Terrain/HeightMatrix.hpp"
 #include "Math/fixed.hpp"
+#include "Math/Angle.hpp"
 
 #ifdef ENABLE_OPENGL
 #include "Geo/GeoBounds.hpp"
+#else
+#include "Geo/GeoPoint.hpp"
 #endif
 
 #define NUM_COLOR_RAMP_LEVELS 13
 
-class Angle;
 class Canvas;
 class RasterMap;
 class WindowProjection;
@@ -49,6 +51,12 @@ class RasterRenderer {
   /** screen dimensions in coarse pixels */
   unsigned quantisation_pixels = 2;
 
+  /**
+   * The number of horizontal stripes which are scanned and rendered
+   * in parallel.
+   */
+  unsigned n_stripes;
+
 #ifdef ENABLE_OPENGL
   /**
    * The value of #quantisation_pixels that was used in the last
@@ -70,12 +78,91 @@ class RasterRenderer {
    * texture has to be redrawn.
    */
   GeoBounds bounds = GeoBounds::Invalid();
+#else
+  /**
+   * A geographic location recorded by the last full scan.  It is
+   * used to locate the previous #HeightMatrix contents in a new
+   * projection.  Invalid if there are no reusable contents.
+   */
+  GeoPoint anchor = GeoPoint::Invalid();
+
+  /**
+   * The cell of the #HeightMatrix which corresponds with #anchor.
+   * It may be outside of the matrix after panning.
+   */
+  RasterPoint anchor_cell;
+
+  /**
+   * The screen pixel of the #HeightMatrix cell (0,0).  This is
+   * non-zero after an incremental scan, because the pan distance is
+   * rounded to whole cells.
+   */
+  RasterPoint grid_offset;
+
+  /**
+   * The projection parameters of the last full scan.  If one of them
+   * changes, the #HeightMatrix cannot be reused.
+   */
+  fixed last_scale;
+  Angle last_screen_angle;
+  unsigned last_screen_width, last_screen_height;
 #endif
 
+  /**
+   * The #RasterMap that was scanned last, only used to detect
+   * changes.
+   */
+  const RasterMap *last_map = nullptr;
+
+  /**
+   * The number of cells the #HeightMatrix contents were moved by
+   * incremental ScanMap() calls since the last GenerateImage() call.
+   */
+  RasterPoint pending_shift = RasterPoint(0, 0);
+
+  /**
+   * Must the next GenerateImage() call regenerate the whole image,
+   * because its contents cannot be moved by #pending_shift?
+   */
+  bool image_invalid = true;
+
+  /**
+   * The GenerateImage() parameters that were used to generate the
+   * current image.
+   */
+  struct ImageParameters {
+    bool do_shading;
+    unsigned height_scale;
+    int contrast, brightness;
+    Angle sunazimuth;
+    bool do_contour;
+
+    bool operator==(const ImageParameters &other) const {
+      return do_shading == other.do_shading &&
+        height_scale == other.height_scale &&
+        contrast == other.contrast && brightness == other.brightness &&
+        sunazimuth == other.sunazimuth &&
+        do_contour == other.do_contour;
+    }
+
+    bool operator!=(const ImageParameters &other) const {
+      return !(*this == other);
+    }
+  } last_image_parameters;
+
   HeightMatrix height_matrix;
   RawBitmap *image = nullptr;
 
-  unsigned char *contour_column_base = nullptr;
+  /**
+   * The contour state of each column, one row per stripe.
+   */
+  AllocatedArray<unsigned char> contour_column_base;
+
+  /**
+   * Buffer for the illumination indexes of one row, filled by
+   * CalcSlopeShadingRow(), one row per stripe.
+   */
+  AllocatedArray<signed char> shade_row;
 
   fixed pixel_size;
 
@@ -100,11 +187,35 @@ public:
     return height_matrix.GetHeight();
   }
 
-#ifdef ENABLE_OPENGL
+  unsigned GetStripes() const {
+    return n_stripes;
+  }
+
+  /**
+   * Set the number of horizontal stripes which are scanned and
+   * rendered in parallel.  The result does not depend on this
+   * setting, only the speed.
+   */
+  void SetStripes(unsigned _n_stripes) {
+    n_stripes = _n_stripes > 0 ? _n_stripes : 1;
+  }
+
+  /**
+   * Discard the current #HeightMatrix and image contents, e.g. after
+   * new terrain tiles have been loaded.  The next ScanMap() call will
+   * scan the whole map.
+   */
   void Invalidate() {
+#ifdef ENABLE_OPENGL
     bounds.SetInvalid();
+#else
+    anchor.SetInvalid();
+#endif
+    image_invalid = true;
   }
 
+#ifdef ENABLE_OPENGL
+
   /**
    * Calculate a new #quantisation_pixels value.
    *
@@ -129,12 +240,17 @@ public:
                          unsigned height_scale, int interp_levels);
 
   /**
-   * Scan the map and fill the height matrix.
+   * Scan the map and fill the height matrix.  If the view was only
+   * panned since the last call (same map, scale and rotation), the
+   * previous contents are moved and only the exposed parts are
+   * scanned.
    */
   void ScanMap(const RasterMap &map, const WindowProjection &projection);
 
   /**
-   * Convert the height matrix into the image.
+   * Convert the height matrix into the image.  After an incremental
+   * ScanMap() with unchanged parameters, only the parts of the image
+   * affected by the exposed cells are regenerated.
    */
   void GenerateImage(bool do_shading,
                      unsigned height_scale, int contrast, int brightness,
@@ -147,29 +263,87 @@ public:
 
 protected:
   /**
-   * Convert the height matrix into the image, without shading.
+   * Convert a rectangle of the height matrix into the image, without
+   * shading.
    */
-  void GenerateUnshadedImage(unsigned height_scale,
+  void GenerateUnshadedImage(const PixelRect &rect, unsigned stripe,
+                             unsigned height_scale,
                              const unsigned contour_height_scale);
 
   /**
-   * Convert the height matrix into the image, with slope shading.
+   * Convert a rectangle of the height matrix into the image, with
+   * slope shading.
    */
-  void GenerateSlopeImage(unsigned height_scale, int contrast,
+  void GenerateSlopeImage(const PixelRect &rect, unsigned stripe,
+                          unsigned height_scale, int contrast,
                           const int sx, const int sy, const int sz,
                           const unsigned contour_height_scale);
 
   /**
-   * Convert the height matrix into the image, with slope shading.
+   * Convert a rectangle of the height matrix into the image, with
+   * slope shading.
    */
-  void GenerateSlopeImage(unsigned height_scale,
+  void GenerateSlopeImage(const PixelRect &rect, unsigned stripe,
+                          unsigned height_scale,
                           int contrast, int brightness,
                           const Angle sunazimuth,
                           const unsigned contour_height_scale);
 
 private:
+  /**
+   * Attempt to reuse the previous #HeightMatrix contents.
+   *
+   * @return false if a full scan is necessary
+   */
+  bool ScanMapIncremental(const RasterMap &map,
+                          const WindowProjection &projection);
 
-  void ContourStart(const unsigned contour_height_scale);
+  /**
+   * Move the #HeightMatrix contents and scan the exposed cells.
+   */
+#ifdef ENABLE_OPENGL
+  void ShiftHeightMatrix(const RasterMap &map, int dx, int dy);
+#else
+  void ShiftHeightMatrix(const RasterMap &map,
+                         const WindowProjection &projection,
+                         int dx, int dy);
+#endif
+
+  /**
+   * Convert a rectangle of the height matrix into the image.
+   *
+   * @param stripe selects the buffers to be used; rectangles which
+   * are generated in parallel must use different stripes
+   */
+  void GenerateImage(const PixelRect &rect, unsigned stripe,
+                     bool do_shading,
+                     unsigned height_scale, int contrast, int brightness,
+                     const Angle sunazimuth,
+                     unsigned contour_height_scale);
+
+  /**
+   * Does the image generator compare and update the contour state at
+   * this cell, i.e. is neither the cell nor (with slope shading) one
+   * of its slope neighbours "special"?
+   */
+  gcc_pure
+  bool IsContourCell(unsigned x, unsigned y, bool do_shading) const;
+
+  /**
+   * Calculate the contour state of the given row at the left edge of
+   * a rectangle, i.e. the state the image generator would have after
+   * processing the cells left of it.
+   */
+  gcc_pure
+  unsigned ContourRowStart(unsigned x, unsigned y, bool do_shading,
+                           const unsigned contour_height_scale) const;
+
+  /**
+   * Initialise the contour state of the columns of a rectangle, so
+   * it continues the state of the rows above.
+   */
+  void ContourStart(const PixelRect &rect, unsigned stripe, bool do_shading,
+                    const unsigned contour_height_scale);
 };
 
 #endif
@@ -23,22 +23,34 @@ Copyright_License {
 
 #include "RasterTerrain.hpp"
 #include "Loader.hpp"
+#include "TileStore.hpp"
 #include "Profile/Profile.hpp"
 #include "IO/FileCache.hpp"
+#include "LogFile.hpp"
 #include "Compatibility/path.h"
 #include "OS/ConvertPathName.hpp"
+#include "Thread/Parallel.hpp"
 
 #include <zzip/zzip.h>
 
 #include <windef.h> /* for MAX_PATH */
 
+#include <algorithm>
+
 #include <string.h>
 
 static const TCHAR *const terrain_cache_name = _T("terrain");
+static const TCHAR *const tile_store_cache_name = _T("terrain_tiles");
 
 RasterTerrain::~RasterTerrain()
 {
-    zzip_dir_close(dir);
+  const auto statistics = map.GetTileCache().GetStatistics();
+  LogFormat("Terrain: %llu of %llu height lookups used the overview",
+            (unsigned long long)statistics.overview_lookups,
+            (unsigned long long)statistics.lookups);
+
+  for (auto *d : dirs)
+    zzip_dir_close(d);
 }
 
 inline bool
@@ -72,20 +84,60 @@ RasterTerrain::SaveCache(FileCache &cache, const TCHAR *path) const
   return success;
 }
 
+inline bool
+RasterTerrain::LoadTileStore(FileCache &cache, const TCHAR *path)
+{
+  FileMapping *mapping = cache.LoadMapping(tile_store_cache_name, path);
+  return mapping != nullptr && map.GetTileCache().LoadTileStore(mapping);
+}
+
+inline bool
+RasterTerrain::LoadOverview(const TCHAR *path, FileCache *cache,
+                            OperationEnvironment &operation)
+{
+  FILE *file = cache != nullptr
+    ? cache->Save(tile_store_cache_name, path)
+    : nullptr;
+  if (file == nullptr)
+    return LoadTerrainOverview(dir, map.GetTileCache(), operation);
+
+  /* the overview scan decodes all tiles anyway; this is the cheapest
+     moment to write the tile store */
+  TileStoreWriter tile_store(file);
+  if (!LoadTerrainOverview(dir, map.GetTileCache(), operation,
+                           &tile_store)) {
+    cache->Cancel(tile_store_cache_name, file);
+    return false;
+  }
+
+  if (tile_store.Finish())
+    cache->Commit(tile_store_cache_name, file);
+  else
+    cache->Cancel(tile_store_cache_name, file);
+
+  return true;
+}
+
 inline bool
 RasterTerrain::Load(const TCHAR *path, FileCache *cache,
                     OperationEnvironment &operation)
 {
-  if (LoadCache(cache, path))
+  if (LoadCache(cache, path)) {
+    /* the tile store is optional; without it, tiles are decoded from
+       the JPEG2000 file on demand */
+    LoadTileStore(*cache, path);
     return true;
+  }
 
-  if (!LoadTerrainOverview(dir, map.GetTileCache(), operation))
+  if (!LoadOverview(path, cache, operation))
     return false;
 
   map.UpdateProjection();
 
-  if (cache != nullptr)
+  if (cache != nullptr) {
     SaveCache(*cache, path);
+    LoadTileStore(*cache, path);
+  }
 
   return true;
 }
@@ -97,27 +149,91 @@ RasterTerrain::OpenTerrain(FileCache *cache, OperationEnvironment &operation)
   if (!Profile::GetPath(ProfileKeys::MapFile, path))
     return nullptr;
 
+  return OpenTerrain(path, cache, operation);
+}
+
+RasterTerrain *
+RasterTerrain::OpenTerrain(const TCHAR *path, FileCache *cache,
+                           OperationEnvironment &operation)
+{
   ZZIP_DIR *dir = zzip_dir_open(NarrowPathName(path), nullptr);
   if (dir == nullptr)
     return nullptr;
 
-  RasterTerrain *rt = new RasterTerrain(dir, path);
+  RasterTerrain *rt = new RasterTerrain(dir);
   if (!rt->Load(path, cache, operation)) {
     delete rt;
     return nullptr;
   }
 
+  if (!rt->map.GetTileCache().IsMapped())
+    rt->OpenDecoderHandles(path);
+
   return rt;
 }
 
+void
+RasterTerrain::OpenDecoderHandles(const TCHAR *path)
+{
+  const unsigned n = std::min(GetCPUCount(), unsigned(MAX_DECODER_THREADS));
+  while (dirs.size() < n) {
+    ZZIP_DIR *d = zzip_dir_open(NarrowPathName(path), nullptr);
+    if (d == nullptr)
+      break;
+
+    dirs.append(d);
+  }
+}
+
+/**
+ * Convert the #TerrainPrefetch to raster coordinates.
+ *
+ * @return false if prefetching is disabled
+ */
+static bool
+ProjectPrefetch(const RasterProjection &projection,
+                const TerrainPrefetch &src, TilePrefetch &dest)
+{
+  if (!src.IsValid())
+    return false;
+
+  const SignedRasterLocation origin = projection.ProjectCoarse(src.location);
+
+  dest.segments.clear();
+  if (src.track_destination.IsValid())
+    dest.segments.append({origin,
+          projection.ProjectCoarse(src.track_destination)});
+  if (src.leg_destination.IsValid())
+    dest.segments.append({origin,
+          projection.ProjectCoarse(src.leg_destination)});
+  if (dest.segments.empty())
+    /* not moving and no task: prefetch around the aircraft */
+    dest.segments.append({origin, origin});
+
+  dest.radius = projection.DistancePixelsCoarse(src.radius);
+  return true;
+}
+
 bool
-RasterTerrain::UpdateTiles(const GeoPoint &location, fixed radius)
+RasterTerrain::UpdateTiles(const GeoPoint &location, fixed radius,
+                           const TerrainPrefetch &prefetch)
 {
   auto &tile_cache = map.GetTileCache();
   if (!tile_cache.IsValid())
     return false;
 
-  UpdateTerrainTiles(dir, tile_cache, mutex,
-                     map.GetProjection(), location, radius);
+  const auto &projection = map.GetProjection();
+
+  TilePrefetch tile_prefetch;
+  const bool have_prefetch =
+    ProjectPrefetch(projection, prefetch, tile_prefetch);
+
+  const auto raster_location = projection.ProjectCoarse(location);
+  UpdateTerrainTiles(ConstBuffer<struct zzip_dir *>(dirs.begin(),
+                                                    dirs.size()),
+                     "terrain.jp2", tile_cache, mutex,
+                     raster_location.x, raster_location.y,
+                     projection.DistancePixelsCoarse(radius),
+                     have_prefetch ? &tile_prefetch : nullptr);
   return map.IsDirty();
 }
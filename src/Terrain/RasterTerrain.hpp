@@ -25,8 +25,10 @@ Copyright_License {
 #define XCSOAR_TERRAIN_RASTER_TERRAIN_HPP
 
 #include "RasterMap.hpp"
+#include "Prefetch.hpp"
 #include "Geo/GeoPoint.hpp"
 #include "Thread/Guard.hpp"
+#include "Util/StaticArray.hpp"
 #include "Compiler.h"
 
 #include <tchar.h>
@@ -48,17 +50,31 @@ public:
   /** invalid value for terrain */
   static constexpr short TERRAIN_INVALID = RasterBuffer::TERRAIN_INVALID;
 
+  /**
+   * The maximum number of threads decoding JPEG2000 tiles in
+   * parallel.
+   */
+  static constexpr unsigned MAX_DECODER_THREADS = 4;
+
 private:
   struct zzip_dir *const dir;
 
+  /**
+   * One handle on the map file for each decoder thread (zzip handles
+   * are not thread-safe).  The first one is #dir.
+   */
+  StaticArray<struct zzip_dir *, MAX_DECODER_THREADS> dirs;
+
   RasterMap map;
 
 private:
   /**
    * Constructor.  Returns uninitialised object.
    */
-  explicit RasterTerrain(struct zzip_dir *_dir, const TCHAR *_path)
-    :Guard<RasterMap>(map), dir(_dir) {}
+  explicit RasterTerrain(struct zzip_dir *_dir)
+    :Guard<RasterMap>(map), dir(_dir) {
+    dirs.append(dir);
+  }
 
 public:
   ~RasterTerrain();
@@ -73,6 +89,12 @@ public:
   static RasterTerrain *OpenTerrain(FileCache *cache,
                                     OperationEnvironment &operation);
 
+  /**
+   * Load the terrain from the specified map file.
+   */
+  static RasterTerrain *OpenTerrain(const TCHAR *path, FileCache *cache,
+                                    OperationEnvironment &operation);
+
   gcc_pure
   short GetTerrainHeight(const GeoPoint location) const {
     Lease lease(*this);
@@ -102,9 +124,12 @@ public:
   }
 
   /**
+   * @param prefetch an optional predicted flight path; tiles along
+   * this path are loaded first
    * @return true if the method shall be called again
    */
-  bool UpdateTiles(const GeoPoint &location, fixed radius);
+  bool UpdateTiles(const GeoPoint &location, fixed radius,
+                   const TerrainPrefetch &prefetch=TerrainPrefetch::Invalid());
 
 private:
   bool LoadCache(FileCache &cache, const TCHAR *path);
@@ -115,8 +140,26 @@ private:
 
   bool SaveCache(FileCache &cache, const TCHAR *path) const;
 
+  /**
+   * Attempt to map the pre-decoded tile store from the cache.
+   */
+  bool LoadTileStore(FileCache &cache, const TCHAR *path);
+
+  /**
+   * Scan the JPEG2000 file to obtain the overview, and write the
+   * tile store to the cache as a side effect.
+   */
+  bool LoadOverview(const TCHAR *path, FileCache *cache,
+                    OperationEnvironment &operation);
+
   bool Load(const TCHAR *path, FileCache *cache,
             OperationEnvironment &operation);
+
+  /**
+   * Open additional handles on the map file for parallel tile
+   * decoding.
+   */
+  void OpenDecoderHandles(const TCHAR *path);
 };
 
 #endif
@@ -106,7 +106,7 @@ RasterTile::GetInterpolatedHeight(unsigned lx, unsigned ly,
   return buffer.GetInterpolated(lx, ly, ix, iy);
 }
 
-inline unsigned
+unsigned
 RasterTile::CalcDistanceTo(int x, int y) const
 {
   const unsigned int dx1 = abs(x - (int)xstart);
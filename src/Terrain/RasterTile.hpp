@@ -114,6 +114,16 @@ public:
 
   void CopyFrom(const struct jas_matrix &m);
 
+  /**
+   * Let this tile refer to pre-decoded heights (e.g. from a
+   * memory-mapped tile store) instead of allocating a buffer.
+   */
+  void SetExternal(const short *data) {
+    assert(IsDefined());
+
+    buffer.SetExternal(data, width, height);
+  }
+
   /**
    * Determine the non-interpolated height at the specified pixel
    * location.
@@ -23,6 +23,8 @@ Copyright_License {
 
 #include "Terrain/RasterTileCache.hpp"
 #include "Terrain/RasterLocation.hpp"
+#include "Terrain/TileStore.hpp"
+#include "OS/FileMapping.hpp"
 #include "Math/Angle.hpp"
 #include "IO/ZipLineReader.hpp"
 #include "Operation/Operation.hpp"
@@ -32,9 +34,24 @@ extern "C" {
 #include "jasper/jas_seq.h"
 }
 
-#include <string.h>
 #include <algorithm>
 
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+RasterTileCache::RasterTileCache()
+{
+  for (auto &slot : counters) {
+    slot.lookups = 0;
+    slot.overview_lookups = 0;
+  }
+
+  Reset();
+}
+
+RasterTileCache::~RasterTileCache() = default;
+
 static void
 CopyOverviewRow(short *gcc_restrict dest, const jas_seqent_t *gcc_restrict src,
                 unsigned width, unsigned skip)
@@ -98,9 +115,44 @@ struct RTDistanceSort {
   }
 };
 
+/**
+ * Calculate the distance of the tile to the predicted flight path.
+ * The segments are sampled at tile size intervals, which is good
+ * enough because the caller adds one tile size to the radius.
+ */
+gcc_pure
+static unsigned
+CalcPrefetchDistance(const RasterTile &tile, const TilePrefetch &prefetch,
+                     unsigned step)
+{
+  unsigned distance = UINT_MAX;
+
+  for (const auto &segment : prefetch.segments) {
+    const int dx = segment.end.x - segment.start.x;
+    const int dy = segment.end.y - segment.start.y;
+    const unsigned length = std::max(std::abs(dx), std::abs(dy));
+    const unsigned n = length / step + 1;
+
+    for (unsigned i = 0; i <= n; ++i) {
+      const int x = segment.start.x + dx * (int)i / (int)n;
+      const int y = segment.start.y + dy * (int)i / (int)n;
+      distance = std::min(distance, tile.CalcDistanceTo(x, y));
+    }
+  }
+
+  return distance;
+}
+
 bool
-RasterTileCache::PollTiles(int x, int y, unsigned radius)
+RasterTileCache::PollTiles(int x, int y, unsigned radius,
+                           const TilePrefetch *prefetch)
 {
+  if (IsMapped()) {
+    /* all tiles are available already */
+    dirty = false;
+    return false;
+  }
+
   /* tiles are usually 256 pixels wide; with a radius smaller than
      that, the (optimized) tile distance calculations may fail;
      additionally, this ensures that tiles which are slightly out of
@@ -118,18 +170,40 @@ RasterTileCache::PollTiles(int x, int y, unsigned radius)
   /* query all tiles; all tiles which are either in range or already
      loaded are added to RequestTiles */
 
+  const unsigned prefetch_radius = prefetch != nullptr
+    ? prefetch->radius + 256
+    : 0;
+
   request_tiles.clear();
-  for (int i = tiles.GetSize() - 1; i >= 0 && !request_tiles.full(); --i)
-    if (tiles.GetLinear(i).VisibilityChanged(x, y, radius))
-      request_tiles.append(i);
+  for (int i = tiles.GetSize() - 1; i >= 0 && !request_tiles.full(); --i) {
+    RasterTile &tile = tiles.GetLinear(i);
+    bool visible = tile.VisibilityChanged(x, y, radius);
+
+    if (prefetch != nullptr && tile.IsDefined()) {
+      /* tiles along the predicted path are treated as if they were
+         close to the screen center */
+      const unsigned distance =
+        CalcPrefetchDistance(tile, *prefetch,
+                             std::min(tile_width, tile_height));
+      if (distance <= prefetch_radius) {
+        tile.distance = std::min(tile.distance, distance);
+        visible = true;
+      }
+    }
 
-  /* reduce if there are too many */
+    if (visible)
+      request_tiles.append(i);
+  }
 
-  if (request_tiles.size() > MAX_ACTIVE_TILES) {
+  if (prefetch != nullptr || request_tiles.size() > MAX_ACTIVE_TILES) {
     /* sort by distance */
     const RTDistanceSort sort(*this);
     std::sort(request_tiles.begin(), request_tiles.end(), sort);
+  }
 
+  /* reduce if there are too many */
+
+  if (request_tiles.size() > MAX_ACTIVE_TILES) {
     /* dispose all tiles which are out of range */
     for (unsigned i = MAX_ACTIVE_TILES; i < request_tiles.size(); ++i) {
       RasterTile &tile = tiles.GetLinear(request_tiles[i]);
@@ -160,6 +234,34 @@ RasterTileCache::PollTiles(int x, int y, unsigned radius)
   return num_activate > 0;
 }
 
+unsigned
+RasterTileCache::GetCounterSlot()
+{
+  static std::atomic<unsigned> next_slot(0);
+
+  /* 0 means the thread has not been assigned a slot yet; this is a
+     plain integer so accessing it needs no initialisation guard */
+  static thread_local unsigned slot;
+  if (slot == 0)
+    slot = next_slot.fetch_add(1, std::memory_order_relaxed)
+      % N_COUNTER_SLOTS + 1;
+
+  return slot - 1;
+}
+
+RasterTileCache::Statistics
+RasterTileCache::GetStatistics() const
+{
+  Statistics statistics{0, 0};
+  for (const auto &slot : counters) {
+    statistics.lookups += slot.lookups.load(std::memory_order_relaxed);
+    statistics.overview_lookups +=
+      slot.overview_lookups.load(std::memory_order_relaxed);
+  }
+
+  return statistics;
+}
+
 short
 RasterTileCache::GetHeight(unsigned px, unsigned py) const
 {
@@ -168,8 +270,12 @@ RasterTileCache::GetHeight(unsigned px, unsigned py) const
     return RasterBuffer::TERRAIN_INVALID;
 
   const RasterTile &tile = tiles.Get(px / tile_width, py / tile_height);
-  if (tile.IsEnabled())
+  if (tile.IsEnabled()) {
+    CountLookups(1, 0);
     return tile.GetHeight(px, py);
+  }
+
+  CountLookups(1, 1);
 
   // still not found, so go to overview
   return overview.GetInterpolated(px << (SUBPIXEL_BITS - OVERVIEW_BITS),
@@ -188,8 +294,12 @@ RasterTileCache::GetInterpolatedHeight(unsigned int lx, unsigned int ly) const
   const unsigned int iy = CombinedDivAndMod(py);
 
   const RasterTile &tile = tiles.Get(px / tile_width, py / tile_height);
-  if (tile.IsEnabled())
+  if (tile.IsEnabled()) {
+    CountLookups(1, 0);
     return tile.GetInterpolatedHeight(px, py, ix, iy);
+  }
+
+  CountLookups(1, 1);
 
   // still not found, so go to overview
   return overview.GetInterpolated(lx >> OVERVIEW_BITS,
@@ -240,6 +350,8 @@ RasterTileCache::Reset()
 
   for (auto it = tiles.begin(), end = tiles.end(); it != end; ++it)
     it->Disable();
+
+  tile_store.reset();
 }
 
 const RasterTileCache::MarkerSegmentInfo *
@@ -373,3 +485,61 @@ RasterTileCache::LoadCache(FILE *file)
 
   return true;
 }
+
+bool
+RasterTileCache::LoadTileStore(FileMapping *mapping)
+{
+  assert(mapping != nullptr);
+  assert(!mapping->error());
+
+  std::unique_ptr<FileMapping> holder(mapping);
+
+  if (!IsValid())
+    return false;
+
+  const size_t size = mapping->size();
+  if (size < sizeof(TileStoreTrailer))
+    return false;
+
+  const auto &trailer = *(const TileStoreTrailer *)
+    mapping->at(size - sizeof(TileStoreTrailer));
+  const size_t n_tiles = tiles.GetSize();
+  if (trailer.magic != TileStoreTrailer::MAGIC ||
+      trailer.version != TileStoreTrailer::VERSION ||
+      trailer.tile_columns != tiles.GetWidth() ||
+      trailer.tile_rows != tiles.GetHeight() ||
+      trailer.index_offset % alignof(TileStoreEntry) != 0 ||
+      trailer.index_offset + n_tiles * sizeof(TileStoreEntry) >
+      size - sizeof(TileStoreTrailer))
+    return false;
+
+  const auto *index = (const TileStoreEntry *)
+    mapping->at(trailer.index_offset);
+
+  /* verify the whole index before modifying any tile */
+  for (size_t i = 0; i < n_tiles; ++i) {
+    const RasterTile &tile = tiles.GetLinear(i);
+    if (!tile.IsDefined())
+      continue;
+
+    const TileStoreEntry &entry = index[i];
+    if (entry.offset == 0 ||
+        entry.offset % TileStoreTrailer::ALIGNMENT != 0 ||
+        entry.xstart != tile.xstart || entry.ystart != tile.ystart ||
+        entry.width != tile.width || entry.height != tile.height ||
+        entry.offset + size_t(entry.width) * entry.height * sizeof(short) >
+        trailer.index_offset)
+      return false;
+  }
+
+  for (size_t i = 0; i < n_tiles; ++i) {
+    RasterTile &tile = tiles.GetLinear(i);
+    if (tile.IsDefined())
+      tile.SetExternal((const short *)mapping->at(index[i].offset));
+  }
+
+  tile_store = std::move(holder);
+  dirty = false;
+  ++serial;
+  return true;
+}
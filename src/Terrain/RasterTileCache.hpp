@@ -27,9 +27,13 @@ Copyright_License {
 #include "RasterTile.hpp"
 #include "RasterLocation.hpp"
 #include "Geo/GeoBounds.hpp"
+#include "Util/AllocatedGrid.hpp"
 #include "Util/StaticArray.hpp"
 #include "Util/Serial.hpp"
 
+#include <memory>
+#include <atomic>
+
 #include <assert.h>
 #include <tchar.h>
 #include <stddef.h>
@@ -41,6 +45,25 @@ Copyright_License {
 struct jas_matrix;
 struct GridLocation;
 class OperationEnvironment;
+class FileMapping;
+
+/**
+ * A predicted flight path in raster pixel coordinates.  Tiles near
+ * this path are loaded before all other tiles, see
+ * RasterTileCache::PollTiles().
+ */
+struct TilePrefetch {
+  struct Segment {
+    SignedRasterLocation start, end;
+  };
+
+  StaticArray<Segment, 2> segments;
+
+  /**
+   * Tiles within this distance [pixels] of a segment are loaded.
+   */
+  unsigned radius;
+};
 
 class RasterTileCache {
   static constexpr unsigned MAX_RTC_TILES = 4096;
@@ -110,7 +133,7 @@ protected:
   };
 
   struct CacheHeader {
-    static constexpr unsigned VERSION = 0xb;
+    static constexpr unsigned VERSION = 0xc;
 
     unsigned version;
     unsigned width, height;
@@ -146,10 +169,75 @@ protected:
    */
   StaticArray<uint16_t, MAX_RTC_TILES> request_tiles;
 
+  /**
+   * The memory-mapped tile store (see #TileStoreWriter).  If this is
+   * set, then all tiles point into this mapping, and nothing needs
+   * to be decoded; the kernel decides which pages stay resident.
+   */
+  std::unique_ptr<FileMapping> tile_store;
+
+  /**
+   * Counters for GetHeight(), GetInterpolatedHeight() and
+   * GetFieldDirect(), see #Statistics.  Each thread adds to its own
+   * slot (see GetCounterSlot()), which fills a whole cache line, so
+   * the glide, route and drawing threads do not contend for it.
+   * Threads share a slot only if there are more than
+   * #N_COUNTER_SLOTS of them.
+   *
+   * The lookup methods are still declared gcc_pure: if the compiler
+   * merges two lookups, they are counted once, which is good enough
+   * for statistics.
+   */
+  struct CounterSlot {
+    std::atomic<uint64_t> lookups, overview_lookups;
+
+    char padding[64 - 2 * sizeof(std::atomic<uint64_t>)];
+  };
+
+  static constexpr unsigned N_COUNTER_SLOTS = 8;
+
+  mutable CounterSlot counters[N_COUNTER_SLOTS];
+
+  /**
+   * Counts the lookups of one FirstIntersection() or Intersection()
+   * call in local variables, and adds them to the thread's slot
+   * when it goes out of scope.
+   */
+  class LookupCounter {
+    const RasterTileCache &cache;
+    unsigned lookups = 0, overview_lookups = 0;
+
+  public:
+    explicit LookupCounter(const RasterTileCache &_cache):cache(_cache) {}
+
+    ~LookupCounter() {
+      if (lookups > 0)
+        cache.CountLookups(lookups, overview_lookups);
+    }
+
+    void Add(bool overview) {
+      ++lookups;
+      if (overview)
+        ++overview_lookups;
+    }
+  };
+
 public:
-  RasterTileCache() {
-    Reset();
-  }
+  struct Statistics {
+    /**
+     * The total number of height lookups.
+     */
+    uint64_t lookups;
+
+    /**
+     * The number of height lookups which had to fall back to the
+     * overview because the tile was not loaded.
+     */
+    uint64_t overview_lookups;
+  };
+
+  RasterTileCache();
+  ~RasterTileCache();
 
   RasterTileCache(const RasterTileCache &) = delete;
   RasterTileCache &operator=(const RasterTileCache &) = delete;
@@ -160,6 +248,20 @@ public:
     bounds = _bounds;
   }
 
+private:
+  /**
+   * Returns the index of the calling thread's slot in #counters.
+   */
+  static unsigned GetCounterSlot();
+
+  void CountLookups(unsigned lookups, unsigned overview_lookups) const {
+    CounterSlot &slot = counters[GetCounterSlot()];
+    slot.lookups.fetch_add(lookups, std::memory_order_relaxed);
+    if (overview_lookups > 0)
+      slot.overview_lookups.fetch_add(overview_lookups,
+                                      std::memory_order_relaxed);
+  }
+
 protected:
   void ScanTileLine(GridLocation start, GridLocation end,
                     short *buffer, unsigned size, bool interpolate) const;
@@ -186,6 +288,9 @@ public:
   short GetInterpolatedHeight(unsigned int lx,
                               unsigned int ly) const;
 
+  gcc_pure
+  Statistics GetStatistics() const;
+
   /**
    * Scan a straight line and fill the buffer with the specified
    * number of samples along the line.
@@ -229,6 +334,23 @@ public:
   bool SaveCache(FILE *file) const;
   bool LoadCache(FILE *file);
 
+  /**
+   * Attach a tile store which was written by #TileStoreWriter.  Call
+   * this after the overview has been loaded.
+   *
+   * @param mapping the file mapping; this object takes ownership
+   * @return false if the tile store does not match this tile cache
+   * (the mapping is freed then)
+   */
+  bool LoadTileStore(FileMapping *mapping);
+
+  /**
+   * Are all tiles available from a memory-mapped tile store?
+   */
+  bool IsMapped() const {
+    return tile_store != nullptr;
+  }
+
   /**
    * Determines if there are still tiles scheduled to be loaded.  Call
    * this after UpdateTiles() to determine if UpdateTiles() should be
@@ -282,7 +404,15 @@ public:
                        unsigned end_x, unsigned end_y,
                        const struct jas_matrix &m);
 
-  bool PollTiles(int x, int y, unsigned radius);
+  /**
+   * Determine which tiles shall be loaded.
+   *
+   * @param prefetch an optional predicted flight path; tiles along
+   * this path are requested even if they are out of range, and
+   * before all others
+   */
+  bool PollTiles(int x, int y, unsigned radius,
+                 const TilePrefetch *prefetch=nullptr);
 
   void PutTileData(unsigned index, const struct jas_matrix &m);
 
@@ -153,7 +153,8 @@ RasterWeatherCache::SetViewCenter(const GeoPoint &location, fixed radius)
   /* fake a mutex - weather data is only used in the DrawThread */
   SharedMutex mutex;
 
-  UpdateTerrainTiles(dir, name, weather_map->GetTileCache(),
+  UpdateTerrainTiles(ConstBuffer<struct zzip_dir *>(&dir, 1), name,
+                     weather_map->GetTileCache(),
                      mutex,
                      weather_map->GetProjection(),
                      location, radius);
@@ -0,0 +1,64 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_SHIFT_GRID_HPP
+#define XCSOAR_TERRAIN_SHIFT_GRID_HPP
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Move the contents of a two-dimensional array by the given number
+ * of cells, i.e. the new cell (x,y) is the old cell (x-dx,y-dy).
+ * Cells which are exposed by this keep their old values.
+ *
+ * @param get_row a function returning a pointer to the given row
+ */
+template<typename GetRow>
+static inline void
+ShiftGrid(GetRow get_row, unsigned width, unsigned height, int dx, int dy)
+{
+  assert(unsigned(abs(dx)) < width);
+  assert(unsigned(abs(dy)) < height);
+
+  const unsigned n = width - abs(dx);
+  const unsigned src_x = dx < 0 ? -dx : 0;
+  const unsigned dest_x = dx > 0 ? dx : 0;
+
+  /* iterate in the direction which doesn't overwrite rows which are
+     still to be copied */
+  if (dy > 0) {
+    for (unsigned y = height - 1; y >= unsigned(dy); --y) {
+      auto *dest = get_row(y);
+      memmove(dest + dest_x, get_row(y - dy) + src_x, n * sizeof(*dest));
+    }
+  } else {
+    for (unsigned y = 0; y + unsigned(-dy) < height; ++y) {
+      auto *dest = get_row(y);
+      memmove(dest + dest_x, get_row(y - dy) + src_x, n * sizeof(*dest));
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,365 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "SlopeShading.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifdef __ARM_NEON__
+#include <arm_neon.h>
+#endif
+
+#include <type_traits>
+
+/* the vector kernels reproduce the square root of
+   CalcSlopeShading(), which is calculated with #fixed */
+static_assert(std::is_same<fixed, double>::value,
+              "the kernels assume that fixed is double");
+
+void
+CalcSlopeShadingRowScalar(signed char *gcc_restrict dest,
+                          const short *above, const short *src,
+                          const short *below,
+                          unsigned distance, unsigned p31, unsigned n,
+                          const SlopeShadingParameters &p)
+{
+  const unsigned p20 = 2 * distance;
+  const short *left = src - distance, *right = src + distance;
+
+  for (unsigned i = 0; i < n; ++i)
+    dest[i] = CalcSlopeShading(above[i], below[i], left[i], right[i],
+                               p20, p31, p);
+}
+
+#ifdef __SSE2__
+
+/*
+ * The SSE2 kernel calculates the surface normal with 16 bit integers
+ * (the operands are small enough, see the bounds documented in
+ * RasterRenderer::GenerateSlopeImage()) and does the square root and
+ * the divisions in double precision.  All intermediate values are
+ * exactly representable, and truncating conversions yield the same
+ * results as the integer arithmetics in CalcSlopeShading().
+ */
+
+class SSE2SlopeShading {
+  const __m128i clip_min = _mm_set1_epi16(-512);
+  const __m128i clip_max = _mm_set1_epi16(512);
+  const __m128i shade_min = _mm_set1_epi16(-63);
+  const __m128i shade_max = _mm_set1_epi16(63);
+  const __m128i one = _mm_set1_epi32(1);
+
+  const __m128i v_p20, v_p31;
+
+  /**
+   * The light source's x/y components, interleaved for
+   * _mm_madd_epi16().
+   */
+  const __m128i light;
+
+  /**
+   * The constant part of the numerator: dd2*sz.
+   */
+  const __m128i num_base;
+
+  /**
+   * The constant part of the squared magnitude: dd2*dd2.
+   */
+  const __m128d square_base;
+
+  const __m128d sz;
+  const __m128d contrast;
+
+public:
+  SSE2SlopeShading(unsigned distance, unsigned p31,
+                   const SlopeShadingParameters &p)
+    :v_p20(_mm_set1_epi16(2 * distance)),
+     v_p31(_mm_set1_epi16(p31)),
+     light(_mm_set_epi16(p.sy, p.sx, p.sy, p.sx, p.sy, p.sx, p.sy, p.sx)),
+     num_base(_mm_set1_epi32(int(2 * distance * p31 * p.height_slope_factor)
+                             * p.sz)),
+     square_base(_mm_set1_pd(double(2 * distance * p31 * p.height_slope_factor)
+                             * double(2 * distance * p31 * p.height_slope_factor))),
+     sz(_mm_set1_pd(p.sz)),
+     /* dividing by 128 is exact in double precision */
+     contrast(_mm_set1_pd(p.contrast / 128.)) {}
+
+  /**
+   * Calculate two illumination indexes (still unclipped) from the
+   * lower two 32 bit lanes of the given numerators and partial
+   * squared magnitudes.
+   */
+  gcc_always_inline
+  __m128i Shade2(__m128i num, __m128i square) const {
+    const __m128d mag_d =
+      _mm_sqrt_pd(_mm_add_pd(_mm_cvtepi32_pd(square), square_base));
+    const __m128i mag = _mm_or_si128(_mm_cvttpd_epi32(mag_d), one);
+    const __m128i sval =
+      _mm_cvttpd_epi32(_mm_div_pd(_mm_cvtepi32_pd(num),
+                                  _mm_cvtepi32_pd(mag)));
+    return _mm_cvttpd_epi32(_mm_mul_pd(_mm_sub_pd(_mm_cvtepi32_pd(sval), sz),
+                                       contrast));
+  }
+
+  /**
+   * Calculate four illumination indexes (still unclipped) from
+   * interleaved 16 bit pairs of dd0/dd1.
+   */
+  gcc_always_inline
+  __m128i Shade4(__m128i dd) const {
+    const __m128i num = _mm_add_epi32(_mm_madd_epi16(dd, light), num_base);
+    const __m128i square = _mm_madd_epi16(dd, dd);
+
+    const __m128i low = Shade2(num, square);
+    const __m128i high = Shade2(_mm_shuffle_epi32(num, _MM_SHUFFLE(1, 0, 3, 2)),
+                                _mm_shuffle_epi32(square,
+                                                  _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm_unpacklo_epi64(low, high);
+  }
+
+  gcc_always_inline
+  __m128i ClipDelta(__m128i a, __m128i b) const {
+    /* saturating subtraction followed by clipping yields the same
+       result as clipping the exact difference */
+    return _mm_min_epi16(_mm_max_epi16(_mm_subs_epi16(a, b), clip_min),
+                         clip_max);
+  }
+
+  gcc_always_inline
+  void Shade8(signed char *dest,
+              const short *above, const short *left,
+              const short *right, const short *below) const {
+    const __m128i p22 =
+      ClipDelta(_mm_loadu_si128((const __m128i *)right),
+                _mm_loadu_si128((const __m128i *)left));
+    const __m128i p32 =
+      ClipDelta(_mm_loadu_si128((const __m128i *)above),
+                _mm_loadu_si128((const __m128i *)below));
+
+    const __m128i dd0 = _mm_mullo_epi16(p22, v_p31);
+    const __m128i dd1 = _mm_mullo_epi16(v_p20, p32);
+
+    const __m128i low = Shade4(_mm_unpacklo_epi16(dd0, dd1));
+    const __m128i high = Shade4(_mm_unpackhi_epi16(dd0, dd1));
+
+    __m128i shade = _mm_packs_epi32(low, high);
+    shade = _mm_min_epi16(_mm_max_epi16(shade, shade_min), shade_max);
+    _mm_storel_epi64((__m128i *)dest, _mm_packs_epi16(shade, shade));
+  }
+};
+
+gcc_flatten
+static unsigned
+CalcSlopeShadingRowSSE2(signed char *gcc_restrict dest,
+                        const short *above, const short *src,
+                        const short *below,
+                        unsigned distance, unsigned p31, unsigned n,
+                        const SlopeShadingParameters &p)
+{
+  const SSE2SlopeShading kernel(distance, p31, p);
+
+  const unsigned n8 = n / 8;
+  for (unsigned i = 0; i < n8; ++i, dest += 8, above += 8, src += 8,
+         below += 8)
+    kernel.Shade8(dest, above, src - distance, src + distance, below);
+
+  return n8 * 8;
+}
+
+#endif
+
+#ifdef __ARM_NEON__
+
+/*
+ * ARMv7 NEON has neither a square root nor a division instruction.
+ * The kernel uses the reciprocal (square root) estimates with two
+ * Newton-Raphson steps, which are accurate to far less than one
+ * unit, and then corrects the truncated results with integer
+ * arithmetics to get exactly the same results as CalcSlopeShading().
+ */
+
+class NEONSlopeShading {
+  const int16x8_t clip_min = vdupq_n_s16(-512);
+  const int16x8_t clip_max = vdupq_n_s16(512);
+
+  const int16_t p20, p31;
+  const int16_t sx, sy;
+  const int32x4_t sz;
+  const int32_t contrast;
+
+  /**
+   * The constant part of the numerator: dd2*sz.
+   */
+  const int32x4_t num_base;
+
+  /**
+   * The constant part of the squared magnitude: dd2*dd2.
+   */
+  const uint32x4_t square_base;
+
+public:
+  NEONSlopeShading(unsigned distance, unsigned _p31,
+                   const SlopeShadingParameters &p)
+    :p20(2 * distance), p31(_p31),
+     sx(p.sx), sy(p.sy), sz(vdupq_n_s32(p.sz)),
+     contrast(p.contrast),
+     num_base(vdupq_n_s32(int(2 * distance * _p31 * p.height_slope_factor)
+                          * p.sz)),
+     square_base(vdupq_n_u32(2 * distance * _p31 * p.height_slope_factor
+                             * 2 * distance * _p31 * p.height_slope_factor)) {}
+
+  /**
+   * Calculate floor(sqrt(x)).
+   */
+  gcc_always_inline
+  static uint32x4_t Sqrt(uint32x4_t x) {
+    const float32x4_t f = vcvtq_f32_u32(x);
+    float32x4_t e = vrsqrteq_f32(f);
+    e = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(f, e), e));
+    e = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(f, e), e));
+
+    uint32x4_t r = vcvtq_u32_f32(vmulq_f32(f, e));
+
+    /* the comparison results are 0 or ~0, i.e. 0 or -1 */
+    r = vaddq_u32(r, vcgtq_u32(vmulq_u32(r, r), x));
+    const uint32x4_t r1 = vaddq_u32(r, vdupq_n_u32(1));
+    r = vsubq_u32(r, vcleq_u32(vmulq_u32(r1, r1), x));
+    return r;
+  }
+
+  /**
+   * Calculate num/d, truncated towards zero like the C division
+   * operator.  The absolute value of the quotient must be small
+   * (which it is, because it is the dot product with a normalised
+   * vector).
+   */
+  gcc_always_inline
+  static int32x4_t Divide(int32x4_t num, int32x4_t d) {
+    const uint32x4_t a = vreinterpretq_u32_s32(vabsq_s32(num));
+    const float32x4_t df = vcvtq_f32_s32(d);
+    float32x4_t e = vrecpeq_f32(df);
+    e = vmulq_f32(e, vrecpsq_f32(df, e));
+    e = vmulq_f32(e, vrecpsq_f32(df, e));
+
+    int32x4_t q = vreinterpretq_s32_u32(vcvtq_u32_f32(vmulq_f32(vcvtq_f32_u32(a),
+                                                               e)));
+    const int32x4_t rem = vsubq_s32(vreinterpretq_s32_u32(a), vmulq_s32(q, d));
+
+    /* the comparison results are 0 or ~0, i.e. 0 or -1 */
+    q = vaddq_s32(q, vreinterpretq_s32_u32(vcltq_s32(rem, vdupq_n_s32(0))));
+    q = vsubq_s32(q, vreinterpretq_s32_u32(vcgeq_s32(rem, d)));
+
+    /* restore the sign */
+    const int32x4_t sign = vshrq_n_s32(num, 31);
+    return vsubq_s32(veorq_s32(q, sign), sign);
+  }
+
+  gcc_always_inline
+  int16x4_t Shade4(int16x4_t dd0, int16x4_t dd1) const {
+    const int32x4_t num = vmlal_n_s16(vmlal_n_s16(num_base, dd0, sx),
+                                      dd1, sy);
+    const uint32x4_t square =
+      vaddq_u32(vreinterpretq_u32_s32(vmlal_s16(vmull_s16(dd0, dd0),
+                                                dd1, dd1)),
+                square_base);
+
+    const int32x4_t mag =
+      vorrq_s32(vreinterpretq_s32_u32(Sqrt(square)), vdupq_n_s32(1));
+    const int32x4_t sval = Divide(num, mag);
+
+    /* division by 128, rounding towards zero */
+    int32x4_t t = vmulq_n_s32(vsubq_s32(sval, sz), contrast);
+    t = vaddq_s32(t, vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(vshrq_n_s32(t, 31)), 25)));
+    t = vshrq_n_s32(t, 7);
+
+    t = vminq_s32(vmaxq_s32(t, vdupq_n_s32(-63)), vdupq_n_s32(63));
+    return vmovn_s32(t);
+  }
+
+  gcc_always_inline
+  int16x8_t ClipDelta(int16x8_t a, int16x8_t b) const {
+    /* saturating subtraction followed by clipping yields the same
+       result as clipping the exact difference */
+    return vminq_s16(vmaxq_s16(vqsubq_s16(a, b), clip_min), clip_max);
+  }
+
+  gcc_always_inline
+  void Shade8(signed char *dest,
+              const short *above, const short *left,
+              const short *right, const short *below) const {
+    const int16x8_t p22 = ClipDelta(vld1q_s16(right), vld1q_s16(left));
+    const int16x8_t p32 = ClipDelta(vld1q_s16(above), vld1q_s16(below));
+
+    const int16x8_t dd0 = vmulq_n_s16(p22, p31);
+    const int16x8_t dd1 = vmulq_n_s16(p32, p20);
+
+    const int16x8_t shade =
+      vcombine_s16(Shade4(vget_low_s16(dd0), vget_low_s16(dd1)),
+                   Shade4(vget_high_s16(dd0), vget_high_s16(dd1)));
+    vst1_s8((int8_t *)dest, vmovn_s16(shade));
+  }
+};
+
+gcc_flatten
+static unsigned
+CalcSlopeShadingRowNEON(signed char *gcc_restrict dest,
+                        const short *above, const short *src,
+                        const short *below,
+                        unsigned distance, unsigned p31, unsigned n,
+                        const SlopeShadingParameters &p)
+{
+  const NEONSlopeShading kernel(distance, p31, p);
+
+  const unsigned n8 = n / 8;
+  for (unsigned i = 0; i < n8; ++i, dest += 8, above += 8, src += 8,
+         below += 8)
+    kernel.Shade8(dest, above, src - distance, src + distance, below);
+
+  return n8 * 8;
+}
+
+#endif
+
+void
+CalcSlopeShadingRow(signed char *gcc_restrict dest,
+                    const short *above, const short *src,
+                    const short *below,
+                    unsigned distance, unsigned p31, unsigned n,
+                    const SlopeShadingParameters &p)
+{
+  unsigned done = 0;
+
+#if defined(__SSE2__)
+  done = CalcSlopeShadingRowSSE2(dest, above, src, below,
+                                 distance, p31, n, p);
+#elif defined(__ARM_NEON__)
+  done = CalcSlopeShadingRowNEON(dest, above, src, below,
+                                 distance, p31, n, p);
+#endif
+
+  /* the remaining pixels which don't fill a vector */
+  CalcSlopeShadingRowScalar(dest + done, above + done, src + done,
+                            below + done, distance, p31, n - done, p);
+}
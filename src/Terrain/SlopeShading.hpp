@@ -0,0 +1,135 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_SLOPE_SHADING_HPP
+#define XCSOAR_TERRAIN_SLOPE_SHADING_HPP
+
+#include "Util/Clamp.hpp"
+#include "Math/fixed.hpp"
+#include "Compiler.h"
+
+#include <math.h>
+
+/**
+ * Parameters for the slope shading formula which are constant for
+ * one #RasterRenderer::GenerateSlopeImage() call.
+ */
+struct SlopeShadingParameters {
+  /**
+   * The light source vector, scaled to 255.
+   */
+  int sx, sy, sz;
+
+  int contrast;
+
+  /**
+   * Scale factor for the vertical component of the surface normal.
+   * Must be small enough to avoid integer overflows, see
+   * RasterRenderer::GenerateSlopeImage().
+   */
+  unsigned height_slope_factor;
+};
+
+/**
+ * Clip the difference between two adjacent terrain height values to
+ * sane bounds.  This works around integer overflows in the
+ * GenerateSlopeImage() formula when the map file is broken, avoiding
+ * the sqrt() call with a negative argument.
+ */
+gcc_const
+static inline int
+ClipHeightDelta(int d)
+{
+  return Clamp(d, -512, 512);
+}
+
+/**
+ * Calculate the illumination index (-63..63) of one terrain pixel.
+ * This is the reference implementation; the vectorised row kernels
+ * must produce exactly the same results.
+ *
+ * @param p20 the horizontal distance between #h_left and #h_right
+ * @param p31 the vertical distance between #h_above and #h_below
+ */
+gcc_pure
+static inline int
+CalcSlopeShading(int h_above, int h_below, int h_left, int h_right,
+                 unsigned p20, unsigned p31,
+                 const SlopeShadingParameters &p)
+{
+  const int p32 = ClipHeightDelta(h_above - h_below);
+  const int p22 = ClipHeightDelta(h_right - h_left);
+
+  const int dd0 = p22 * int(p31);
+  const int dd1 = int(p20) * p32;
+  const unsigned dd2 = p20 * p31 * p.height_slope_factor;
+  const int num = (int(dd2) * p.sz + dd0 * p.sx + dd1 * p.sy);
+  const unsigned square_mag = dd0 * dd0 + dd1 * dd1 + dd2 * dd2;
+  const unsigned mag = (unsigned)sqrt((fixed)square_mag);
+  /* this is a workaround for a SIGFPE (division by zero)
+     observed by our users on some Android devices (e.g. Nexus
+     7), even though we did our best to make sure that the
+     integer arithmetics above can't overflow */
+  /* TODO: debug this problem and replace this workaround */
+  const int sval = num / int(mag|1);
+  const int sindex = (sval - p.sz) * p.contrast / 128;
+  return Clamp(sindex, -63, 63);
+}
+
+/**
+ * Calculate the illumination index of a row of terrain pixels, where
+ * the horizontal neighbours of each pixel are #distance columns
+ * away.  The caller is responsible for checking the pixels and their
+ * neighbours for "special" values; the result for those is
+ * undefined.
+ *
+ * This is the portable reference implementation.
+ *
+ * @param dest the destination buffer for #n illumination indexes
+ * @param above the row above #src
+ * @param src the first pixel; the pixels #distance columns left of
+ * it and #distance columns right of the last one must be readable
+ * @param below the row below #src
+ * @param distance the horizontal step size (1..25)
+ * @param p31 the vertical distance between #above and #below
+ * (1..50)
+ */
+void
+CalcSlopeShadingRowScalar(signed char *gcc_restrict dest,
+                          const short *above, const short *src,
+                          const short *below,
+                          unsigned distance, unsigned p31, unsigned n,
+                          const SlopeShadingParameters &p);
+
+/**
+ * Same as CalcSlopeShadingRowScalar(), but use SSE2 or NEON
+ * instructions if available.
+ */
+void
+CalcSlopeShadingRow(signed char *gcc_restrict dest,
+                    const short *above, const short *src,
+                    const short *below,
+                    unsigned distance, unsigned p31, unsigned n,
+                    const SlopeShadingParameters &p);
+
+#endif
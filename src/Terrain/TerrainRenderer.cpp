@@ -348,7 +348,12 @@ TerrainRenderer::Generate(const WindowProjection &map_projection,
   compare_projection = CompareProjection(map_projection);
 #endif
 
-  terrain_serial = terrain.GetSerial();
+  if (terrain_serial != terrain.GetSerial()) {
+    /* new tiles have been loaded: the previous height matrix cannot
+       be reused */
+    raster_renderer.Invalidate();
+    terrain_serial = terrain.GetSerial();
+  }
 
   last_sun_azimuth = sunazimuth;
 
@@ -25,6 +25,7 @@ Copyright_License {
 #include "RasterTerrain.hpp"
 #include "Projection/WindowProjection.hpp"
 #include "Thread/Util.hpp"
+#include "Profiler/Profiler.hpp"
 
 TerrainThread::TerrainThread(RasterTerrain &_terrain,
                              std::function<void()> &&_callback)
@@ -32,7 +33,8 @@ TerrainThread::TerrainThread(RasterTerrain &_terrain,
    callback(std::move(_callback)) {}
 
 void
-TerrainThread::Trigger(const WindowProjection &projection)
+TerrainThread::Trigger(const WindowProjection &projection,
+                       const TerrainPrefetch &prefetch)
 {
   assert(projection.IsValid());
 
@@ -41,11 +43,13 @@ TerrainThread::Trigger(const WindowProjection &projection)
   GeoPoint center = projection.GetGeoScreenCenter();
   auto radius = projection.GetScreenWidthMeters() / 2;
   if (last_center.IsValid() && last_radius >= radius &&
-      last_center.DistanceS(center) < fixed(1000))
+      last_center.DistanceS(center) < fixed(1000) &&
+      last_prefetch.IsClose(prefetch, fixed(1000)))
     return;
 
   next_center = center;
   next_radius = radius;
+  next_prefetch = prefetch;
   StandbyThread::Trigger();
 }
 
@@ -53,19 +57,23 @@ void
 TerrainThread::Tick()
 {
   SetIdlePriority(); // TODO: call only once
+  Profiler::RegisterThread("TerrainThread");
 
   bool again = true;
   while (next_center.IsValid() && again && !IsStopped()) {
     const GeoPoint center = next_center;
     const auto radius = next_radius;
+    const TerrainPrefetch prefetch = next_prefetch;
 
     {
       const ScopeUnlock unlock(mutex);
-      again = terrain.UpdateTiles(center, radius);
+      const ProfileScope scope("UpdateTiles");
+      again = terrain.UpdateTiles(center, radius, prefetch);
     }
 
     last_center = center;
     last_radius = radius;
+    last_prefetch = prefetch;
   }
 
   /* notify the client */
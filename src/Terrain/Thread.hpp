@@ -26,6 +26,7 @@ Copyright_License {
 
 #include "Thread/StandbyThread.hpp"
 #include "Geo/GeoPoint.hpp"
+#include "Prefetch.hpp"
 
 #include <functional>
 
@@ -43,15 +44,23 @@ class TerrainThread final : private StandbyThread {
   GeoPoint last_center = GeoPoint::Invalid();
   fixed last_radius;
 
+  TerrainPrefetch last_prefetch = TerrainPrefetch::Invalid();
+
   GeoPoint next_center;
   fixed next_radius;
+  TerrainPrefetch next_prefetch = TerrainPrefetch::Invalid();
 
 public:
   TerrainThread(RasterTerrain &_terrain, std::function<void()> &&_callback);
 
   using StandbyThread::LockStop;
 
-  void Trigger(const WindowProjection &projection);
+  /**
+   * @param prefetch the predicted flight path; tiles along this path
+   * are loaded before the ones on the screen
+   */
+  void Trigger(const WindowProjection &projection,
+               const TerrainPrefetch &prefetch=TerrainPrefetch::Invalid());
 
 private:
   /* virtual methods from class StandbyThread*/
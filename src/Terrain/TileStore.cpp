@@ -0,0 +1,114 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "TileStore.hpp"
+
+extern "C" {
+#include "jasper/jas_seq.h"
+}
+
+#include <algorithm>
+
+#include <string.h>
+
+void
+TileStoreWriter::SetSize(unsigned _tile_columns, unsigned _tile_rows)
+{
+  tile_columns = _tile_columns;
+  tile_rows = _tile_rows;
+
+  index.ResizeDiscard(tile_columns * tile_rows);
+  std::fill(index.begin(), index.end(), TileStoreEntry());
+}
+
+void
+TileStoreWriter::PutTile(unsigned i, unsigned start_x, unsigned start_y,
+                         const struct jas_matrix &m)
+{
+  if (error || i >= index.size())
+    return;
+
+  const unsigned width = m.numcols_, height = m.numrows_;
+  if (width == 0 || height == 0 || width > 0xffff || height > 0xffff)
+    return;
+
+  /* align the tile data */
+  long position = ftell(file);
+  if (position < 0) {
+    error = true;
+    return;
+  }
+
+  static constexpr char padding[TileStoreTrailer::ALIGNMENT] = {};
+  const unsigned misalignment = position % TileStoreTrailer::ALIGNMENT;
+  if (misalignment > 0) {
+    const unsigned n = TileStoreTrailer::ALIGNMENT - misalignment;
+    if (fwrite(padding, 1, n, file) != n) {
+      error = true;
+      return;
+    }
+
+    position += n;
+  }
+
+  row.GrowDiscard(width);
+
+  for (unsigned y = 0; y != height; ++y) {
+    std::copy_n(m.rows_[y], width, row.begin());
+    if (fwrite(row.begin(), sizeof(*row.begin()), width, file) != width) {
+      error = true;
+      return;
+    }
+  }
+
+  TileStoreEntry &entry = index[i];
+  entry.offset = position;
+  entry.xstart = start_x;
+  entry.ystart = start_y;
+  entry.width = width;
+  entry.height = height;
+}
+
+bool
+TileStoreWriter::Finish()
+{
+  if (error || index.empty())
+    return false;
+
+  const long position = ftell(file);
+  if (position < 0)
+    return false;
+
+  TileStoreTrailer trailer;
+  /* zero-fill all implicit padding bytes (to make valgrind happy) */
+  memset(&trailer, 0, sizeof(trailer));
+  trailer.index_offset = position;
+  trailer.tile_columns = tile_columns;
+  trailer.tile_rows = tile_rows;
+  trailer.version = TileStoreTrailer::VERSION;
+  trailer.magic = TileStoreTrailer::MAGIC;
+
+  return fwrite(index.begin(), sizeof(*index.begin()), index.size(),
+                file) == index.size() &&
+    fwrite(&trailer, sizeof(trailer), 1, file) == 1;
+}
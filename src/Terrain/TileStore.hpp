@@ -0,0 +1,104 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_TILE_STORE_HPP
+#define XCSOAR_TERRAIN_TILE_STORE_HPP
+
+#include "Util/AllocatedArray.hpp"
+
+#include <stdio.h>
+#include <stdint.h>
+
+struct jas_matrix;
+
+/*
+ * The "tile store" is an optional sidecar of the terrain cache.  It
+ * contains all tiles of the JPEG2000 file, already decoded to raw
+ * 16 bit heights, and can be mapped into memory instead of decoding
+ * tiles on demand.
+ *
+ * File layout: the tile data (each tile aligned to
+ * TileStoreTrailer::ALIGNMENT), followed by one #TileStoreEntry for
+ * each tile, followed by the #TileStoreTrailer.  All offsets are
+ * absolute file offsets.
+ */
+
+struct TileStoreEntry {
+  /**
+   * The position of the tile data within the file.  0 means the
+   * tile was not decoded.
+   */
+  uint32_t offset;
+
+  uint32_t xstart, ystart;
+  uint16_t width, height;
+};
+
+struct TileStoreTrailer {
+  static constexpr uint32_t MAGIC = 0x54534d58;
+  static constexpr uint32_t VERSION = 1;
+  static constexpr unsigned ALIGNMENT = 16;
+
+  uint32_t index_offset;
+  uint32_t tile_columns, tile_rows;
+  uint32_t version;
+  uint32_t magic;
+};
+
+/**
+ * Writes a tile store while the JPEG2000 file is being scanned by
+ * the #TerrainLoader.
+ */
+class TileStoreWriter {
+  FILE *const file;
+
+  AllocatedArray<TileStoreEntry> index;
+  unsigned tile_columns = 0, tile_rows = 0;
+
+  /**
+   * Buffer for converting one row of a jasper matrix.
+   */
+  AllocatedArray<short> row;
+
+  bool error = false;
+
+public:
+  explicit TileStoreWriter(FILE *_file):file(_file) {}
+
+  TileStoreWriter(const TileStoreWriter &) = delete;
+  TileStoreWriter &operator=(const TileStoreWriter &) = delete;
+
+  void SetSize(unsigned tile_columns, unsigned tile_rows);
+
+  void PutTile(unsigned index, unsigned start_x, unsigned start_y,
+               const struct jas_matrix &m);
+
+  /**
+   * Write the index and the trailer.
+   *
+   * @return false if an I/O error has occurred at any time
+   */
+  bool Finish();
+};
+
+#endif
@@ -199,6 +199,9 @@ WeatherTerrainRenderer::Generate(const WindowProjection &projection,
     last_color_ramp = color_ramp;
   }
 
+  /* the weather map may have been reloaded since the last call, so
+     its old values cannot be reused */
+  raster_renderer.Invalidate();
   raster_renderer.ScanMap(*map, projection);
 
   raster_renderer.GenerateImage(do_shading, height_scale,
@@ -0,0 +1,204 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Parallel.hpp"
+#include "Thread.hpp"
+#include "Mutex.hpp"
+#include "Cond.hxx"
+#include "Util/AllocatedArray.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#ifdef HAVE_POSIX
+#include <unistd.h>
+#else
+#include <windows.h>
+#endif
+
+unsigned
+GetCPUCount()
+{
+#ifdef HAVE_POSIX
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 1 ? (unsigned)n : 1;
+#else
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwNumberOfProcessors > 1 ? info.dwNumberOfProcessors : 1;
+#endif
+}
+
+/**
+ * One RunParallel() call.  All attributes except for #f and #n are
+ * protected by ParallelPool::mutex.
+ */
+struct ParallelJob {
+  const std::function<void(unsigned)> &f;
+  const unsigned n;
+
+  /**
+   * The next index which has not been claimed yet.
+   */
+  unsigned next;
+
+  /**
+   * The number of indexes whose function call has returned.
+   */
+  unsigned finished;
+
+  /**
+   * Signalled when #finished reaches #n.
+   */
+  Cond cond;
+
+  ParallelJob(const std::function<void(unsigned)> &_f, unsigned _n)
+    :f(_f), n(_n), next(0), finished(0) {}
+};
+
+/**
+ * A set of worker threads which is created on the first
+ * RunParallel() call and lives until the process exits.
+ */
+class ParallelPool {
+  class Worker final : public Thread {
+    ParallelPool *pool;
+
+  public:
+    Worker():Thread("Parallel") {}
+
+    bool Start(ParallelPool &_pool) {
+      pool = &_pool;
+      return Thread::Start();
+    }
+
+  protected:
+    /* virtual methods from class Thread */
+    void Run() override {
+      pool->Work();
+    }
+  };
+
+  Mutex mutex;
+
+  /**
+   * Wakes up the workers when a job has been added or when they shall
+   * stop.
+   */
+  Cond cond;
+
+  /**
+   * The jobs which have indexes that have not been claimed yet.
+   */
+  std::vector<ParallelJob *> jobs;
+
+  bool stop;
+
+  AllocatedArray<Worker> workers;
+
+public:
+  /**
+   * @param n_workers the number of worker threads; the thread
+   * calling Run() takes part in the job as well
+   */
+  explicit ParallelPool(unsigned n_workers)
+    :stop(false), workers(n_workers) {
+    for (auto &worker : workers)
+      worker.Start(*this);
+  }
+
+  ~ParallelPool() {
+    mutex.Lock();
+    stop = true;
+    cond.broadcast();
+    mutex.Unlock();
+
+    for (auto &worker : workers)
+      if (worker.IsDefined())
+        worker.Join();
+  }
+
+  void Run(ParallelJob &job) {
+    const ScopeLock protect(mutex);
+
+    jobs.push_back(&job);
+    cond.broadcast();
+
+    /* the calling thread works on its own job, and waits only for
+       the indexes which have been claimed by others; therefore a
+       function may call RunParallel() again without deadlocking, even
+       if all workers are busy */
+    while (job.next < job.n)
+      RunNext(job);
+
+    while (job.finished < job.n)
+      job.cond.wait(mutex);
+  }
+
+private:
+  /**
+   * Claim the next index of the given job and call the function
+   * with the mutex unlocked.  The caller must hold the mutex.
+   */
+  void RunNext(ParallelJob &job) {
+    const unsigned index = job.next++;
+    if (job.next == job.n)
+      /* all indexes are claimed; the job is done as soon as they
+         return */
+      jobs.erase(std::find(jobs.begin(), jobs.end(), &job));
+
+    {
+      const ScopeUnlock unlock(mutex);
+      job.f(index);
+    }
+
+    if (++job.finished == job.n)
+      job.cond.signal();
+  }
+
+  void Work() {
+    const ScopeLock protect(mutex);
+
+    while (!stop) {
+      if (jobs.empty())
+        cond.wait(mutex);
+      else
+        RunNext(*jobs.front());
+    }
+  }
+};
+
+void
+RunParallel(unsigned n, const std::function<void(unsigned index)> &f)
+{
+  if (n <= 1) {
+    if (n == 1)
+      f(0);
+    return;
+  }
+
+  static ParallelPool pool(GetCPUCount() - 1);
+
+  ParallelJob job(f, n);
+  pool.Run(job);
+}
@@ -0,0 +1,54 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_THREAD_PARALLEL_HPP
+#define XCSOAR_THREAD_PARALLEL_HPP
+
+#include "Compiler.h"
+
+#include <functional>
+
+/**
+ * Determine the number of CPU cores which are online.
+ *
+ * @return the number of cores, at least 1
+ */
+gcc_pure
+unsigned
+GetCPUCount();
+
+/**
+ * Invoke the function once for each index in the range [0,n), and
+ * wait until all of them have returned.  The indexes are distributed
+ * over a pool of GetCPUCount()-1 worker threads, which is created on
+ * the first call and reused by all later ones, and the calling
+ * thread.  The indexes are independent: there is no guarantee which
+ * thread handles an index, or that two indexes run concurrently.
+ *
+ * The function may call RunParallel() again; the nested call does
+ * not block waiting for a free worker.
+ */
+void
+RunParallel(unsigned n, const std::function<void(unsigned index)> &f);
+
+#endif
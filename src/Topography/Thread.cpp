@@ -24,6 +24,22 @@ Copyright_License {
 #include "Thread.hpp"
 #include "TopographyStore.hpp"
 #include "Thread/Util.hpp"
+#include "Thread/Parallel.hpp"
+#include "Profiler/Profiler.hpp"
+
+#include <algorithm>
+
+/**
+ * The maximum number of threads updating topography files
+ * concurrently.
+ */
+static constexpr unsigned MAX_UPDATE_THREADS = 4;
+
+/**
+ * After this many milliseconds, the client is notified about the
+ * files loaded so far, before the remaining files are updated.
+ */
+static constexpr unsigned UPDATE_BUDGET_MS = 150;
 
 TopographyThread::TopographyThread(TopographyStore &_store,
                                    std::function<void()> &&_callback)
@@ -68,18 +84,27 @@ TopographyThread::Tick()
 {
   // TODO: call only once
   SetIdlePriority();
+  Profiler::RegisterThread("TopographyThread");
+
+  const unsigned n_threads = std::min(GetCPUCount(), MAX_UPDATE_THREADS);
 
   bool again = true;
   while (next_projection.IsValid() && again && !IsStopped()) {
     const WindowProjection projection = next_projection;
 
     const ScopeUnlock unlock(mutex);
-    again = store.ScanVisibility(projection, 1) > 0;
-  }
 
-  /* notify the client that we have updated the topography cache */
-  if (callback) {
-    const ScopeUnlock unlock(mutex);
-    callback();
+    {
+      const ProfileScope scope("ScanVisibility");
+      again = store.ScanVisibilityParallel(projection, n_threads,
+                                           UPDATE_BUDGET_MS) > 0;
+    }
+
+    /* notify the client that we have updated the topography cache;
+       do this after each round, so the layers which were loaded
+       within the budget are drawn while the others are still
+       loading */
+    if (again && callback)
+      callback();
   }
 }
@@ -25,11 +25,30 @@ Copyright_License {
 #include "Topography/XShape.hpp"
 #include "Convert.hpp"
 #include "Projection/WindowProjection.hpp"
+#include "Geo/FAISphere.hpp"
 
 #include <zzip/lib.h>
 
 #include <algorithm>
 #include <stdlib.h>
+#include <math.h>
+
+/**
+ * The resolution of the spatial index: 1/100000 degree, which is
+ * about one metre.
+ */
+static constexpr double INDEX_SCALE = 100000;
+
+gcc_const
+static FlatBoundingBox
+ToIndexBox(const rectObj &rect)
+{
+  /* round outwards, so the index never misses a shape */
+  return FlatBoundingBox(FlatGeoPoint((int)floor(rect.minx * INDEX_SCALE),
+                                      (int)floor(rect.miny * INDEX_SCALE)),
+                         FlatGeoPoint((int)ceil(rect.maxx * INDEX_SCALE),
+                                      (int)ceil(rect.maxy * INDEX_SCALE)));
+}
 
 TopographyFile::TopographyFile(zzip_dir *_dir, const char *filename,
                                fixed _threshold,
@@ -38,10 +57,11 @@ TopographyFile::TopographyFile(zzip_dir *_dir, const char *filename,
                                const Color _color,
                                int _label_field,
                                ResourceId _icon, ResourceId _big_icon,
-                               unsigned _pen_width)
+                               unsigned _pen_width,
+                               unsigned _pixel_scale)
   :dir(_dir), first(nullptr),
    label_field(_label_field), icon(_icon), big_icon(_big_icon),
-   pen_width(_pen_width),
+   pen_width(_pen_width), pixel_scale(_pixel_scale),
    color(_color), scale_threshold(_threshold),
    label_threshold(_label_threshold),
    important_label_threshold(_important_label_threshold),
@@ -60,6 +80,17 @@ TopographyFile::TopographyFile(zzip_dir *_dir, const char *filename,
   shapes.ResizeDiscard(file.numshapes);
   std::fill(shapes.begin(), shapes.end(), ShapeList(nullptr));
 
+  std::vector<ShapeBounds> bounds;
+  bounds.reserve(file.numshapes);
+  for (int i = 0; i < file.numshapes; ++i) {
+    rectObj rect;
+    if (msSHPReadBounds(file.hSHP, i, &rect) == MS_SUCCESS)
+      /* null and empty shapes are never loaded */
+      bounds.push_back({ToIndexBox(rect), unsigned(i)});
+  }
+
+  index.Load(std::move(bounds));
+
   if (dir != nullptr)
     ++dir->refcount;
 
@@ -84,18 +115,38 @@ void
 TopographyFile::ClearCache()
 {
   for (auto i = shapes.begin(), end = shapes.end(); i != end; ++i) {
-    delete i->shape;
-    i->shape = nullptr;
+    if (i->shape != nullptr) {
+      FreeShape(i->shape);
+      i->shape = nullptr;
+    }
   }
 
   first = nullptr;
 }
 
-static XShape *
-LoadShape(shapefileObj *file, const GeoPoint &center, int i,
-          int label_field)
+const XShape *
+TopographyFile::LoadShape(unsigned i)
 {
-  return new XShape(file, center, i, label_field);
+  XShape *shape = allocator.allocate(1);
+#ifdef ENABLE_OPENGL
+  ShapeScalar thinning_distances[XShape::THINNING_LEVELS];
+  for (unsigned level = 0; level < XShape::THINNING_LEVELS; ++level)
+    thinning_distances[level] = GetThinningDistance(level);
+
+  allocator.construct(shape, &file, center, int(i), label_field,
+                      (const ShapeScalar *)thinning_distances);
+#else
+  allocator.construct(shape, &file, center, int(i), label_field);
+#endif
+  return shape;
+}
+
+void
+TopographyFile::FreeShape(const XShape *_shape)
+{
+  XShape *shape = const_cast<XShape *>(_shape);
+  allocator.destroy(shape);
+  allocator.deallocate(shape, 1);
 }
 
 bool
@@ -116,69 +167,70 @@ TopographyFile::Update(const WindowProjection &map_projection)
 
   cache_bounds = screenRect.Scale(fixed(2));
 
-  rectObj deg_bounds = ConvertRect(cache_bounds);
-
-  // Test which shapes are inside the given bounds and save the
-  // status to file.status
-  switch (msShapefileWhichShapes(&file, dir, deg_bounds, 0)) {
-  case MS_FAILURE:
-    ClearCache();
-    return false;
-
-  case MS_DONE:
+  const rectObj deg_bounds = ConvertRect(cache_bounds);
+  if (msRectOverlap(&file.bounds, &deg_bounds) != MS_TRUE)
     /* screen is outside of map bounds */
     return false;
 
-  case MS_SUCCESS:
-    break;
-  }
+  /* collect the shapes inside the given bounds, in file order */
+  visible.clear();
+  index.VisitWithinRange(ToIndexBox(deg_bounds), 0,
+                         [this](const ShapeBounds &b){
+                           visible.push_back(b.index);
+                         });
+  std::sort(visible.begin(), visible.end());
+
+  /* merge the sorted list of visible shapes into the linked list,
+     which is in file order, too; shapes which are neither in the
+     list nor visible are not touched at all */
+  const ShapeList **current = &first;
+  auto v = visible.begin();
+  const auto v_end = visible.end();
+  while (*current != nullptr || v != v_end) {
+    const unsigned current_index = *current != nullptr
+      ? unsigned(*current - shapes.begin())
+      : unsigned(file.numshapes);
+
+    if (v != v_end && *v < current_index) {
+      // shape isn't cached yet -> cache the shape
+      ShapeList &item = shapes[*v];
+      assert(item.shape == nullptr);
 
-  assert(file.status != nullptr);
+      item.shape = LoadShape(*v);
+      item.next = *current;
 
-  // Iterate through the shapefile entries
-  const ShapeList **current = &first;
-  auto it = shapes.begin();
-  for (int i = 0; i < file.numshapes; ++i, ++it) {
-    if (!msGetBit(file.status, i)) {
-      // If the shape is outside the bounds
-      // delete the shape from the cache
-      if (it->shape != nullptr) {
-        assert(*current == it);
-
-        /* remove from linked list (protected) */
-        {
-          const ScopeLock lock(mutex);
-          *current = it->next;
-          ++serial;
-        }
-
-        /* now it's unreachable, and we can delete the XShape without
-           holding a lock */
-        delete it->shape;
-        it->shape = nullptr;
+      /* insert into linked list (protected) */
+      {
+        const ScopeLock lock(mutex);
+        *current = &item;
+        ++serial;
       }
+
+      current = &item.next;
+      ++v;
+    } else if (v != v_end && *v == current_index) {
+      // is inside the bounds and already cached
+      current = &shapes[current_index].next;
+      ++v;
     } else {
-      // is inside the bounds
-      if (it->shape == nullptr) {
-        assert(*current != it);
-
-        // shape isn't cached yet -> cache the shape
-        it->shape = LoadShape(&file, center, i, label_field);
-        it->next = *current;
-
-        /* insert into linked list (protected) */
-        {
-          const ScopeLock lock(mutex);
-          *current = it;
-          ++serial;
-        }
+      // If the shape is outside the bounds
+      // delete the shape from the cache
+      ShapeList &item = shapes[current_index];
+      assert(*current == &item);
+
+      /* remove from linked list (protected) */
+      {
+        const ScopeLock lock(mutex);
+        *current = item.next;
+        ++serial;
       }
 
-      current = &it->next;
+      /* now it's unreachable, and we can delete the XShape without
+         holding a lock */
+      FreeShape(item.shape);
+      item.shape = nullptr;
     }
   }
-  // end of list marker
-  assert(*current == nullptr);
 
   return true;
 }
@@ -192,7 +244,7 @@ TopographyFile::LoadAll()
   for (int i = 0; i < file.numshapes; ++i, ++it) {
     if (it->shape == nullptr)
       // shape isn't cached yet -> cache the shape
-      it->shape = LoadShape(&file, center, i, label_field);
+      it->shape = LoadShape(i);
     // update list pointer
     *current = it;
     current = &it->next;
@@ -244,4 +296,11 @@ TopographyFile::GetMinimumPointDistance(unsigned level) const
   return 1;
 }
 
+ShapeScalar
+TopographyFile::GetThinningDistance(unsigned level) const
+{
+  return ShapeScalar(GetMinimumPointDistance(level))
+    / (pixel_scale * FAISphere::REARTH);
+}
+
 #endif
@@ -27,7 +27,9 @@ Copyright_License {
 
 #include "shapelib/mapserver.h"
 #include "Geo/GeoBounds.hpp"
+#include "Geo/Flat/PackedRTree.hpp"
 #include "Util/AllocatedArray.hpp"
+#include "Util/SliceAllocator.hpp"
 #include "Util/Serial.hpp"
 #include "Math/fixed.hpp"
 #include "Screen/Color.hpp"
@@ -39,6 +41,7 @@ Copyright_License {
 #endif
 
 #include <forward_list>
+#include <vector>
 
 #include <assert.h>
 
@@ -56,6 +59,20 @@ class TopographyFile {
     ShapeList(const XShape *_shape):shape(_shape) {}
   };
 
+  /**
+   * The bounds of one shape in the #index.  The coordinates are
+   * fixed-point degrees, see ToIndexBox().
+   */
+  struct ShapeBounds {
+    FlatBoundingBox box;
+
+    unsigned index;
+
+    operator const FlatBoundingBox &() const {
+      return box;
+    }
+  };
+
   /**
    * This gets incremented by Update().
    */
@@ -73,12 +90,37 @@ class TopographyFile {
   AllocatedArray<ShapeList> shapes;
   const ShapeList *first;
 
+  /**
+   * A spatial index of all shapes, built from the .shx/.shp record
+   * bounds when the file is opened.  Update() uses it to find the
+   * shapes inside the new cache rectangle without scanning the
+   * whole file.
+   */
+  PackedRTree<ShapeBounds> index;
+
+  /**
+   * Scratch buffer for Update(): the sorted indices of the shapes
+   * inside the cache rectangle.
+   */
+  std::vector<unsigned> visible;
+
+  /**
+   * All #XShape objects of this file are allocated here.
+   */
+  SliceAllocator<XShape, 256u> allocator;
+
   const int label_field;
 
   const ResourceId icon, big_icon;
 
   const unsigned pen_width;
 
+  /**
+   * The number of physical pixels per layout pixel, see
+   * GetThinningDistance().
+   */
+  const unsigned pixel_scale;
+
   const Color color;
 
   /**
@@ -163,6 +205,7 @@ public:
    * @param label_threshold the zoom threshold for label rendering
    * @param important_label_threshold labels below this zoom threshold will
    * be rendered in default style
+   * @param pixel_scale the number of physical pixels per layout pixel
    * @return
    */
   TopographyFile(zzip_dir *dir, const char *shpname,
@@ -172,7 +215,8 @@ public:
                  int label_field=-1,
                  ResourceId icon=ResourceId::Null(),
                  ResourceId big_icon=ResourceId::Null(),
-                 unsigned pen_width=1);
+                 unsigned pen_width=1,
+                 unsigned pixel_scale=1);
 
   TopographyFile(const TopographyFile &) = delete;
 
@@ -195,6 +239,14 @@ public:
     return shapes.empty();
   }
 
+  /**
+   * Returns the total number of shapes in the file, which is a rough
+   * estimate of the cost of updating it.
+   */
+  unsigned GetShapeCount() const {
+    return shapes.size();
+  }
+
   bool IsVisible(fixed map_scale) const {
     return map_scale <= scale_threshold;
   }
@@ -278,6 +330,14 @@ public:
    */
   gcc_pure
   unsigned GetMinimumPointDistance(unsigned level) const;
+
+  /**
+   * @return the minimum distance between points in ShapePoint
+   * coordinates; the thinned geometry of each level is generated
+   * with this distance when a shape is loaded
+   */
+  gcc_pure
+  ShapeScalar GetThinningDistance(unsigned level) const;
 #endif
 
   /**
@@ -292,6 +352,10 @@ public:
 
 protected:
   void ClearCache();
+
+private:
+  const XShape *LoadShape(unsigned i);
+  void FreeShape(const XShape *shape);
 };
 
 #endif
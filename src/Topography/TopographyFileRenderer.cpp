@@ -29,12 +29,10 @@ Copyright_License {
 #include "Projection/WindowProjection.hpp"
 #include "Screen/Canvas.hpp"
 #include "Screen/Features.hpp"
-#include "Screen/Layout.hpp"
 #include "shapelib/mapserver.h"
 #include "Util/AllocatedArray.hpp"
 #include "Util/tstring.hpp"
 #include "Geo/GeoClip.hpp"
-#include "Geo/FAISphere.hpp"
 
 #ifdef ENABLE_OPENGL
 #include "Screen/OpenGL/VertexPointer.hpp"
@@ -236,9 +234,7 @@ TopographyFileRenderer::Paint(Canvas &canvas,
 
 #ifdef ENABLE_OPENGL
   const unsigned level = file.GetThinningLevel(map_scale);
-  const ShapeScalar min_distance =
-    ShapeScalar(file.GetMinimumPointDistance(level))
-    / (Layout::Scale(1) * FAISphere::REARTH);
+  const ShapeScalar min_distance = file.GetThinningDistance(level);
 
 #ifdef HAVE_GLES
   const float *const opengl_matrix = nullptr;
@@ -27,12 +27,15 @@ Copyright_License {
 #include "Profile/Profile.hpp"
 #include "LogFile.hpp"
 #include "Operation/Operation.hpp"
-#include "IO/MapFile.hpp"
+#include "OS/ConvertPathName.hpp"
+#include "Screen/Layout.hpp"
 #include "IO/ZipLineReader.hpp"
 #include "Util/Error.hxx"
 
 #include <zzip/zzip.h>
 
+#include <windef.h> /* for MAX_PATH */
+
 /**
  * Load topography from the map file (ZIP), load the other files from
  * the same ZIP file.
@@ -41,7 +44,12 @@ static bool
 LoadConfiguredTopographyZip(TopographyStore &store,
                             OperationEnvironment &operation)
 {
-  auto dir = OpenMapFile();
+  TCHAR path[MAX_PATH];
+  if (!Profile::GetPath(ProfileKeys::MapFile, path))
+    return false;
+
+  const NarrowPathName narrow_path(path);
+  auto dir = zzip_dir_open(narrow_path, nullptr);
   if (dir == nullptr)
     return false;
 
@@ -52,7 +60,8 @@ LoadConfiguredTopographyZip(TopographyStore &store,
     return false;
   }
 
-  store.Load(operation, reader, nullptr, dir);
+  store.SetPixelScale(Layout::Scale(1));
+  store.Load(operation, reader, nullptr, dir, narrow_path);
   zzip_dir_close(dir);
   return true;
 }
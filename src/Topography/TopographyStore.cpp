@@ -29,10 +29,17 @@ Copyright_License {
 #include "IO/LineReader.hpp"
 #include "OS/PathName.hpp"
 #include "Operation/Operation.hpp"
+#include "Thread/Parallel.hpp"
+#include "Time/PeriodClock.hpp"
 #include "Compatibility/path.h"
 #include "Asset.hpp"
 #include "Resources.hpp"
 
+#include <zzip/lib.h>
+
+#include <algorithm>
+#include <atomic>
+
 #include <stdint.h>
 #include <windef.h> // for MAX_PATH
 
@@ -128,6 +135,46 @@ TopographyStore::ScanVisibility(const WindowProjection &m_projection,
   return num_updated;
 }
 
+unsigned
+TopographyStore::ScanVisibilityParallel(const WindowProjection &m_projection,
+                                        unsigned max_threads,
+                                        unsigned budget_ms)
+{
+  PeriodClock clock;
+  clock.Update();
+
+  std::atomic<unsigned> next(0), num_updated(0);
+
+  /* the workers of RunParallel()'s pool are shared with other
+     callers, so their priority is left alone */
+  const auto worker = [&](unsigned){
+    /* each worker picks the next file which has not been claimed
+       yet, until all files are done or the budget is exhausted; the
+       budget is only checked after an update, so a return value of
+       zero means that all files are up to date */
+    unsigned i;
+    while ((i = next.fetch_add(1)) < update_order.size()) {
+      if (files[update_order[i]]->Update(m_projection)) {
+        ++num_updated;
+
+        if (clock.Check(budget_ms))
+          break;
+      }
+    }
+  };
+
+  const unsigned n_threads = independent
+    ? std::min(max_threads, (unsigned)files.size())
+    : 1;
+  if (n_threads > 1)
+    RunParallel(n_threads, worker);
+  else
+    worker(0);
+
+  serial += num_updated;
+  return num_updated;
+}
+
 void
 TopographyStore::LoadAll()
 {
@@ -144,10 +191,13 @@ TopographyStore::~TopographyStore()
 
 void
 TopographyStore::Load(OperationEnvironment &operation, NLineReader &reader,
-                      const TCHAR *directory, struct zzip_dir *zdir)
+                      const TCHAR *directory, struct zzip_dir *zdir,
+                      const char *zip_path)
 {
   Reset();
 
+  independent = true;
+
   // Create buffer for the shape filenames
   // (shape_filename will be modified with the shape_filename_end pointer)
   char shape_filename[MAX_PATH];
@@ -280,8 +330,21 @@ TopographyStore::Load(OperationEnvironment &operation, NLineReader &reader,
 #endif
     }
 
+    /* give each file its own ZIP handle if possible, see
+       #independent */
+    struct zzip_dir *file_dir = zdir;
+    if (zdir != nullptr) {
+      if (zip_path != nullptr)
+        file_dir = zzip_dir_open(zip_path, nullptr);
+
+      if (file_dir == nullptr || file_dir == zdir) {
+        file_dir = zdir;
+        independent = false;
+      }
+    }
+
     // Create TopographyFile instance from parsed line
-    TopographyFile *file = new TopographyFile(zdir, shape_filename,
+    TopographyFile *file = new TopographyFile(file_dir, shape_filename,
                                               shape_range, label_range,
                                               labelImportantRange,
 #ifdef ENABLE_OPENGL
@@ -290,7 +353,7 @@ TopographyStore::Load(OperationEnvironment &operation, NLineReader &reader,
                                               Color(red, green, blue),
 #endif
                                               shape_field, icon, big_icon,
-                                              pen_width);
+                                              pen_width, pixel_scale);
     if (file->IsEmpty())
       // If the shape file could not be read -> skip this line/file
       delete file;
@@ -298,9 +361,23 @@ TopographyStore::Load(OperationEnvironment &operation, NLineReader &reader,
       // .. otherwise append it to our list of shape files
       files.append(file);
 
+    if (file_dir != zdir)
+      /* release our reference; the TopographyFile holds its own */
+      zzip_dir_close(file_dir);
+
     // Update progress bar
     operation.SetProgressPosition((reader.Tell() * 100) / filesize);
   }
+
+  update_order.clear();
+  for (unsigned i = 0; i < files.size(); ++i)
+    update_order.append(i);
+
+  std::stable_sort(update_order.begin(), update_order.end(),
+                   [this](unsigned a, unsigned b){
+                     return files[a]->GetShapeCount() <
+                       files[b]->GetShapeCount();
+                   });
 }
 
 void
@@ -310,4 +387,5 @@ TopographyStore::Reset()
     delete file;
 
   files.clear();
+  update_order.clear();
 }
@@ -48,13 +48,34 @@ public:
 private:
   StaticArray<TopographyFile *, MAXTOPOGRAPHY> files;
 
+  /**
+   * The indices of #files in the order they should be updated by
+   * ScanVisibilityParallel(): small layers (labels, major roads)
+   * first, so they appear before the full-detail layers.
+   */
+  StaticArray<unsigned, MAXTOPOGRAPHY> update_order;
+
+  /**
+   * Does each file have its own ZIP handle (or no ZIP file at all)?
+   * Only then may different files be updated concurrently, because
+   * libzzip shares the file descriptor and position of one
+   * #zzip_dir among all of its files.
+   */
+  bool independent;
+
+  /**
+   * The number of physical pixels per layout pixel, passed to each
+   * #TopographyFile.
+   */
+  unsigned pixel_scale;
+
   /**
    * This number is incremented each time this object is modified.
    */
   unsigned serial;
 
 public:
-  TopographyStore():serial(0) {}
+  TopographyStore():independent(true), pixel_scale(1), serial(0) {}
   ~TopographyStore();
 
   /**
@@ -87,14 +108,41 @@ public:
   unsigned ScanVisibility(const WindowProjection &m_projection,
                           unsigned max_update=1024);
 
+  /**
+   * Like ScanVisibility(), but update up to #max_threads files
+   * concurrently, on the worker threads of RunParallel().  After
+   * #budget_ms milliseconds, no new file update is started; the
+   * caller should draw what has been loaded so far and call this
+   * method again while it returns a positive value.
+   *
+   * @return the number of files which were updated
+   */
+  unsigned ScanVisibilityParallel(const WindowProjection &m_projection,
+                                  unsigned max_threads, unsigned budget_ms);
+
   /**
    * Load all shapes of all files into memory.  For debugging
    * purposes.
    */
   void LoadAll();
 
+  /**
+   * Set the number of physical pixels per layout pixel.  This
+   * affects how much the geometry of files loaded afterwards is
+   * thinned out.
+   */
+  void SetPixelScale(unsigned _pixel_scale) {
+    pixel_scale = _pixel_scale;
+  }
+
+  /**
+   * @param zip_path the path of the ZIP file #zdir was opened from;
+   * if given, each file opens its own handle, which allows updating
+   * them in parallel
+   */
   void Load(OperationEnvironment &operation, NLineReader &reader,
-            const TCHAR *directory, struct zzip_dir *zdir = nullptr);
+            const TCHAR *directory, struct zzip_dir *zdir = nullptr,
+            const char *zip_path = nullptr);
   void Reset();
 };
 
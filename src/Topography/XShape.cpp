@@ -38,8 +38,11 @@ Copyright_License {
 #endif
 
 #include <algorithm>
+#include <vector>
+#include <limits>
 
 #include <tchar.h>
+#include <assert.h>
 
 static AllocatedString<TCHAR>
 ImportLabel(const char *src)
@@ -88,12 +91,17 @@ GetMinPointsForShapeType(int shapelib_type)
 }
 
 XShape::XShape(shapefileObj *shpfile, const GeoPoint &file_center, int i,
-               int label_field)
+               int label_field
+#ifdef ENABLE_OPENGL
+               , const ShapeScalar *thinning_distances
+#endif
+               )
   :label(nullptr)
 {
 #ifdef ENABLE_OPENGL
   std::fill_n(index_count, THINNING_LEVELS, nullptr);
   std::fill_n(indices, THINNING_LEVELS, nullptr);
+  thinned_lines = nullptr;
 #endif
 
   shapeObj shape;
@@ -162,20 +170,161 @@ XShape::XShape(shapefileObj *shpfile, const GeoPoint &file_center, int i,
   }
 
   msFreeShape(&shape);
+
+#ifdef ENABLE_OPENGL
+  if (thinning_distances != nullptr && type == MS_SHAPE_LINE)
+    BuildThinnedLines(thinning_distances);
+#endif
 }
 
 XShape::~XShape()
 {
   delete[] points;
 #ifdef ENABLE_OPENGL
-  // Note: index_count and indices share one buffer
-  for (unsigned i = 0; i < THINNING_LEVELS; i++)
-    delete[] index_count[i];
+  if (thinned_lines != nullptr)
+    delete[] thinned_lines;
+  else
+    // Note: index_count and indices share one buffer
+    for (unsigned i = 0; i < THINNING_LEVELS; i++)
+      delete[] index_count[i];
 #endif
 }
 
 #ifdef ENABLE_OPENGL
 
+/**
+ * Returns the squared distance of point #p from the segment [a,b].
+ */
+gcc_pure
+static ShapeScalar
+SegmentDistanceSquared(ShapePoint p, ShapePoint a, ShapePoint b)
+{
+  const ShapeScalar dx = b.x - a.x, dy = b.y - a.y;
+  const ShapeScalar length_squared = dx * dx + dy * dy;
+
+  ShapeScalar t = length_squared > 0
+    ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / length_squared
+    : 0;
+  t = std::max(ShapeScalar(0), std::min(t, ShapeScalar(1)));
+
+  const ShapeScalar ex = a.x + t * dx - p.x, ey = a.y + t * dy - p.y;
+  return ex * ex + ey * ey;
+}
+
+/**
+ * Run the Douglas-Peucker algorithm on one line, and calculate the
+ * squared tolerance at which each point gets removed.  A point is
+ * part of the simplified line for tolerance e if its weight is at
+ * least e*e.  The first and the last point are always kept.
+ */
+static void
+CalculateDouglasPeuckerWeights(const ShapePoint *points, unsigned n,
+                               ShapeScalar *weights)
+{
+  assert(n >= 2);
+
+  constexpr ShapeScalar infinity = std::numeric_limits<ShapeScalar>::max();
+  weights[0] = weights[n - 1] = infinity;
+
+  struct Range {
+    unsigned first, last;
+
+    /**
+     * The weight of the point which split the parent range.  No
+     * point inside this range may be kept longer than that point.
+     */
+    ShapeScalar limit;
+  };
+
+  std::vector<Range> stack;
+  stack.push_back({0, n - 1, infinity});
+
+  while (!stack.empty()) {
+    const Range range = stack.back();
+    stack.pop_back();
+
+    if (range.last - range.first < 2)
+      continue;
+
+    unsigned split = range.first + 1;
+    ShapeScalar max_distance = -1;
+    for (unsigned i = range.first + 1; i < range.last; ++i) {
+      const ShapeScalar distance =
+        SegmentDistanceSquared(points[i], points[range.first],
+                               points[range.last]);
+      if (distance > max_distance) {
+        max_distance = distance;
+        split = i;
+      }
+    }
+
+    const ShapeScalar weight = std::min(max_distance, range.limit);
+    weights[split] = weight;
+
+    stack.push_back({range.first, split, weight});
+    stack.push_back({split, range.last, weight});
+  }
+}
+
+void
+XShape::BuildThinnedLines(const ShapeScalar *thinning_distances)
+{
+  assert(type == MS_SHAPE_LINE);
+  assert(thinned_lines == nullptr);
+
+  unsigned num_points = 0;
+  for (unsigned i = 0; i < num_lines; i++)
+    num_points += lines[i];
+
+  if (num_points <= 2)
+    /* line cannot be simplified */
+    return;
+
+  std::vector<ShapeScalar> weights(num_points);
+  const ShapePoint *p = points;
+  ShapeScalar *w = weights.data();
+  for (unsigned i = 0; i < num_lines; ++i) {
+    CalculateDouglasPeuckerWeights(p, lines[i], w);
+    p += lines[i];
+    w += lines[i];
+  }
+
+  /* level 0 is always drawn with all points; count the points of
+     all other levels to allocate one buffer for all of them */
+  ShapeScalar tolerance[THINNING_LEVELS];
+  unsigned buffer_size = 0;
+  for (unsigned level = 1; level < THINNING_LEVELS; ++level) {
+    tolerance[level] = thinning_distances[level] * thinning_distances[level];
+
+    buffer_size += num_lines;
+    for (ShapeScalar weight : weights)
+      if (weight >= tolerance[level])
+        ++buffer_size;
+  }
+
+  thinned_lines = new unsigned short[buffer_size];
+
+  unsigned short *dest = thinned_lines;
+  for (unsigned level = 1; level < THINNING_LEVELS; ++level) {
+    unsigned short *idx_count = index_count[level] = dest;
+    unsigned short *idx = indices[level] = dest + num_lines;
+
+    unsigned i = 0;
+    for (unsigned l = 0; l < num_lines; ++l) {
+      const unsigned short *const line_begin = idx;
+      for (const unsigned end = i + lines[l]; i < end; ++i)
+        if (weights[i] >= tolerance[level])
+          *idx++ = i;
+
+      *idx_count++ = idx - line_begin;
+    }
+
+    dest = idx;
+  }
+
+  assert(dest == thinned_lines + buffer_size);
+}
+
 bool
 XShape::BuildIndices(unsigned thinning_level, ShapeScalar min_distance)
 {
@@ -251,6 +400,11 @@ XShape::GetIndices(int thinning_level, ShapeScalar min_distance,
                    const unsigned short *&count) const
 {
   if (indices[thinning_level] == nullptr) {
+    if (thinned_lines != nullptr)
+      /* all thinned levels have been generated by the constructor;
+         this level is drawn with all points */
+      return nullptr;
+
     XShape &deconst = const_cast<XShape &>(*this);
     if (!deconst.BuildIndices(thinning_level, min_distance))
       return nullptr;
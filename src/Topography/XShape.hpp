@@ -39,11 +39,14 @@ Copyright_License {
 struct GeoPoint;
 
 class XShape {
-  static constexpr unsigned MAX_LINES = 32;
+public:
 #ifdef ENABLE_OPENGL
   static constexpr unsigned THINNING_LEVELS = 4;
 #endif
 
+private:
+  static constexpr unsigned MAX_LINES = 32;
+
   GeoBounds bounds;
 
   unsigned char type;
@@ -79,6 +82,13 @@ class XShape {
    */
   unsigned short *index_count[THINNING_LEVELS];
 
+  /**
+   * If the thinned lines were generated by the constructor, then
+   * this is the one buffer holding #index_count and #indices of all
+   * levels.  Otherwise, each level has its own buffer.
+   */
+  unsigned short *thinned_lines;
+
   /**
    * The start offset in the #GLArrayBuffer (vertex buffer object).
    * It is managed by #TopographyFileRenderer.
@@ -91,8 +101,18 @@ class XShape {
   AllocatedString<TCHAR> label;
 
 public:
+  /**
+   * @param thinning_distances the minimum point distance of each
+   * thinning level (OpenGL only); if not nullptr, the thinned
+   * geometry of lines is generated right away, instead of on the
+   * first GetIndices() call
+   */
   XShape(shapefileObj *shpfile, const GeoPoint &file_center, int i,
-         int label_field=-1);
+         int label_field=-1
+#ifdef ENABLE_OPENGL
+         , const ShapeScalar *thinning_distances=nullptr
+#endif
+         );
 
   XShape(const XShape &) = delete;
 
@@ -110,6 +130,12 @@ public:
 protected:
   bool BuildIndices(unsigned thinning_level, ShapeScalar min_distance);
 
+  /**
+   * Generate the thinned geometry of all levels of a line shape with
+   * the Douglas-Peucker algorithm, and store it in #thinned_lines.
+   */
+  void BuildThinnedLines(const ShapeScalar *thinning_distances);
+
 public:
   const unsigned short *GetIndices(int thinning_level,
                                    ShapeScalar min_distance,
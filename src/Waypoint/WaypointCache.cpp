@@ -0,0 +1,301 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "WaypointCache.hpp"
+#include "Engine/Waypoint/Waypoints.hpp"
+#include "IO/FileCache.hpp"
+#include "OS/FileUtil.hpp"
+
+#include <algorithm>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * Increment the version number whenever the file format changes.
+ */
+static constexpr uint32_t WAYPOINT_CACHE_MAGIC = 0x57505400 | 2;
+
+/**
+ * Sanity limit for the length of strings in the cache file.
+ */
+static constexpr uint32_t MAX_STRING_LENGTH = 1024 * 1024;
+
+struct WaypointCacheHeader {
+  uint32_t magic;
+  uint32_t record_size;
+  uint32_t count;
+  uint32_t path_length, terrain_path_length;
+
+  /**
+   * The size and the modification time of the terrain file, to
+   * detect a replaced file with the same path.  Both are zero without
+   * terrain.
+   */
+  uint64_t terrain_size, terrain_mtime;
+};
+
+static void
+GetTerrainIdentity(const TCHAR *terrain_path, uint64_t &size_r,
+                   uint64_t &mtime_r)
+{
+  if (terrain_path != nullptr) {
+    size_r = File::GetSize(terrain_path);
+    mtime_r = File::GetLastModification(terrain_path);
+  } else {
+    size_r = mtime_r = 0;
+  }
+}
+
+struct WaypointCacheRecord {
+  GeoPoint location;
+  fixed elevation;
+  unsigned original_id;
+  Runway runway;
+  RadioFrequency radio_frequency;
+  Waypoint::Type type;
+  Waypoint::Flags flags;
+};
+
+static bool
+WriteString(FILE *file, const TCHAR *value, size_t length)
+{
+  const uint32_t length32 = length;
+  return fwrite(&length32, sizeof(length32), 1, file) == 1 &&
+    fwrite(value, sizeof(*value), length, file) == length;
+}
+
+static bool
+WriteString(FILE *file, const tstring &value)
+{
+  return WriteString(file, value.data(), value.length());
+}
+
+static bool
+WriteStringList(FILE *file, const std::forward_list<tstring> &list)
+{
+  const uint32_t n = std::distance(list.begin(), list.end());
+  if (fwrite(&n, sizeof(n), 1, file) != 1)
+    return false;
+
+  for (const auto &i : list)
+    if (!WriteString(file, i))
+      return false;
+
+  return true;
+}
+
+static bool
+WriteWaypoint(FILE *file, const Waypoint &wp)
+{
+  WaypointCacheRecord record;
+  record.location = wp.location;
+  record.elevation = wp.elevation;
+  record.original_id = wp.original_id;
+  record.runway = wp.runway;
+  record.radio_frequency = wp.radio_frequency;
+  record.type = wp.type;
+  record.flags = wp.flags;
+
+  return fwrite(&record, sizeof(record), 1, file) == 1 &&
+    WriteString(file, wp.name) &&
+    WriteString(file, wp.comment) &&
+    WriteString(file, wp.details) &&
+    WriteStringList(file, wp.files_embed)
+#ifdef HAVE_RUN_FILE
+    && WriteStringList(file, wp.files_external)
+#endif
+    ;
+}
+
+static bool
+ReadString(FILE *file, tstring &value)
+{
+  uint32_t length;
+  if (fread(&length, sizeof(length), 1, file) != 1 ||
+      length > MAX_STRING_LENGTH)
+    return false;
+
+  value.resize(length);
+  return length == 0 ||
+    fread(&value[0], sizeof(value[0]), length, file) == length;
+}
+
+static bool
+ReadStringList(FILE *file, std::forward_list<tstring> &list)
+{
+  uint32_t n;
+  if (fread(&n, sizeof(n), 1, file) != 1)
+    return false;
+
+  /* preserve the order */
+  auto tail = list.before_begin();
+  for (uint32_t i = 0; i < n; ++i) {
+    tail = list.emplace_after(tail);
+    if (!ReadString(file, *tail))
+      return false;
+  }
+
+  return true;
+}
+
+static bool
+ReadWaypoint(FILE *file, Waypoint &wp)
+{
+  WaypointCacheRecord record;
+  if (fread(&record, sizeof(record), 1, file) != 1)
+    return false;
+
+  wp.location = record.location;
+  wp.elevation = record.elevation;
+  wp.original_id = record.original_id;
+  wp.runway = record.runway;
+  wp.radio_frequency = record.radio_frequency;
+  wp.type = record.type;
+  wp.flags = record.flags;
+
+  return ReadString(file, wp.name) &&
+    ReadString(file, wp.comment) &&
+    ReadString(file, wp.details) &&
+    ReadStringList(file, wp.files_embed)
+#ifdef HAVE_RUN_FILE
+    && ReadStringList(file, wp.files_external)
+#endif
+    ;
+}
+
+/**
+ * Compare a string from the cache file with the expected value.
+ */
+static bool
+CheckString(FILE *file, const TCHAR *expected, uint32_t length)
+{
+  if (length != (expected != nullptr ? _tcslen(expected) : 0))
+    return false;
+
+  if (length == 0)
+    return true;
+
+  tstring value(length, _T('\0'));
+  return fread(&value[0], sizeof(value[0]), length, file) == length &&
+    value == expected;
+}
+
+static bool
+Load(FILE *file, const TCHAR *original_path, const TCHAR *terrain_path,
+     WaypointOrigin origin, std::vector<Waypoint> &waypoints)
+{
+  WaypointCacheHeader header;
+  if (fread(&header, sizeof(header), 1, file) != 1 ||
+      header.magic != WAYPOINT_CACHE_MAGIC ||
+      header.record_size != sizeof(WaypointCacheRecord) ||
+      !CheckString(file, original_path, header.path_length) ||
+      !CheckString(file, terrain_path, header.terrain_path_length))
+    return false;
+
+  uint64_t terrain_size, terrain_mtime;
+  GetTerrainIdentity(terrain_path, terrain_size, terrain_mtime);
+  if (header.terrain_size != terrain_size ||
+      header.terrain_mtime != terrain_mtime)
+    /* the terrain file has been replaced */
+    return false;
+
+  /* don't trust the count for allocating memory */
+  waypoints.reserve(std::min(header.count, 65536u));
+
+  for (uint32_t i = 0; i < header.count; ++i) {
+    waypoints.emplace_back(GeoPoint::Invalid());
+
+    Waypoint &wp = waypoints.back();
+    wp.origin = origin;
+    if (!ReadWaypoint(file, wp))
+      return false;
+  }
+
+  return true;
+}
+
+bool
+WaypointCache::Load(FileCache &cache, const TCHAR *name,
+                    const TCHAR *original_path, const TCHAR *terrain_path,
+                    WaypointOrigin origin, Waypoints &way_points)
+{
+  FILE *file = cache.Load(name, original_path);
+  if (file == nullptr)
+    return false;
+
+  /* read everything before appending, to leave #way_points alone if
+     the file turns out to be broken */
+  std::vector<Waypoint> waypoints;
+  const bool success = ::Load(file, original_path, terrain_path,
+                              origin, waypoints);
+  fclose(file);
+
+  if (!success) {
+    cache.Flush(name);
+    return false;
+  }
+
+  for (auto &wp : waypoints)
+    way_points.Append(std::move(wp));
+
+  return true;
+}
+
+bool
+WaypointCache::Save(FileCache &cache, const TCHAR *name,
+                    const TCHAR *original_path, const TCHAR *terrain_path,
+                    const std::vector<const Waypoint *> &waypoints)
+{
+  FILE *file = cache.Save(name, original_path);
+  if (file == nullptr)
+    return false;
+
+  WaypointCacheHeader header;
+  memset(&header, 0, sizeof(header));
+  header.magic = WAYPOINT_CACHE_MAGIC;
+  header.record_size = sizeof(WaypointCacheRecord);
+  header.count = waypoints.size();
+  header.path_length = _tcslen(original_path);
+  header.terrain_path_length = terrain_path != nullptr
+    ? _tcslen(terrain_path)
+    : 0;
+  GetTerrainIdentity(terrain_path, header.terrain_size, header.terrain_mtime);
+
+  bool success = fwrite(&header, sizeof(header), 1, file) == 1 &&
+    fwrite(original_path, sizeof(*original_path), header.path_length,
+           file) == header.path_length &&
+    (terrain_path == nullptr ||
+     fwrite(terrain_path, sizeof(*terrain_path), header.terrain_path_length,
+            file) == header.terrain_path_length);
+
+  for (auto i = waypoints.begin(); success && i != waypoints.end(); ++i)
+    success = WriteWaypoint(file, **i);
+
+  if (success)
+    return cache.Commit(name, file);
+
+  cache.Cancel(name, file);
+  return false;
+}
@@ -0,0 +1,72 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_WAYPOINT_CACHE_HPP
+#define XCSOAR_WAYPOINT_CACHE_HPP
+
+#include "Engine/Waypoint/Origin.hpp"
+
+#include <vector>
+
+#include <tchar.h>
+
+struct Waypoint;
+class Waypoints;
+class FileCache;
+
+/**
+ * A binary snapshot of the waypoints parsed from one waypoint file,
+ * stored in the #FileCache.  It is invalidated when the size or the
+ * modification time of the waypoint file changes.
+ *
+ * Waypoints without an elevation in the file get it from the terrain
+ * while parsing, therefore the path, the size and the modification
+ * time of the terrain file are part of the key, too.
+ */
+namespace WaypointCache {
+  /**
+   * Load the snapshot and append its waypoints to #way_points, in the
+   * order they were parsed from the file.  Nothing is appended if the
+   * snapshot is missing, stale or broken.
+   *
+   * @param name the name of the cache file
+   * @param original_path the waypoint file (or the map file
+   * containing it)
+   * @param terrain_path the terrain file which was used for
+   * elevation fallbacks, or nullptr if there was no terrain
+   * @return true if the snapshot was loaded
+   */
+  bool Load(FileCache &cache, const TCHAR *name,
+            const TCHAR *original_path, const TCHAR *terrain_path,
+            WaypointOrigin origin, Waypoints &way_points);
+
+  /**
+   * Save a snapshot of the given waypoints, which must be in the
+   * order they were parsed from the file.
+   */
+  bool Save(FileCache &cache, const TCHAR *name,
+            const TCHAR *original_path, const TCHAR *terrain_path,
+            const std::vector<const Waypoint *> &waypoints);
+}
+
+#endif
@@ -28,6 +28,7 @@ Copyright_License {
 #include "LogFile.hpp"
 #include "Waypoint/Waypoints.hpp"
 #include "WaypointReader.hpp"
+#include "WaypointCache.hpp"
 #include "Language/Language.hpp"
 #include "LocalPath.hpp"
 #include "Operation/Operation.hpp"
@@ -35,6 +36,9 @@ Copyright_License {
 
 #include <zzip/zzip.h>
 
+#include <algorithm>
+#include <vector>
+
 #include <windef.h> /* for MAX_PATH */
 
 static bool
@@ -53,39 +57,110 @@ LoadWaypointFile(Waypoints &waypoints, const TCHAR *path,
   return true;
 }
 
+/**
+ * Returns the waypoints in the order they were parsed, i.e. sorted
+ * by id.
+ */
+static std::vector<const Waypoint *>
+SortById(const Waypoints &waypoints)
+{
+  std::vector<const Waypoint *> result;
+  result.reserve(waypoints.size());
+  for (const auto &wp : waypoints)
+    result.push_back(&wp);
+
+  std::sort(result.begin(), result.end(),
+            [](const Waypoint *a, const Waypoint *b){
+              return a->id < b->id;
+            });
+  return result;
+}
+
+/**
+ * Load the waypoints from the #FileCache snapshot if it is up to
+ * date.  Otherwise invoke the parser, save a new snapshot and append
+ * the waypoints in the order they were parsed, so the waypoint ids
+ * are the same with and without the cache.
+ *
+ * @param parse a function which parses the file into the given
+ * #Waypoints object
+ */
+template<typename P>
 static bool
-LoadWaypointFile(Waypoints &waypoints, const TCHAR *path,
-                 WaypointOrigin origin,
-                 const RasterTerrain *terrain, OperationEnvironment &operation)
+LoadWaypointFileCached(Waypoints &waypoints, FileCache *cache,
+                       const TCHAR *cache_name, const TCHAR *original_path,
+                       const TCHAR *terrain_path, WaypointOrigin origin,
+                       P &&parse)
 {
-  if (!ReadWaypointFile(path, waypoints, WaypointFactory(origin, terrain),
-                        operation)) {
-    LogFormat(_T("Failed to read waypoint file: %s"), path);
+  if (cache == nullptr)
+    return parse(waypoints);
+
+  if (WaypointCache::Load(*cache, cache_name, original_path, terrain_path,
+                          origin, waypoints))
+    return true;
+
+  Waypoints parsed;
+  if (!parse(parsed))
     return false;
-  }
+
+  const auto sorted = SortById(parsed);
+  if (!WaypointCache::Save(*cache, cache_name, original_path, terrain_path,
+                           sorted))
+    LogFormat(_T("Failed to save waypoint cache: %s"), cache_name);
+
+  for (const Waypoint *wp : sorted)
+    waypoints.Append(Waypoint(*wp));
 
   return true;
 }
 
 static bool
-LoadWaypointFile(Waypoints &waypoints, struct zzip_dir *dir, const char *path,
+LoadWaypointFile(Waypoints &waypoints, const TCHAR *path,
+                 WaypointOrigin origin,
+                 const RasterTerrain *terrain, const TCHAR *terrain_path,
+                 FileCache *cache, const TCHAR *cache_name,
+                 OperationEnvironment &operation)
+{
+  return LoadWaypointFileCached(waypoints, cache, cache_name,
+                                path, terrain_path, origin,
+                                [&](Waypoints &dest){
+    if (!ReadWaypointFile(path, dest, WaypointFactory(origin, terrain),
+                          operation)) {
+      LogFormat(_T("Failed to read waypoint file: %s"), path);
+      return false;
+    }
+
+    return true;
+  });
+}
+
+static bool
+LoadWaypointFile(Waypoints &waypoints, struct zzip_dir *dir,
+                 const TCHAR *map_path, const char *path,
                  WaypointFileType file_type,
                  WaypointOrigin origin,
-                 const RasterTerrain *terrain, OperationEnvironment &operation)
+                 const RasterTerrain *terrain, const TCHAR *terrain_path,
+                 FileCache *cache, const TCHAR *cache_name,
+                 OperationEnvironment &operation)
 {
-  if (!ReadWaypointFile(dir, path, file_type, waypoints,
-                        WaypointFactory(origin, terrain),
-                        operation)) {
-    LogFormat("Failed to read waypoint file: %s", path);
-    return false;
-  }
+  return LoadWaypointFileCached(waypoints, cache, cache_name,
+                                map_path, terrain_path, origin,
+                                [&](Waypoints &dest){
+    if (!ReadWaypointFile(dir, path, file_type, dest,
+                          WaypointFactory(origin, terrain),
+                          operation)) {
+      LogFormat("Failed to read waypoint file: %s", path);
+      return false;
+    }
 
-  return true;
+    return true;
+  });
 }
 
 bool
 WaypointGlue::LoadWaypoints(Waypoints &way_points,
                             const RasterTerrain *terrain,
+                            FileCache *cache,
                             OperationEnvironment &operation)
 {
   LogFormat("ReadWaypoints");
@@ -98,6 +173,14 @@ WaypointGlue::LoadWaypoints(Waypoints &way_points,
 
   TCHAR path[MAX_PATH];
 
+  /* the elevation of some waypoints may come from the terrain, so
+     the terrain file is part of the cache key */
+  TCHAR map_path[MAX_PATH];
+  const bool have_map_path = Profile::GetPath(ProfileKeys::MapFile, map_path);
+  const TCHAR *terrain_path = terrain != nullptr && have_map_path
+    ? map_path
+    : nullptr;
+
   LoadWaypointFile(way_points, LocalPath(path, _T("user.cup")),
                    WaypointFileType::SEEYOU,
                    WaypointOrigin::USER, terrain, operation);
@@ -105,33 +188,38 @@ WaypointGlue::LoadWaypoints(Waypoints &way_points,
   // ### FIRST FILE ###
   if (Profile::GetPath(ProfileKeys::WaypointFile, path))
     found |= LoadWaypointFile(way_points, path, WaypointOrigin::PRIMARY,
-                              terrain, operation);
+                              terrain, terrain_path,
+                              cache, _T("waypoints-primary"), operation);
 
   // ### SECOND FILE ###
   if (Profile::GetPath(ProfileKeys::AdditionalWaypointFile, path))
     found |= LoadWaypointFile(way_points, path, WaypointOrigin::ADDITIONAL,
-                              terrain, operation);
+                              terrain, terrain_path,
+                              cache, _T("waypoints-additional"), operation);
 
   // ### WATCHED WAYPOINT/THIRD FILE ###
   if (Profile::GetPath(ProfileKeys::WatchedWaypointFile, path))
     found |= LoadWaypointFile(way_points, path, WaypointOrigin::WATCHED,
-                              terrain, operation);
+                              terrain, terrain_path,
+                              cache, _T("waypoints-watched"), operation);
 
   // ### MAP/FOURTH FILE ###
 
   // If no waypoint file found yet
-  if (!found) {
+  if (!found && have_map_path) {
     auto dir = OpenMapFile();
     if (dir != nullptr) {
-      found |= LoadWaypointFile(way_points, dir, "waypoints.xcw",
+      found |= LoadWaypointFile(way_points, dir, map_path, "waypoints.xcw",
                                 WaypointFileType::WINPILOT,
                                 WaypointOrigin::MAP,
-                                terrain, operation);
+                                terrain, terrain_path,
+                                cache, _T("waypoints-map-xcw"), operation);
 
-      found |= LoadWaypointFile(way_points, dir, "waypoints.cup",
+      found |= LoadWaypointFile(way_points, dir, map_path, "waypoints.cup",
                                 WaypointFileType::SEEYOU,
                                 WaypointOrigin::MAP,
-                                terrain, operation);
+                                terrain, terrain_path,
+                                cache, _T("waypoints-map-cup"), operation);
 
       zzip_dir_close(dir);
     }
@@ -0,0 +1,261 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Compare build time, memory usage and query latency of the packed
+ * R-tree used by #Airspaces with the kd-tree which was used before,
+ * on the airspaces of an OpenAir (or SUA) file.  Then measure
+ * Airspaces::SynchroniseInRange() the way the route planner uses it.
+ */
+
+#include "Airspace/AirspaceParser.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Geo/Flat/BoundingBoxDistance.hpp"
+#include "Util/SliceAllocator.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+#include "IO/FileLineReader.hpp"
+#include "Operation/Operation.hpp"
+#include "Util/Error.hxx"
+
+#include <kdtree++/kdtree.hpp>
+
+#include <vector>
+#include <algorithm>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+/** Function object used by kd-tree to index coordinates */
+struct kd_get_bounds {
+  typedef int result_type;
+
+  int operator()(const FlatBoundingBox &d, const unsigned k) const {
+    switch(k) {
+    case 0:
+      return d.GetLeft();
+    case 1:
+      return d.GetBottom();
+    case 2:
+      return d.GetRight();
+    case 3:
+      return d.GetTop();
+    default:
+      gcc_unreachable();
+    };
+  };
+};
+
+/** Distance metric function object used by kd-tree */
+struct kd_distance {
+  typedef BBDist distance_type;
+
+  distance_type operator()(const int a, const int b, const size_t dim) const {
+    return BBDist(dim, std::max((dim < 2) ? (b - a) : (a - b), 0));
+  }
+};
+
+typedef KDTree::KDTree<4,
+                       Airspace,
+                       kd_get_bounds, kd_distance,
+                       std::less<kd_get_bounds::result_type>,
+                       SliceAllocator<KDTree::_Node<Airspace>, 256>
+                       > AirspaceKDTree;
+
+typedef Airspaces::AirspaceTree AirspaceRTree;
+
+static constexpr unsigned N_BUILDS = 10;
+static constexpr unsigned N_QUERIES = 100000;
+static constexpr unsigned N_SYNC_STEPS = 10000;
+
+struct Query {
+  FlatBoundingBox box;
+  int range;
+};
+
+struct CountVisitor {
+  unsigned count = 0;
+
+  void operator()(const Airspace &) {
+    ++count;
+  }
+};
+
+static unsigned
+RunQueries(const AirspaceKDTree &tree, const std::vector<Query> &queries)
+{
+  CountVisitor visitor;
+  for (const auto &q : queries)
+    tree.visit_within_range(q.box, -q.range, visitor);
+  return visitor.count;
+}
+
+static unsigned
+RunQueries(const AirspaceRTree &tree, const std::vector<Query> &queries)
+{
+  CountVisitor visitor;
+  for (const auto &q : queries)
+    tree.VisitWithinRange(q.box, q.range, visitor);
+  return visitor.count;
+}
+
+int main(int argc, char **argv)
+{
+  Args args(argc, argv, "PATH");
+  const char *path = args.ExpectNext();
+  args.ExpectEnd();
+
+  Error error;
+  FileLineReader reader(path, error, Charset::AUTO);
+  if (reader.error()) {
+    fprintf(stderr, "%s\n", error.GetMessage());
+    return EXIT_FAILURE;
+  }
+
+  Airspaces airspaces;
+  AirspaceParser parser(airspaces);
+
+  NullOperationEnvironment operation;
+  if (!parser.Parse(reader, operation)) {
+    fprintf(stderr, "Failed to parse input file\n");
+    return EXIT_FAILURE;
+  }
+
+  airspaces.Optimise();
+
+  const std::vector<Airspace> items(airspaces.begin(), airspaces.end());
+  if (items.empty()) {
+    fprintf(stderr, "No airspaces\n");
+    return EXIT_FAILURE;
+  }
+
+  printf("%u airspaces\n", unsigned(items.size()));
+
+  /* build */
+
+  AirspaceKDTree kd_tree;
+  uint64_t start = MonotonicClockUS();
+  for (unsigned i = 0; i < N_BUILDS; ++i) {
+    kd_tree.clear();
+    for (const auto &as : items)
+      kd_tree.insert(as);
+    kd_tree.optimise();
+  }
+  const uint64_t kd_build = (MonotonicClockUS() - start) / N_BUILDS;
+
+  AirspaceRTree r_tree;
+  start = MonotonicClockUS();
+  for (unsigned i = 0; i < N_BUILDS; ++i)
+    r_tree.Load(std::vector<Airspace>(items));
+  const uint64_t r_build = (MonotonicClockUS() - start) / N_BUILDS;
+
+  printf("build: kd-tree %u us, R-tree %u us\n",
+         unsigned(kd_build), unsigned(r_build));
+
+  /* memory; the kd-tree allocates one node per value */
+
+  printf("memory: kd-tree %u bytes, R-tree %u bytes\n",
+         unsigned(items.size() * sizeof(KDTree::_Node<Airspace>)),
+         unsigned(r_tree.GetMemoryUsage()));
+
+  /* queries at random locations within the airspace bounds, the
+     same kind of queries Airspaces::VisitWithinRange() and
+     Airspaces::FindInside() perform */
+
+  FlatBoundingBox bounds = items.front();
+  for (const auto &as : items)
+    bounds.Merge(as);
+
+  const FlatProjection &projection = airspaces.GetProjection();
+
+  for (const double range : {0., 20000., 100000.}) {
+    std::vector<Query> queries;
+    queries.reserve(N_QUERIES);
+    srand(42);
+    for (unsigned i = 0; i < N_QUERIES; ++i) {
+      const FlatGeoPoint p(bounds.GetLeft() + rand() % (bounds.GetWidth() + 1),
+                           bounds.GetBottom() + rand() % (bounds.GetHeight() + 1));
+      const int projected_range =
+        projection.ProjectRangeInteger(projection.Unproject(p), range);
+      queries.push_back({FlatBoundingBox(p), projected_range});
+    }
+
+    start = MonotonicClockUS();
+    const unsigned kd_count = RunQueries(kd_tree, queries);
+    const uint64_t kd_query = MonotonicClockUS() - start;
+
+    start = MonotonicClockUS();
+    const unsigned r_count = RunQueries(r_tree, queries);
+    const uint64_t r_query = MonotonicClockUS() - start;
+
+    printf("query range=%um: kd-tree %.3f us, R-tree %.3f us (%.1f results)\n",
+           unsigned(range),
+           double(kd_query) / N_QUERIES, double(r_query) / N_QUERIES,
+           double(r_count) / N_QUERIES);
+
+    if (kd_count != r_count) {
+      fprintf(stderr, "Results differ: %u vs %u\n", kd_count, r_count);
+      return EXIT_FAILURE;
+    }
+  }
+
+  /* synchronise a copy with a window which moves across the
+     airspace bounds in small steps, like AirspaceRoute does between
+     the aircraft and its destination */
+
+  const GeoPoint sw = projection.Unproject(FlatGeoPoint(bounds.GetLeft(),
+                                                        bounds.GetBottom()));
+  const GeoPoint ne = projection.Unproject(FlatGeoPoint(bounds.GetRight(),
+                                                        bounds.GetTop()));
+
+  for (const double range : {10000., 50000.}) {
+    Airspaces copy(false);
+    unsigned n_changes = 0;
+    uint64_t total = 0, changes = 0, checksum = 0;
+
+    for (unsigned i = 0; i < N_SYNC_STEPS; ++i) {
+      const GeoPoint location = sw.Interpolate(ne, fixed(i) / N_SYNC_STEPS);
+
+      start = MonotonicClockUS();
+      const bool changed =
+        copy.SynchroniseInRange(airspaces, location, fixed(range));
+      const uint64_t duration = MonotonicClockUS() - start;
+
+      total += duration;
+      if (changed) {
+        ++n_changes;
+        changes += duration;
+      }
+
+      checksum = checksum * 31 +
+        copy.ScanRange(location, fixed(range)).size();
+    }
+
+    printf("sync range=%um: %.3f us per step, %u changes, %.3f us per change, checksum %016llx\n",
+           unsigned(range), double(total) / N_SYNC_STEPS, n_changes,
+           n_changes > 0 ? double(changes) / n_changes : 0.,
+           (unsigned long long)checksum);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,561 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Replay IGC and NMEA files through the complete GlideComputer (air
+ * data, task, route, contest and airspace warnings) as fast as
+ * possible, and report the throughput, the time spent in each
+ * computer and the peak memory usage.
+ */
+
+#include "Computer/GlideComputer.hpp"
+#include "Computer/GlideComputerInterface.hpp"
+#include "Computer/Settings.hpp"
+#include "Engine/Waypoint/Waypoints.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Task/TaskManager.hpp"
+#include "Engine/Task/Ordered/OrderedTask.hpp"
+#include "Task/ProtectedTaskManager.hpp"
+#include "Task/TaskFile.hpp"
+#include "Terrain/RasterTerrain.hpp"
+#include "Terrain/PrefetchGlue.hpp"
+#include "Airspace/AirspaceParser.hpp"
+#include "Waypoint/WaypointReader.hpp"
+#include "Waypoint/Factory.hpp"
+#include "Atmosphere/Pressure.hpp"
+#include "Profiler/Profiler.hpp"
+#include "DebugReplayIGC.hpp"
+#include "DebugReplayNMEA.hpp"
+#include "IO/FileLineReader.hpp"
+#include "IO/TextWriter.hpp"
+#include "JSON/Writer.hpp"
+#include "Operation/Operation.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+#include "OS/FileUtil.hpp"
+#include "OS/ConvertPathName.hpp"
+#include "OS/PathName.hpp"
+#include "Util/StringUtil.hpp"
+#include "Util/Error.hxx"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_POSIX
+#include <sys/resource.h>
+#endif
+
+/* fake symbols: */
+
+#include "Computer/ConditionMonitor/ConditionMonitors.hpp"
+#include "Input/InputQueue.hpp"
+#include "Logger/Logger.hpp"
+
+void
+ConditionMonitorsUpdate(const NMEAInfo &basic, const DerivedInfo &calculated,
+                        const ComputerSettings &settings)
+{
+}
+
+bool InputEvents::processGlideComputer(unsigned) { return false; }
+
+void Logger::LogStartEvent(const NMEAInfo &gps_info) {}
+void Logger::LogFinishEvent(const NMEAInfo &gps_info) {}
+void Logger::LogPoint(const NMEAInfo &gps_info) {}
+
+/* done with fake symbols. */
+
+/**
+ * The accumulated time of all spans with the same name.
+ */
+struct SpanTotal {
+  uint64_t duration = 0;
+  unsigned count = 0;
+};
+
+struct FileResult {
+  std::string path;
+  unsigned fixes;
+  uint64_t duration;
+};
+
+struct Result {
+  std::vector<FileResult> files;
+
+  unsigned fixes = 0;
+
+  /**
+   * The wall time of the replay [us], including parsing the input.
+   */
+  uint64_t duration = 0;
+
+  /**
+   * The time spent in GlideComputer::ProcessGPS() and
+   * GlideComputer::ProcessIdle() [us].
+   */
+  uint64_t process_gps = 0, process_idle = 0;
+
+  /**
+   * The time spent loading terrain tiles [us].  This is done by the
+   * #TerrainThread during a flight, so it is not part of the
+   * other durations.
+   */
+  uint64_t update_tiles = 0;
+
+  std::map<std::string, SpanTotal> computers;
+
+  void CollectSpans(unsigned &cursor, std::vector<Profiler::Span> &buffer) {
+    buffer.clear();
+    Profiler::Read(0, cursor, buffer);
+    for (const auto &span : buffer) {
+      SpanTotal &total = computers[span.name];
+      total.duration += span.duration;
+      ++total.count;
+    }
+  }
+};
+
+struct Environment {
+  std::string driver = "Generic";
+
+  Waypoints waypoints;
+  Airspaces airspaces;
+  RasterTerrain *terrain = nullptr;
+  std::string task_path;
+
+  ComputerSettings settings;
+
+  ~Environment() {
+    delete terrain;
+  }
+};
+
+static bool
+LoadWaypoints(const char *path, Waypoints &waypoints)
+{
+  NullOperationEnvironment operation;
+  if (!ReadWaypointFile(PathName(path), waypoints,
+                        WaypointFactory(WaypointOrigin::PRIMARY),
+                        operation)) {
+    fprintf(stderr, "Failed to load %s\n", path);
+    return false;
+  }
+
+  waypoints.Optimise();
+  return true;
+}
+
+static bool
+LoadAirspaces(const char *path, Airspaces &airspaces,
+              const RasterTerrain *terrain)
+{
+  Error error;
+  FileLineReader reader(path, error, Charset::AUTO);
+  if (reader.error()) {
+    fprintf(stderr, "%s\n", error.GetMessage());
+    return false;
+  }
+
+  AirspaceParser parser(airspaces);
+  NullOperationEnvironment operation;
+  if (!parser.Parse(reader, operation)) {
+    fprintf(stderr, "Failed to parse %s\n", path);
+    return false;
+  }
+
+  airspaces.Optimise();
+  airspaces.SetFlightLevels(AtmosphericPressure::Standard());
+  if (terrain != nullptr)
+    airspaces.SetGroundLevels(*terrain);
+
+  return true;
+}
+
+/**
+ * Loads the terrain tiles around the aircraft and along its predicted
+ * path, like the #TerrainThread does for the map during a flight.
+ * Without this, all terrain lookups would use the overview.
+ */
+class TerrainTileUpdater {
+  /**
+   * The radius [m] around the aircraft which is loaded; this is
+   * about half the width of the map at the default cruise zoom.
+   */
+  static constexpr fixed RADIUS = fixed(20000);
+
+  /**
+   * Don't reload tiles before the aircraft or its predicted path
+   * have moved this far [m]; this is what TerrainThread::Trigger()
+   * does.
+   */
+  static constexpr fixed TOLERANCE = fixed(1000);
+
+  RasterTerrain &terrain;
+
+  GeoPoint last_location = GeoPoint::Invalid();
+  TerrainPrefetch last_prefetch = TerrainPrefetch::Invalid();
+
+public:
+  explicit TerrainTileUpdater(RasterTerrain &_terrain):terrain(_terrain) {}
+
+  void Update(const NMEAInfo &basic, const DerivedInfo &calculated) {
+    if (!basic.location_available)
+      return;
+
+    const TerrainPrefetch prefetch = GetTerrainPrefetch(basic, calculated);
+    if (last_location.IsValid() &&
+        last_location.DistanceS(basic.location) < TOLERANCE &&
+        last_prefetch.IsClose(prefetch, TOLERANCE))
+      return;
+
+    while (terrain.UpdateTiles(basic.location, RADIUS, prefetch)) {}
+
+    last_location = basic.location;
+    last_prefetch = prefetch;
+  }
+};
+
+static DebugReplay *
+CreateReplay(const char *path, const Environment &env)
+{
+  if (MatchesExtension(path, ".igc"))
+    return DebugReplayIGC::Create(path);
+  else
+    return DebugReplayNMEA::Create(path, env.driver.c_str());
+}
+
+/**
+ * Replay one file with a fresh #GlideComputer, like
+ * CalculationThread::Tick() does during a flight.
+ */
+static bool
+RunFile(const char *path, Environment &env, Result &result,
+        std::vector<Profiler::Span> &buffer)
+{
+  const uint64_t start = MonotonicClockUS();
+
+  DebugReplay *replay = CreateReplay(path, env);
+  if (replay == nullptr) {
+    fprintf(stderr, "Failed to open %s\n", path);
+    return false;
+  }
+
+  TaskManager task_manager(env.settings.task, env.waypoints);
+  GlideComputerTaskEvents task_events;
+  task_manager.SetTaskEvents(task_events);
+  task_manager.SetGlidePolar(env.settings.polar.glide_polar_task);
+
+  ProtectedTaskManager protected_task_manager(task_manager,
+                                              env.settings.task);
+
+  if (!env.task_path.empty()) {
+    OrderedTask *task = TaskFile::GetTask(env.task_path.c_str(),
+                                          env.settings.task,
+                                          &env.waypoints, 0);
+    if (task != nullptr) {
+      protected_task_manager.TaskCommit(*task);
+      delete task;
+    }
+  }
+
+  GlideComputer glide_computer(env.waypoints, env.airspaces,
+                               protected_task_manager, task_events);
+  glide_computer.ReadComputerSettings(env.settings);
+  glide_computer.SetTerrain(env.terrain);
+  glide_computer.Initialise();
+
+  std::unique_ptr<TerrainTileUpdater> tile_updater;
+  if (env.terrain != nullptr)
+    tile_updater.reset(new TerrainTileUpdater(*env.terrain));
+
+  unsigned cursor = 0;
+  unsigned fixes = 0;
+  fixed last_idle_time(-1);
+
+  while (replay->Next()) {
+    const MoreData &basic = replay->Basic();
+
+    if (tile_updater) {
+      const uint64_t t = MonotonicClockUS();
+      tile_updater->Update(basic, glide_computer.Calculated());
+      result.update_tiles += MonotonicClockUS() - t;
+    }
+
+    glide_computer.ReadBlackboard(basic);
+
+    const uint64_t t0 = MonotonicClockUS();
+    glide_computer.Expire();
+    glide_computer.ProcessGPS();
+    const uint64_t t1 = MonotonicClockUS();
+    result.process_gps += t1 - t0;
+
+    /* the CalculationThread runs ProcessIdle() at most twice per
+       second; use the replay time instead of the wall time, so the
+       result does not depend on the speed of this machine */
+    if (basic.time_available &&
+        (basic.time < last_idle_time ||
+         basic.time >= last_idle_time + fixed(0.5))) {
+      last_idle_time = basic.time;
+      glide_computer.ProcessIdle();
+      result.process_idle += MonotonicClockUS() - t1;
+    }
+
+    ++fixes;
+
+    /* drain the ring buffer before it overflows */
+    if (fixes % 64 == 0)
+      result.CollectSpans(cursor, buffer);
+  }
+
+  result.CollectSpans(cursor, buffer);
+  delete replay;
+
+  const uint64_t duration = MonotonicClockUS() - start;
+  result.files.push_back({path, fixes, duration});
+  result.fixes += fixes;
+  result.duration += duration;
+  return true;
+}
+
+class ReplayFileVisitor final : public File::Visitor {
+  std::vector<std::string> &paths;
+
+public:
+  explicit ReplayFileVisitor(std::vector<std::string> &_paths)
+    :paths(_paths) {}
+
+  void Visit(const TCHAR *path, const TCHAR *filename) override {
+    if (MatchesExtension(filename, ".igc") ||
+        MatchesExtension(filename, ".nmea"))
+      paths.push_back(path);
+  }
+};
+
+/**
+ * Returns the peak resident set size [kB], or 0 if unknown.
+ */
+static unsigned long
+GetPeakMemory()
+{
+#ifdef HAVE_POSIX
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+    return usage.ru_maxrss;
+#endif
+
+  return 0;
+}
+
+static double
+FixesPerSecond(unsigned fixes, uint64_t duration)
+{
+  return duration > 0 ? fixes * 1000000. / duration : 0;
+}
+
+static void
+WriteDouble(TextWriter &writer, double value)
+{
+  writer.Format("%.3f", value);
+}
+
+static void
+WriteTime(TextWriter &writer, uint64_t value)
+{
+  writer.Format("%llu", (unsigned long long)value);
+}
+
+static void
+WriteFile(TextWriter &writer, const FileResult &file)
+{
+  JSON::ObjectWriter object(writer);
+  object.WriteElement("path", JSON::WriteString, file.path.c_str());
+  object.WriteElement("fixes", JSON::WriteUnsigned, file.fixes);
+  object.WriteElement("duration_us", WriteTime, file.duration);
+  object.WriteElement("fixes_per_second", WriteDouble,
+                      FixesPerSecond(file.fixes, file.duration));
+}
+
+static void
+WriteComputer(TextWriter &writer, const SpanTotal &total)
+{
+  JSON::ObjectWriter object(writer);
+  object.WriteElement("duration_us", WriteTime, total.duration);
+  object.WriteElement("count", JSON::WriteUnsigned, total.count);
+}
+
+static void
+WriteJSON(const Result &result)
+{
+  TextWriter writer("/dev/stdout", true);
+
+  {
+    JSON::ObjectWriter root(writer);
+
+    root.BeginElement("files");
+    {
+      JSON::ArrayWriter files(writer);
+      for (const auto &file : result.files)
+        files.WriteElement(WriteFile, file);
+    }
+    root.EndElement();
+
+    root.WriteElement("fixes", JSON::WriteUnsigned, result.fixes);
+    root.WriteElement("duration_us", WriteTime, result.duration);
+    root.WriteElement("fixes_per_second", WriteDouble,
+                      FixesPerSecond(result.fixes, result.duration));
+    root.WriteElement("process_gps_us", WriteTime, result.process_gps);
+    root.WriteElement("process_idle_us", WriteTime, result.process_idle);
+    root.WriteElement("update_tiles_us", WriteTime, result.update_tiles);
+
+    root.BeginElement("computers");
+    {
+      JSON::ObjectWriter computers(writer);
+      for (const auto &i : result.computers)
+        computers.WriteElement(i.first.c_str(), WriteComputer, i.second);
+    }
+    root.EndElement();
+
+    root.WriteElement("peak_memory_kb", JSON::WriteLong,
+                      (long)GetPeakMemory());
+  }
+
+  writer.NewLine();
+}
+
+static void
+PrintResult(const Result &result)
+{
+  for (const auto &file : result.files)
+    printf("%s: %u fixes, %.0f fixes/s\n", file.path.c_str(), file.fixes,
+           FixesPerSecond(file.fixes, file.duration));
+
+  printf("\ntotal: %u fixes in %.3f s, %.0f fixes/s\n",
+         result.fixes, result.duration / 1000000.,
+         FixesPerSecond(result.fixes, result.duration));
+
+  const uint64_t computer = result.process_gps + result.process_idle;
+  printf("ProcessGPS %.3f s, ProcessIdle %.3f s, UpdateTiles %.3f s\n\n",
+         result.process_gps / 1000000., result.process_idle / 1000000.,
+         result.update_tiles / 1000000.);
+
+  for (const auto &i : result.computers)
+    printf("%-20s %10.3f s %5.1f%% %10u calls\n", i.first.c_str(),
+           i.second.duration / 1000000.,
+           computer > 0 ? i.second.duration * 100. / computer : 0.,
+           i.second.count);
+
+  printf("\npeak memory %lu kB\n", GetPeakMemory());
+}
+
+int
+main(int argc, char **argv)
+{
+  Args args(argc, argv,
+            "[options] PATH...\n"
+            "PATH is an IGC or NMEA file, or a directory containing such files\n"
+            "Options:\n"
+            "  --waypoints=FILE   Load waypoints\n"
+            "  --airspace=FILE    Load airspaces (OpenAir or SUA)\n"
+            "  --terrain=FILE     Load terrain from a XCM map file\n"
+            "  --task=FILE        Load a task\n"
+            "  --driver=NAME      Driver for NMEA files (default = Generic)\n"
+            "  --json             Print machine-readable JSON");
+
+  Environment env;
+  env.settings.SetDefaults();
+  env.settings.polar.glide_polar_task = GlidePolar(fixed(1));
+
+  bool json = false;
+  const char *airspace_path = nullptr, *terrain_path = nullptr;
+
+  const char *arg;
+  while ((arg = args.PeekNext()) != nullptr && *arg == '-') {
+    args.Skip();
+
+    const char *value;
+    if ((value = StringAfterPrefix(arg, "--waypoints=")) != nullptr) {
+      if (!LoadWaypoints(value, env.waypoints))
+        return EXIT_FAILURE;
+    } else if ((value = StringAfterPrefix(arg, "--airspace=")) != nullptr)
+      airspace_path = value;
+    else if ((value = StringAfterPrefix(arg, "--terrain=")) != nullptr)
+      terrain_path = value;
+    else if ((value = StringAfterPrefix(arg, "--task=")) != nullptr)
+      env.task_path = value;
+    else if ((value = StringAfterPrefix(arg, "--driver=")) != nullptr)
+      env.driver = value;
+    else if (strcmp(arg, "--json") == 0)
+      json = true;
+    else
+      args.UsageError();
+  }
+
+  std::vector<std::string> paths;
+  ReplayFileVisitor visitor(paths);
+  do {
+    const char *path = args.ExpectNext();
+    if (Directory::Exists(path)) {
+      const size_t n = paths.size();
+      Directory::VisitFiles(path, visitor, true);
+      std::sort(paths.begin() + n, paths.end());
+    } else
+      paths.push_back(path);
+  } while (!args.IsEmpty());
+
+  if (terrain_path != nullptr) {
+    NullOperationEnvironment operation;
+    env.terrain = RasterTerrain::OpenTerrain(terrain_path, nullptr,
+                                             operation);
+    if (env.terrain == nullptr) {
+      fprintf(stderr, "Failed to load %s\n", terrain_path);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (airspace_path != nullptr &&
+      !LoadAirspaces(airspace_path, env.airspaces, env.terrain))
+    return EXIT_FAILURE;
+
+  /* the profiler provides the per-computer breakdown */
+  Profiler::RegisterThread("BenchmarkGlideComputer");
+  Profiler::SetEnabled(true);
+
+  Result result;
+  std::vector<Profiler::Span> buffer;
+  for (const auto &path : paths)
+    if (!RunFile(path.c_str(), env, result, buffer))
+      return EXIT_FAILURE;
+
+  if (json)
+    WriteJSON(result);
+  else
+    PrintResult(result);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,371 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Stress test for the NMEA ingestion path of #DeviceDescriptor.
+ * Several "port threads" feed generated NMEA chunks through a
+ * #PortLineSplitter and the #NMEAParser into a shared per-device
+ * #NMEAInfo array, while a merge thread combines them like
+ * DeviceBlackboard::Merge().  It reports how long the shared lock is
+ * held and the latency from receiving a sentence to merging it.
+ *
+ * With --per-line, the lock is taken for parsing each line (the old
+ * behaviour); otherwise each chunk is parsed into a #StagedNMEAInfo
+ * and published with one lock.
+ */
+
+#include "Device/Parser.hpp"
+#include "Device/Util/LineSplitter.hpp"
+#include "Device/Util/StagedNMEAInfo.hpp"
+#include "NMEA/Info.hpp"
+#include "NMEA/Checksum.hpp"
+#include "Profiler/Profiler.hpp"
+#include "Profiler/Statistics.hpp"
+#include "Thread/Thread.hpp"
+#include "Thread/Mutex.hpp"
+#include "Thread/Cond.hxx"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+#include "OS/Sleep.h"
+#include "Util/StringAPI.hxx"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+static constexpr unsigned N_DEVICES = 4;
+
+static const char *const device_names[N_DEVICES] = {
+  "FLARM 1", "FLARM 2", "Vario", "AHRS",
+};
+
+/**
+ * Emulates the per-device part of #DeviceBlackboard.
+ */
+struct SharedState {
+  Mutex mutex;
+  Cond cond;
+
+  NMEAInfo per_device[N_DEVICES];
+
+  /**
+   * The time [us] when the oldest sentence which has not been merged
+   * yet was received; 0 if there is none.
+   */
+  uint64_t pending_since[N_DEVICES];
+
+  NMEAInfo merged;
+
+  bool merge_scheduled = false, stop = false;
+
+  unsigned n_merges = 0;
+
+  SharedState() {
+    for (unsigned i = 0; i < N_DEVICES; ++i) {
+      per_device[i].Reset();
+      pending_since[i] = 0;
+    }
+
+    merged.Reset();
+  }
+
+  /**
+   * Caller must hold the mutex.
+   */
+  void ScheduleMerge() {
+    merge_scheduled = true;
+    cond.signal();
+  }
+};
+
+class DeviceThread final : public Thread, PortLineSplitter {
+  SharedState &shared;
+  const unsigned index;
+  const unsigned rate;
+  const bool per_line;
+
+  NMEAParser parser;
+  StagedNMEAInfo staging;
+
+  /**
+   * The time [us] when the current chunk was received.
+   */
+  uint64_t received;
+
+public:
+  unsigned n_lines = 0;
+
+  DeviceThread(SharedState &_shared, unsigned _index, unsigned _rate,
+               bool _per_line)
+    :Thread("Device"), shared(_shared), index(_index), rate(_rate),
+     per_line(_per_line) {}
+
+private:
+  void Feed(unsigned n);
+
+  void Publish() {
+    if (!staging.IsActive())
+      return;
+
+    if (!staging.IsModified()) {
+      staging.Cancel();
+      return;
+    }
+
+    const ScopeLock protect(shared.mutex);
+    const ProfileScope scope("lock");
+    staging.Commit(shared.per_device[index]);
+    if (shared.pending_since[index] == 0)
+      shared.pending_since[index] = received;
+    shared.ScheduleMerge();
+  }
+
+  /* virtual methods from class PortLineHandler */
+  void LineReceived(const char *line) override {
+    ++n_lines;
+
+    if (per_line) {
+      const ScopeLock protect(shared.mutex);
+      const ProfileScope scope("lock");
+      NMEAInfo &basic = shared.per_device[index];
+      basic.UpdateClock();
+      if (parser.ParseLine(line, basic)) {
+        basic.alive.Update(basic.clock);
+        if (shared.pending_since[index] == 0)
+          shared.pending_since[index] = received;
+        shared.ScheduleMerge();
+      }
+
+      return;
+    }
+
+    if (!staging.IsActive()) {
+      const ScopeLock protect(shared.mutex);
+      const ProfileScope scope("lock");
+      staging.Begin(shared.per_device[index]);
+    }
+
+    NMEAInfo &basic = staging.Get();
+    basic.UpdateClock();
+    if (parser.ParseLine(line, basic)) {
+      basic.alive.Update(basic.clock);
+      staging.SetModified();
+    }
+  }
+
+  /* virtual methods from class Thread */
+  void Run() override {
+    Profiler::RegisterThread(device_names[index]);
+
+    for (unsigned n = 0;; ++n) {
+      {
+        const ScopeLock protect(shared.mutex);
+        if (shared.stop)
+          break;
+      }
+
+      received = MonotonicClockUS();
+      Feed(n);
+      if (!per_line)
+        Publish();
+
+      Sleep(1000 / rate);
+    }
+  }
+};
+
+static void
+AppendLine(char *buffer, const char *line)
+{
+  char *p = buffer + strlen(buffer);
+  strcpy(p, line);
+  AppendNMEAChecksum(p);
+  strcat(p, "\r\n");
+}
+
+void
+DeviceThread::Feed(unsigned n)
+{
+  /* advance the GPS time by 10 ms per chunk, so the parser's time
+     warp checks stay quiet */
+  const unsigned t = 8 * 360000 + n;
+  char time[16];
+  sprintf(time, "%02u%02u%02u.%02u",
+          t / 360000, t / 6000 % 60, t / 100 % 60, t % 100);
+
+  char buffer[1024] = "", line[256];
+
+  switch (index) {
+  case 0:
+  case 1:
+    sprintf(line, "$GPRMC,%s,A,5103.5403,N,00741.5742,E,055.3,022.4,230610,000.3,W",
+            time);
+    AppendLine(buffer, line);
+    AppendLine(buffer, "$PGRMZ,2381,F,2");
+    AppendLine(buffer, "$PFLAU,3,1,1,1,0,,0,,");
+    for (unsigned i = 0; i < 3; ++i) {
+      sprintf(line, "$PFLAA,0,%u,-150,10,2,DDA8%02X,123,13,24,1.4,2",
+              100 + (n % 50) * 10, i + 16 * index);
+      AppendLine(buffer, line);
+    }
+    break;
+
+  case 2:
+    AppendLine(buffer, "$PGRMZ,2381,F,2");
+    sprintf(line, "$GPGGA,%s,5103.5403,N,00741.5742,E,1,08,0.9,725.5,M,47.6,M,,",
+            time);
+    AppendLine(buffer, line);
+    break;
+
+  case 3:
+    sprintf(line, "$GPRMC,%s,A,5103.5403,N,00741.5742,E,055.3,022.4,230610,000.3,W",
+            time);
+    AppendLine(buffer, line);
+    sprintf(line, "$GPGGA,%s,5103.5403,N,00741.5742,E,1,08,0.9,725.5,M,47.6,M,,",
+            time);
+    AppendLine(buffer, line);
+    break;
+  }
+
+  DataReceived(buffer, strlen(buffer));
+}
+
+class MergeThread final : public Thread {
+  SharedState &shared;
+
+public:
+  explicit MergeThread(SharedState &_shared)
+    :Thread("Merge"), shared(_shared) {}
+
+private:
+  void Merge() {
+    const ProfileScope scope("merge");
+
+    const uint64_t now = MonotonicClockUS();
+
+    NMEAInfo &merged = shared.merged;
+    merged.Reset();
+    for (unsigned i = 0; i < N_DEVICES; ++i) {
+      NMEAInfo &basic = shared.per_device[i];
+      if (!basic.alive)
+        continue;
+
+      basic.UpdateClock();
+      basic.Expire();
+      merged.Complement(basic);
+
+      if (shared.pending_since[i] != 0) {
+        Profiler::Record("latency", shared.pending_since[i], now);
+        shared.pending_since[i] = 0;
+      }
+    }
+
+    ++shared.n_merges;
+  }
+
+  /* virtual methods from class Thread */
+  void Run() override {
+    Profiler::RegisterThread("Merge");
+
+    const ScopeLock protect(shared.mutex);
+    while (true) {
+      if (shared.stop)
+        break;
+
+      if (!shared.merge_scheduled) {
+        shared.cond.wait(shared.mutex);
+        continue;
+      }
+
+      shared.merge_scheduled = false;
+      Merge();
+    }
+  }
+};
+
+int
+main(int argc, char **argv)
+{
+  Args args(argc, argv, "[--per-line] [RATE [SECONDS]]");
+
+  bool per_line = false;
+  if (!args.IsEmpty() && StringIsEqual(args.PeekNext(), "--per-line")) {
+    per_line = true;
+    args.Skip();
+  }
+
+  const unsigned rate = args.IsEmpty() ? 50 : args.ExpectNextInt();
+  const unsigned seconds = args.IsEmpty() ? 5 : args.ExpectNextInt();
+  args.ExpectEnd();
+
+  if (rate == 0 || rate > 1000) {
+    fprintf(stderr, "RATE must be between 1 and 1000\n");
+    return EXIT_FAILURE;
+  }
+
+  Profiler::SetEnabled(true);
+
+  SharedState shared;
+
+  MergeThread merge_thread(shared);
+  merge_thread.Start();
+
+  DeviceThread *devices[N_DEVICES];
+  for (unsigned i = 0; i < N_DEVICES; ++i) {
+    devices[i] = new DeviceThread(shared, i, rate, per_line);
+    devices[i]->Start();
+  }
+
+  Sleep(seconds * 1000);
+
+  {
+    const ScopeLock protect(shared.mutex);
+    shared.stop = true;
+    shared.cond.signal();
+  }
+
+  unsigned n_lines = 0;
+  for (unsigned i = 0; i < N_DEVICES; ++i) {
+    devices[i]->Join();
+    n_lines += devices[i]->n_lines;
+    delete devices[i];
+  }
+
+  merge_thread.Join();
+
+  printf("%s, %u devices at %u Hz: %u lines, %u merges\n",
+         per_line ? "per-line locking" : "staged",
+         N_DEVICES, rate, n_lines, shared.n_merges);
+
+  printf("merged: location %s, %u FLARM targets\n",
+         shared.merged.location_available ? "valid" : "invalid",
+         unsigned(shared.merged.flarm.traffic.GetActiveTrafficCount()));
+
+  printf("%-10s %8s %8s %8s %8s\n", "span", "count", "p50", "p95", "p99");
+  for (const auto &i : Profiler::CalculateStatistics())
+    printf("%-10s %8u %8u %8u %8u\n",
+           i.name, i.count, i.p50, i.p95, i.p99);
+
+  return EXIT_SUCCESS;
+}
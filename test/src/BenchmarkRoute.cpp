@@ -0,0 +1,182 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Solve routes between random points over real terrain and airspace,
+ * and measure the time spent in the route planner.  The checksum of
+ * all solutions allows comparing the results of two builds.
+ */
+
+#include "Route/AirspaceRoute.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/Predicate/AirspacePredicate.hpp"
+#include "Airspace/AirspaceParser.hpp"
+#include "GlideSolvers/GlideSettings.hpp"
+#include "GlideSolvers/GlidePolar.hpp"
+#include "Geo/SpeedVector.hpp"
+#include "Terrain/RasterMap.hpp"
+#include "Terrain/Loader.hpp"
+#include "Thread/SharedMutex.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+#include "IO/FileLineReader.hpp"
+#include "Operation/Operation.hpp"
+#include "Util/Error.hxx"
+
+#include <zzip/zzip.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include <algorithm>
+
+static constexpr unsigned N_ROUTES = 50;
+
+static bool
+LoadMap(const char *path, RasterMap &map)
+{
+  ZZIP_DIR *dir = zzip_dir_open(path, nullptr);
+  if (dir == nullptr) {
+    fprintf(stderr, "Failed to open %s\n", path);
+    return false;
+  }
+
+  NullOperationEnvironment operation;
+  if (!LoadTerrainOverview(dir, map.GetTileCache(), operation)) {
+    fprintf(stderr, "Failed to load map\n");
+    zzip_dir_close(dir);
+    return false;
+  }
+
+  SharedMutex mutex;
+  do {
+    UpdateTerrainTiles(dir, map.GetTileCache(), mutex,
+                       map.GetProjection(),
+                       map.GetMapCenter(), fixed(100000));
+  } while (map.IsDirty());
+
+  zzip_dir_close(dir);
+  return true;
+}
+
+static bool
+LoadAirspaces(const char *path, Airspaces &airspaces)
+{
+  Error error;
+  FileLineReader reader(path, error, Charset::AUTO);
+  if (reader.error()) {
+    fprintf(stderr, "%s\n", error.GetMessage());
+    return false;
+  }
+
+  AirspaceParser parser(airspaces);
+  NullOperationEnvironment operation;
+  if (!parser.Parse(reader, operation)) {
+    fprintf(stderr, "Failed to parse airspace file\n");
+    return false;
+  }
+
+  airspaces.Optimise();
+  return true;
+}
+
+/**
+ * Returns a random location within the given number of degrees
+ * around the center, at the given height above the terrain.
+ */
+static AGeoPoint
+RandomPoint(const RasterMap &map, double degrees, int height)
+{
+  GeoPoint p = map.GetMapCenter();
+  p.longitude += Angle::Degrees(degrees * (rand() % 2001 - 1000) / 1000.);
+  p.latitude += Angle::Degrees(degrees * (rand() % 2001 - 1000) / 1000.);
+
+  const short h = map.GetHeight(p);
+  return AGeoPoint(p, RoughAltitude(std::max(int(h), 0) + height));
+}
+
+int main(int argc, char **argv)
+{
+  Args args(argc, argv, "MAP.xcm AIRSPACES");
+  const char *map_path = args.ExpectNext();
+  const char *airspace_path = args.ExpectNext();
+  args.ExpectEnd();
+
+  RasterMap map;
+  if (!LoadMap(map_path, map))
+    return EXIT_FAILURE;
+
+  Airspaces airspaces;
+  if (!LoadAirspaces(airspace_path, airspaces))
+    return EXIT_FAILURE;
+
+  GlideSettings settings;
+  settings.SetDefaults();
+  const GlidePolar polar(fixed(1));
+  const SpeedVector wind(Angle::Degrees(0), fixed(0));
+
+  AirspaceRoute route;
+  route.UpdatePolar(settings, polar, polar, wind);
+  route.SetTerrain(&map);
+
+  RoutePlannerConfig config;
+  config.SetDefaults();
+  config.mode = RoutePlannerConfig::Mode::BOTH;
+
+  const AirspacePredicateTrue predicate;
+
+  srand(42);
+
+  unsigned n_solved = 0, n_points = 0;
+  uint64_t solve_us = 0, checksum = 0;
+
+  for (unsigned i = 0; i < N_ROUTES; ++i) {
+    const AGeoPoint start = RandomPoint(map, 1.5, 1500 + rand() % 3000);
+    const AGeoPoint destination = RandomPoint(map, 1.5, 2000);
+
+    route.Synchronise(airspaces, predicate, start, destination);
+
+    const uint64_t start_us = MonotonicClockUS();
+    const bool solved = route.Solve(start, destination, config);
+    solve_us += MonotonicClockUS() - start_us;
+
+    if (solved)
+      ++n_solved;
+
+    for (const auto &p : route.GetSolution()) {
+      ++n_points;
+      checksum = checksum * 31 +
+        unsigned(p.longitude.Native() * 1e6) + unsigned(p.latitude.Native() * 1e6) +
+        unsigned(int(p.altitude));
+    }
+  }
+
+  printf("%u airspaces\n", unsigned(airspaces.GetSize()));
+  printf("%u routes, %u solved, %u points, checksum %016llx\n",
+         N_ROUTES, n_solved, n_points, (unsigned long long)checksum);
+  printf("solve: %u ms total, %.1f ms per route\n",
+         unsigned(solve_us / 1000), double(solve_us) / 1000. / N_ROUTES);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,207 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Compare the speed of the portable and the vectorised slope shading
+ * kernels, and of the serial and the striped HeightMatrix scan on a
+ * real terrain file, and verify that both produce the same results.
+ */
+
+#include "Terrain/RasterMap.hpp"
+#include "Terrain/HeightMatrix.hpp"
+#include "Terrain/Loader.hpp"
+#include "Terrain/SlopeShading.hpp"
+#include "Projection/WindowProjection.hpp"
+#include "Screen/Layout.hpp"
+#include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+#include "Util/AllocatedArray.hpp"
+#include "Operation/Operation.hpp"
+#include "Thread/Parallel.hpp"
+
+#include <zzip/zzip.h>
+
+#include <algorithm>
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+unsigned Layout::scale_1024 = 1024;
+
+/* the default terrain settings with the sun in the north-west */
+static constexpr SlopeShadingParameters shading{
+  -168, -168, 92, 150, 150,
+};
+
+typedef void (*SlopeShadingRowFunction)(signed char *gcc_restrict dest,
+                                        const short *above,
+                                        const short *src,
+                                        const short *below,
+                                        unsigned distance, unsigned p31,
+                                        unsigned n,
+                                        const SlopeShadingParameters &p);
+
+/**
+ * Calculate the illumination of all pixels of the matrix which have
+ * a full neighbourhood, the same way RasterRenderer does it.
+ */
+static void
+ShadeMatrix(SlopeShadingRowFunction f, const HeightMatrix &matrix,
+            unsigned distance, signed char *dest)
+{
+  const unsigned width = matrix.GetWidth();
+  const unsigned height = matrix.GetHeight();
+  const short *src = matrix.GetData();
+
+  for (unsigned y = distance; y + distance < height; ++y) {
+    const short *row = src + y * width;
+    f(dest + y * width + distance,
+      row + distance - distance * width,
+      row + distance,
+      row + distance + distance * width,
+      distance, 2 * distance, width - 2 * distance, shading);
+  }
+}
+
+/**
+ * Fill the matrix for the given projection, split into the given
+ * number of stripes.
+ */
+static void
+FillMatrix(HeightMatrix &matrix, const RasterMap &map,
+           const WindowProjection &projection, unsigned n_stripes)
+{
+#ifdef ENABLE_OPENGL
+  matrix.Fill(map, projection.GetScreenBounds(),
+              projection.GetScreenWidth(), projection.GetScreenHeight(),
+              true, n_stripes);
+#else
+  matrix.Fill(map, projection, 1, true, n_stripes);
+#endif
+}
+
+static uint64_t
+BenchmarkFill(HeightMatrix &matrix, const RasterMap &map,
+              const WindowProjection &projection, unsigned n_stripes,
+              unsigned n)
+{
+  const uint64_t start = MonotonicClockUS();
+  for (unsigned i = 0; i < n; ++i)
+    FillMatrix(matrix, map, projection, n_stripes);
+  return (MonotonicClockUS() - start) / n;
+}
+
+static uint64_t
+Benchmark(SlopeShadingRowFunction f, const HeightMatrix &matrix,
+          unsigned distance, signed char *dest, unsigned n)
+{
+  const uint64_t start = MonotonicClockUS();
+  for (unsigned i = 0; i < n; ++i)
+    ShadeMatrix(f, matrix, distance, dest);
+  return (MonotonicClockUS() - start) / n;
+}
+
+int main(int argc, char **argv)
+{
+  Args args(argc, argv, "PATH");
+  const auto map_path = args.ExpectNext();
+  args.ExpectEnd();
+
+  ZZIP_DIR *dir = zzip_dir_open(map_path, nullptr);
+  if (dir == nullptr) {
+    fprintf(stderr, "Failed to open %s\n", map_path);
+    return EXIT_FAILURE;
+  }
+
+  RasterMap map;
+
+  NullOperationEnvironment operation;
+  if (!LoadTerrainOverview(dir, map.GetTileCache(),
+                           operation)) {
+    fprintf(stderr, "failed to load map\n");
+    zzip_dir_close(dir);
+    return EXIT_FAILURE;
+  }
+
+  map.UpdateProjection();
+
+  SharedMutex mutex;
+  do {
+    UpdateTerrainTiles(dir, map.GetTileCache(), mutex,
+                       map.GetProjection(),
+                       map.GetMapCenter(), fixed(50000));
+  } while (map.IsDirty());
+  zzip_dir_close(dir);
+
+  WindowProjection projection;
+  projection.SetScreenSize({1280, 800});
+  projection.SetScaleFromRadius(fixed(50000));
+  projection.SetGeoLocation(map.GetMapCenter());
+  projection.SetScreenOrigin(640, 400);
+  projection.UpdateScreenBounds();
+
+  /* at least 4 stripes, to verify the result even on single-core
+     machines */
+  const unsigned n_stripes = std::max(GetCPUCount(), 4u);
+
+  HeightMatrix matrix, striped_matrix;
+  const auto serial_fill = BenchmarkFill(matrix, map, projection, 1, 10);
+  const auto striped_fill = BenchmarkFill(striped_matrix, map, projection,
+                                          n_stripes, 10);
+
+  printf("%ux%u fill: serial %u us, %u stripes %u us\n",
+         matrix.GetWidth(), matrix.GetHeight(),
+         unsigned(serial_fill), n_stripes, unsigned(striped_fill));
+
+  if (memcmp(matrix.GetData(), striped_matrix.GetData(),
+             matrix.GetWidth() * matrix.GetHeight() * sizeof(short)) != 0) {
+    fprintf(stderr, "Striped scan differs from the serial scan\n");
+    return EXIT_FAILURE;
+  }
+
+  const unsigned size = matrix.GetWidth() * matrix.GetHeight();
+  AllocatedArray<signed char> expected(size), actual(size);
+  std::fill_n(expected.begin(), size, 0);
+  std::fill_n(actual.begin(), size, 0);
+
+  constexpr unsigned n = 100;
+
+  for (unsigned distance = 1; distance <= 4; distance *= 2) {
+    const auto scalar = Benchmark(CalcSlopeShadingRowScalar, matrix,
+                                  distance, expected.begin(), n);
+    const auto vector = Benchmark(CalcSlopeShadingRow, matrix,
+                                  distance, actual.begin(), n);
+
+    printf("%ux%u distance=%u: scalar %u us, vectorised %u us\n",
+           matrix.GetWidth(), matrix.GetHeight(), distance,
+           unsigned(scalar), unsigned(vector));
+
+    if (memcmp(expected.begin(), actual.begin(), size) != 0) {
+      fprintf(stderr, "Vectorised kernel differs from the reference\n");
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
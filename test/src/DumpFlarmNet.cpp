@@ -35,9 +35,8 @@ int main(int argc, char **argv)
   FlarmNetDatabase database;
   FlarmNetReader::LoadFile(path.c_str(), database);
 
-  for (auto i = database.begin(), end = database.end(); i != end; ++i) {
-    const FlarmNetRecord &record = i->second;
-
+  for (unsigned i = 0; i < database.GetSize(); ++i) {
+    const FlarmNetRecord &record = database.GetRecord(i);
     _tprintf(_T("%s\t%s\t%s\t%s\n"),
              record.id.c_str(), record.pilot.c_str(),
              record.registration.c_str(), record.callsign.c_str());
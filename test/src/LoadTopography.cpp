@@ -84,7 +84,7 @@ int main(int argc, char **argv)
 
   TopographyStore topography;
   NullOperationEnvironment operation;
-  topography.Load(operation, reader, NULL, dir);
+  topography.Load(operation, reader, NULL, dir, path);
   zzip_dir_close(dir);
 
   topography.LoadAll();
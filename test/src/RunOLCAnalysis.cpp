@@ -24,6 +24,8 @@
 #include "Contest/ContestManager.hpp"
 #include "Printing.hpp"
 #include "OS/Args.hpp"
+#include "OS/Clock.hpp"
+#include "Thread/Parallel.hpp"
 #include "DebugReplay.hpp"
 
 #include <assert.h>
@@ -61,10 +63,22 @@ static ContestManager sis_at(Contest::SIS_AT,
 static ContestManager olc_netcoupe(Contest::NET_COUPE,
                                    full_trace, triangle_trace, sprint_trace);
 
+static void
+Solve(const char *name, ContestManager &manager)
+{
+  const uint64_t start = MonotonicClockUS();
+  manager.SolveExhaustive();
+  const uint64_t duration = MonotonicClockUS() - start;
+
+  printf("# %s solved in %u.%03u ms\n", name,
+         unsigned(duration / 1000), unsigned(duration % 1000));
+}
+
 static int
 TestOLC(DebugReplay &replay)
 {
   bool released = false;
+  uint64_t idle_duration = 0;
 
   for (int i = 1; replay.Next(); i++) {
     if (i % 500 == 0) {
@@ -90,21 +104,25 @@ TestOLC(DebugReplay &replay)
     full_trace.push_back(point);
     sprint_trace.push_back(point);
 
+    const uint64_t start = MonotonicClockUS();
     olc_sprint.UpdateIdle();
     olc_league.UpdateIdle();
+    idle_duration += MonotonicClockUS() - start;
   }
 
-  olc_classic.SolveExhaustive();
-  olc_fai.SolveExhaustive();
-  olc_league.SolveExhaustive();
-  olc_plus.SolveExhaustive();
-  dmst.SolveExhaustive();
-  xcontest.SolveExhaustive();
-  sis_at.SolveExhaustive();
-  olc_netcoupe.SolveExhaustive();
-
   putchar('\n');
 
+  printf("# idle updates took %u ms\n", unsigned(idle_duration / 1000));
+
+  Solve("classic", olc_classic);
+  Solve("fai", olc_fai);
+  Solve("league", olc_league);
+  Solve("plus", olc_plus);
+  Solve("dmst", dmst);
+  Solve("xcontest", xcontest);
+  Solve("sis_at", sis_at);
+  Solve("netcoupe", olc_netcoupe);
+
   std::cout << "classic\n";
   PrintHelper::print(olc_classic.GetStats().GetResult());
   std::cout << "league\n";
@@ -156,6 +174,12 @@ TestOLC(DebugReplay &replay)
 int main(int argc, char **argv)
 {
   Args args(argc, argv, "DRIVER FILE");
+
+  for (ContestManager *manager : {&olc_classic, &olc_fai, &olc_sprint,
+                                  &olc_league, &olc_plus, &dmst, &xcontest,
+                                  &sis_at, &olc_netcoupe})
+    manager->SetParallel(RunParallel);
+
   DebugReplay *replay = CreateDebugReplay(args);
   if (replay == NULL)
     return EXIT_FAILURE;
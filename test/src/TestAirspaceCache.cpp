@@ -0,0 +1,160 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Airspace/AirspaceCache.hpp"
+#include "Airspace/AirspaceParser.hpp"
+#include "Engine/Airspace/AbstractAirspace.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "IO/FileCache.hpp"
+#include "IO/FileLineReader.hpp"
+#include "OS/FileUtil.hpp"
+#include "Operation/Operation.hpp"
+#include "Util/StringAPI.hxx"
+#include "Util/Error.hxx"
+#include "TestUtil.hpp"
+
+#include <vector>
+
+static const TCHAR *const openair_path = _T("test/data/airspace/openair.txt");
+static const TCHAR *const tnp_path = _T("test/data/airspace/tnp.sua");
+
+static bool
+ParseFile(const TCHAR *path, Airspaces &airspaces)
+{
+  Error error;
+  FileLineReader reader(path, error, Charset::AUTO);
+  if (reader.error())
+    return false;
+
+  AirspaceParser parser(airspaces);
+  NullOperationEnvironment operation;
+  return parser.Parse(reader, operation);
+}
+
+static bool
+Equals(const AirspaceAltitude &a, const AirspaceAltitude &b)
+{
+  return a.altitude == b.altitude && a.flight_level == b.flight_level &&
+    a.altitude_above_terrain == b.altitude_above_terrain &&
+    a.reference == b.reference;
+}
+
+static bool
+Equals(const SearchPointVector &a, const SearchPointVector &b)
+{
+  if (a.size() != b.size())
+    return false;
+
+  for (unsigned i = 0; i < a.size(); ++i)
+    if (a[i].GetLocation() != b[i].GetLocation() ||
+        a[i].GetFlatLocation() != b[i].GetFlatLocation())
+      return false;
+
+  return true;
+}
+
+static bool
+Equals(const Airspace &a, const Airspace &b)
+{
+  const AbstractAirspace &as_a = a.GetAirspace(), &as_b = b.GetAirspace();
+  if (as_a.GetShape() != as_b.GetShape())
+    return false;
+
+  if (as_a.GetShape() == AbstractAirspace::Shape::CIRCLE &&
+      (as_a.GetCenter() != as_b.GetCenter() ||
+       ((const AirspaceCircle &)as_a).GetRadius() !=
+       ((const AirspaceCircle &)as_b).GetRadius()))
+    return false;
+
+  return a.GetLeft() == b.GetLeft() && a.GetBottom() == b.GetBottom() &&
+    a.GetRight() == b.GetRight() && a.GetTop() == b.GetTop() &&
+    as_a.GetType() == as_b.GetType() &&
+    Equals(as_a.GetBase(), as_b.GetBase()) &&
+    Equals(as_a.GetTop(), as_b.GetTop()) &&
+    as_a.GetDays().equals(as_b.GetDays()) &&
+    StringIsEqual(as_a.GetName(), as_b.GetName()) &&
+    as_a.GetRadioText() == as_b.GetRadioText() &&
+    Equals(as_a.GetPoints(), as_b.GetPoints());
+}
+
+/**
+ * Does each airspace in #a have an equal one in #b?  The order of
+ * the R-tree is unspecified.
+ */
+static bool
+Contains(const Airspaces &a, const Airspaces &b)
+{
+  for (const auto &i : a) {
+    bool found = false;
+    for (const auto &j : b) {
+      if (Equals(i, j)) {
+        found = true;
+        break;
+      }
+    }
+
+    if (!found)
+      return false;
+  }
+
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(10);
+
+  Directory::Create(_T("output/results"));
+  FileCache cache(_T("output/results"));
+  cache.Flush(_T("airspace"));
+
+  const std::vector<const TCHAR *> sources{openair_path, tnp_path};
+
+  Airspaces parsed;
+  ok1(ParseFile(openair_path, parsed));
+  ok1(ParseFile(tnp_path, parsed));
+  parsed.Optimise();
+
+  ok1(AirspaceCache::Save(cache, sources, parsed));
+
+  Airspaces loaded;
+  ok1(AirspaceCache::Load(cache, sources, loaded));
+  loaded.Optimise();
+
+  ok1(loaded.GetSize() == parsed.GetSize());
+  ok1(loaded.GetProjection().GetCenter() ==
+      parsed.GetProjection().GetCenter());
+  ok1(Contains(parsed, loaded));
+
+  /* the airspaces must be usable after loading */
+  ok1(!loaded.ScanRange(parsed.begin()->GetAirspace().GetReferenceLocation(),
+                        fixed(1000)).empty());
+
+  /* a different set of source files invalidates the snapshot, and it
+     gets deleted */
+  Airspaces other;
+  ok1(!AirspaceCache::Load(cache, {openair_path}, other));
+  ok1(!AirspaceCache::Load(cache, sources, other) && other.IsEmpty());
+
+  return exit_status();
+}
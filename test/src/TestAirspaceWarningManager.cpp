@@ -0,0 +1,166 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Engine/Airspace/AirspaceWarningManager.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AbstractAirspace.hpp"
+#include "Engine/Navigation/Aircraft.hpp"
+#include "Engine/GlideSolvers/GlidePolar.hpp"
+#include "Engine/Task/Stats/TaskStats.hpp"
+#include "TestUtil.hpp"
+
+#include <stdlib.h>
+#include <tchar.h>
+
+static void
+SetupAirspaces(Airspaces &airspaces, const GeoPoint &center, unsigned n)
+{
+  srand(42);
+
+  for (unsigned i = 0; i < n; ++i) {
+    const GeoPoint c(center.longitude +
+                     Angle::Degrees((rand() % 1200 - 600) / 1000.),
+                     center.latitude +
+                     Angle::Degrees((rand() % 1200 - 600) / 1000.));
+    AbstractAirspace *as =
+      new AirspaceCircle(c, fixed(2000 + rand() % 10000));
+
+    AirspaceAltitude base, top;
+    base.altitude = fixed(rand() % 4000);
+    top.altitude = base.altitude + fixed(100 + rand() % 3000);
+    as->SetProperties(_T("test"), CLASSC, base, top);
+
+    airspaces.Add(as);
+  }
+
+  airspaces.Optimise();
+}
+
+/**
+ * Do both managers have the same warnings with the same solutions?
+ * The solutions of #AirspaceWarning::WARNING_INSIDE are not
+ * compared, because they may be undefined.
+ */
+static bool
+SameWarnings(const AirspaceWarningManager &a,
+             const AirspaceWarningManager &b)
+{
+  if (a.size() != b.size())
+    return false;
+
+  for (const auto &w : a) {
+    const AirspaceWarning *other = b.GetWarningPtr(w.GetAirspace());
+    if (other == nullptr ||
+        other->GetWarningState() != w.GetWarningState())
+      return false;
+
+    if (w.GetWarningState() != AirspaceWarning::WARNING_INSIDE &&
+        other->GetSolution().elapsed_time != w.GetSolution().elapsed_time)
+      return false;
+  }
+
+  return true;
+}
+
+/**
+ * Fly through a field of airspaces with one incremental and one
+ * non-incremental #AirspaceWarningManager, and verify that both
+ * produce the same warnings.
+ */
+static void
+TestIncremental()
+{
+  const GeoPoint center(Angle::Degrees(7), Angle::Degrees(51));
+
+  Airspaces airspaces;
+  SetupAirspaces(airspaces, center, 300);
+
+  AirspaceWarningConfig config;
+  config.SetDefaults();
+
+  AirspaceWarningManager full(airspaces), incremental(airspaces);
+  full.SetConfig(config);
+  full.SetIncremental(false);
+  incremental.SetConfig(config);
+  ok1(incremental.IsIncremental());
+
+  const GlidePolar glide_polar(1);
+  TaskStats task_stats;
+  task_stats.reset();
+
+  AircraftState state;
+  state.Reset();
+  state.time = fixed(36000);
+  state.location = GeoPoint(center.longitude - Angle::Degrees(0.6),
+                            center.latitude);
+  state.altitude = fixed(2500);
+  state.ground_speed = state.true_airspeed = fixed(40);
+  state.vario = state.netto_vario = fixed(-0.5);
+  state.track = Angle::Degrees(80);
+  state.flying = true;
+
+  full.Reset(state);
+  incremental.Reset(state);
+
+  bool same = true, full_skipped = false;
+  unsigned n_warnings = 0, n_evaluated = 0, n_skipped = 0;
+
+  for (unsigned i = 0; i < 1200; ++i) {
+    /* fly straight, with a slow turn now and then */
+    if (i % 200 >= 150)
+      state.track += Angle::Degrees(2);
+
+    state = state.GetPredictedState(fixed(1));
+    state.time += fixed(1);
+
+    full.Update(state, glide_polar, task_stats, false, 1);
+    incremental.Update(state, glide_polar, task_stats, false, 1);
+
+    if (!SameWarnings(full, incremental))
+      same = false;
+
+    if (full.GetSkippedCount() > 0)
+      full_skipped = true;
+
+    n_warnings += full.size();
+    n_evaluated += incremental.GetEvaluatedCount();
+    n_skipped += incremental.GetSkippedCount();
+  }
+
+  ok1(same);
+  ok1(!full_skipped);
+  ok1(n_warnings > 0);
+  ok1(n_skipped > 0);
+
+  diag("evaluated %u, skipped %u", n_evaluated, n_skipped);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(5);
+
+  TestIncremental();
+
+  return exit_status();
+}
@@ -0,0 +1,169 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Logger/AsyncLineWriter.hpp"
+#include "Thread/Thread.hpp"
+#include "TestUtil.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+static const char *path = "output/TestAsyncLineWriter.txt";
+
+static constexpr unsigned N_PRODUCERS = 4;
+static constexpr unsigned N_LINES = 20000;
+
+/**
+ * Read the next line from the file, without the line ending.
+ */
+static bool
+ReadLine(FILE *file, char *buffer, size_t size)
+{
+  if (fgets(buffer, size, file) == nullptr)
+    return false;
+
+  buffer[strcspn(buffer, "\r\n")] = 0;
+  return true;
+}
+
+static void
+TestSimple()
+{
+  AsyncLineWriter writer(path);
+  ok1(writer.IsOpen());
+  writer.Start();
+
+  ok1(writer.WriteLine("foo"));
+  ok1(writer.WriteLine(""));
+
+  char long_line[AsyncLineWriter::MAX_LINE + 2];
+  memset(long_line, 'x', sizeof(long_line) - 1);
+  long_line[sizeof(long_line) - 1] = 0;
+  ok1(!writer.WriteLine(long_line));
+
+  long_line[AsyncLineWriter::MAX_LINE] = 0;
+  ok1(writer.WriteLine(long_line));
+  ok1(writer.WriteLine("bar"));
+
+  writer.StopAndJoin();
+  ok1(writer.GetDroppedLines() == 1);
+  ok1(writer.GetQueueDepth() == 0);
+
+  FILE *file = fopen(path, "rb");
+  ok1(file != nullptr);
+
+  char buffer[512];
+  ok1(ReadLine(file, buffer, sizeof(buffer)) && strcmp(buffer, "foo") == 0);
+  ok1(ReadLine(file, buffer, sizeof(buffer)) && *buffer == 0);
+  ok1(ReadLine(file, buffer, sizeof(buffer)) &&
+      strcmp(buffer, long_line) == 0);
+  ok1(ReadLine(file, buffer, sizeof(buffer)) && strcmp(buffer, "bar") == 0);
+  ok1(!ReadLine(file, buffer, sizeof(buffer)));
+  fclose(file);
+}
+
+class Producer final : public Thread {
+  AsyncLineWriter &writer;
+  const unsigned index;
+
+public:
+  Producer(AsyncLineWriter &_writer, unsigned _index)
+    :Thread("Producer"), writer(_writer), index(_index) {}
+
+private:
+  /* virtual methods from class Thread */
+  void Run() override {
+    char line[64];
+    for (unsigned i = 0; i < N_LINES; ++i) {
+      sprintf(line, "%u %u $GPRMC,081836,A,3751.65,S,14507.36,E", index, i);
+      writer.WriteLine(line);
+    }
+  }
+};
+
+/**
+ * Several threads write concurrently; the lines of each thread must
+ * arrive in order, and each line must either be in the file or be
+ * counted as dropped.
+ */
+static void
+TestConcurrent()
+{
+  AsyncLineWriter writer(path);
+  ok1(writer.IsOpen());
+  writer.Start();
+
+  Producer *producers[N_PRODUCERS];
+  for (unsigned i = 0; i < N_PRODUCERS; ++i) {
+    producers[i] = new Producer(writer, i);
+    producers[i]->Start();
+  }
+
+  for (unsigned i = 0; i < N_PRODUCERS; ++i) {
+    producers[i]->Join();
+    delete producers[i];
+  }
+
+  writer.StopAndJoin();
+  ok1(writer.GetQueueDepth() == 0);
+
+  FILE *file = fopen(path, "rb");
+  ok1(file != nullptr);
+
+  int last[N_PRODUCERS];
+  for (unsigned i = 0; i < N_PRODUCERS; ++i)
+    last[i] = -1;
+
+  unsigned n_lines = 0;
+  bool valid = true;
+
+  char buffer[512];
+  while (ReadLine(file, buffer, sizeof(buffer))) {
+    unsigned index, i;
+    if (sscanf(buffer, "%u %u", &index, &i) != 2 || index >= N_PRODUCERS ||
+        int(i) <= last[index]) {
+      valid = false;
+      break;
+    }
+
+    last[index] = i;
+    ++n_lines;
+  }
+
+  fclose(file);
+
+  ok1(valid);
+  ok1(n_lines + writer.GetDroppedLines() == N_PRODUCERS * N_LINES);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(19);
+
+  TestSimple();
+  TestConcurrent();
+
+  remove(path);
+
+  return exit_status();
+}
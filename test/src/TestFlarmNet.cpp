@@ -24,16 +24,14 @@
 #include "FLARM/FlarmNetReader.hpp"
 #include "FLARM/FlarmNetRecord.hpp"
 #include "FLARM/FlarmId.hpp"
+#include "Thread/Thread.hpp"
 #include "TestUtil.hpp"
 
-int main(int argc, char **argv)
-{
-  plan_tests(15);
-
-  FlarmNetDatabase db;
-  int count = FlarmNetReader::LoadFile(_T("test/data/flarmnet/data.fln"), db);
-  ok1(count == 6);
+#include <assert.h>
 
+static void
+TestDatabase(FlarmNetDatabase &db)
+{
   FlarmId id = FlarmId::Parse("DDA85C", NULL);
 
   const FlarmNetRecord *record = db.FindRecordById(id);
@@ -47,6 +45,16 @@ int main(int argc, char **argv)
   ok1(StringIsEqual(record->callsign, _T("TH")));
   ok1(StringIsEqual(record->frequency, _T("130.625")));
 
+  /* interned strings are shared */
+  ok1(db.Intern(_T("AACHEN")) == record->airfield);
+  ok1(db.Intern(_T("Hornet")) == record->plane_type);
+
+  ok1(db.FindRecordById(FlarmId::Parse("DDA85D", NULL)) == NULL);
+
+  record = db.FindFirstRecordByCallSign(_T("TH"));
+  ok1(record != NULL && StringIsEqual(record->id, _T("DDA85C")));
+  ok1(db.FindFirstRecordByCallSign(_T("T")) == NULL);
+
   const FlarmNetRecord *array[3];
   ok1(db.FindRecordsByCallSign(_T("TH"), array, 3) == 2);
 
@@ -61,6 +69,12 @@ int main(int argc, char **argv)
   ok1(found4449);
   ok1(found5799);
 
+  ok1(db.FindRecordsByCallSign(_T("TH"), array, 1) == 1);
+
+  ok1(db.FindRecordsByCallSignPrefix(_T("T"), array, 3) == 2);
+  ok1(db.FindRecordsByCallSignPrefix(_T("1"), array, 3) == 1 &&
+      StringIsEqual(array[0]->callsign, _T("1A")));
+
   FlarmId ids[3];
   ok1(db.FindIdsByCallSign(_T("TH"), ids, 3) == 2);
 
@@ -75,6 +89,93 @@ int main(int argc, char **argv)
   }
   ok1(foundDDA85C);
   ok1(foundDDA896);
+}
+
+/**
+ * Looks up all records of a database.
+ */
+class LookupThread final : public Thread {
+  const FlarmNetDatabase &db;
+
+public:
+  const FlarmNetRecord *records[16];
+
+  explicit LookupThread(const FlarmNetDatabase &_db)
+    :Thread("Lookup"), db(_db) {}
+
+private:
+  /* virtual methods from class Thread */
+  void Run() override {
+    for (unsigned i = 0; i < db.GetSize(); ++i)
+      records[i] = &db.GetRecord(i);
+  }
+};
+
+/**
+ * Threads decoding the same records at the same time must all get
+ * the same copy.
+ */
+static void
+TestConcurrentLookup()
+{
+  FlarmNetDatabase db;
+  FlarmNetReader::MapFile(_T("test/data/flarmnet/data.fln"), db);
+  assert(db.GetSize() <= 16);
+
+  LookupThread a(db), b(db);
+  a.Start();
+  b.Start();
+  a.Join();
+  b.Join();
+
+  bool same = true;
+  for (unsigned i = 0; i < db.GetSize(); ++i)
+    if (a.records[i] != b.records[i] || a.records[i] != &db.GetRecord(i))
+      same = false;
+
+  ok1(same);
+}
+
+static void
+TestDuplicates()
+{
+  FlarmNetDatabase db;
+
+  FlarmNetRecord record;
+  record.id = _T("DDA85C");
+  record.callsign = _T("TH");
+  db.Insert(record);
+
+  record.callsign = _T("XY");
+  db.Insert(record);
+
+  db.Optimise();
+
+  /* the first record wins, and the duplicate is dropped */
+  ok1(db.GetSize() == 1);
+  const FlarmNetRecord *found =
+    db.FindRecordById(FlarmId::Parse("DDA85C", NULL));
+  ok1(found != NULL && StringIsEqual(found->callsign, _T("TH")));
+  ok1(db.FindFirstRecordByCallSign(_T("XY")) == NULL);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(50);
+
+  FlarmNetDatabase db;
+  int count = FlarmNetReader::LoadFile(_T("test/data/flarmnet/data.fln"), db);
+  ok1(count == 6);
+  TestDatabase(db);
+
+  /* the same with records decoded on demand from the mapped file */
+  FlarmNetDatabase mapped;
+  count = FlarmNetReader::MapFile(_T("test/data/flarmnet/data.fln"), mapped);
+  ok1(count == 6);
+  TestDatabase(mapped);
+
+  TestConcurrentLookup();
+  TestDuplicates();
 
   return exit_status();
 }
@@ -0,0 +1,48 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+#include "NMEA/Tag.hpp"
+#include "TestUtil.hpp"
+
+#include <string.h>
+
+static_assert(NMEATag("$PFLAA") != NMEATag("$PFLAU"), "Tags must differ");
+static_assert(NMEATag("") == 0, "Empty tag must be 0");
+static_assert(NMEATag("$PDGFTL1") != 0, "Eight characters must fit");
+static_assert(NMEATag("$PDGFTL12") == 0, "Long strings must be 0");
+
+int main(int argc, char **argv)
+{
+  plan_tests(5);
+
+  char buffer[16];
+  strcpy(buffer, "$PFLAA");
+  ok1(NMEATag(buffer) == NMEATag("$PFLAA"));
+  ok1(NMEATag(buffer + 1) == NMEATag("PFLAA"));
+  ok1(NMEATag(buffer) != NMEATag("$PFLA"));
+  ok1(NMEATag(buffer) != NMEATag("$PFLAAA"));
+
+  /* a longer string must not match its 8 character prefix */
+  strcpy(buffer, "$PDGFTL1X");
+  ok1(NMEATag(buffer) != NMEATag("$PDGFTL1"));
+
+  return exit_status();
+}
@@ -0,0 +1,124 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Geo/Flat/PackedRTree.hpp"
+#include "TestUtil.hpp"
+
+#include <vector>
+#include <algorithm>
+
+#include <stdlib.h>
+
+/**
+ * A box with an identifier, to check which values were visited.
+ */
+struct Item : FlatBoundingBox {
+  unsigned id;
+
+  Item(const FlatBoundingBox &box, unsigned _id)
+    :FlatBoundingBox(box), id(_id) {}
+};
+
+static FlatBoundingBox
+RandomBox(int max_size)
+{
+  const int x = rand() % 100000 - 50000, y = rand() % 100000 - 50000;
+  return FlatBoundingBox(FlatGeoPoint(x, y),
+                         FlatGeoPoint(x + rand() % max_size,
+                                      y + rand() % max_size));
+}
+
+/**
+ * Compare the result of a query with a linear search.
+ */
+static bool
+CheckQuery(const PackedRTree<Item, 4> &tree, const std::vector<Item> &items,
+           const FlatBoundingBox &box, int range)
+{
+  std::vector<unsigned> expected, actual;
+
+  const FlatBoundingBox query(FlatGeoPoint(box.GetLeft() - range,
+                                           box.GetBottom() - range),
+                              FlatGeoPoint(box.GetRight() + range,
+                                           box.GetTop() + range));
+  for (const auto &i : items)
+    if (i.Overlaps(query))
+      expected.push_back(i.id);
+
+  tree.VisitWithinRange(box, range, [&actual](const Item &i){
+      actual.push_back(i.id);
+    });
+
+  std::sort(expected.begin(), expected.end());
+  std::sort(actual.begin(), actual.end());
+  return actual == expected;
+}
+
+static bool
+TestTree(unsigned n)
+{
+  std::vector<Item> items;
+  for (unsigned i = 0; i < n; ++i)
+    items.emplace_back(RandomBox(5000), i);
+
+  PackedRTree<Item, 4> tree;
+  tree.Load(std::vector<Item>(items));
+  if (tree.size() != n)
+    return false;
+
+  for (unsigned i = 0; i < 100; ++i)
+    if (!CheckQuery(tree, items, RandomBox(20000), rand() % 3000))
+      return false;
+
+  /* a point query at the corner of a value must find it */
+  if (n > 0 && !CheckQuery(tree, items,
+                           FlatBoundingBox(items[0].GetUpperRight()), 0))
+    return false;
+
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(9);
+
+  PackedRTree<Item, 4> tree;
+  ok1(tree.empty());
+
+  /* queries on an empty tree must not crash */
+  unsigned count = 0;
+  tree.VisitWithinRange(FlatBoundingBox(FlatGeoPoint(0, 0)), 1000,
+                        [&count](const Item &){ ++count; });
+  ok1(count == 0);
+
+  /* various sizes, to cover trees with one to several levels and
+     partially filled nodes */
+  ok1(TestTree(1));
+  ok1(TestTree(4));
+  ok1(TestTree(5));
+  ok1(TestTree(17));
+  ok1(TestTree(100));
+  ok1(TestTree(1000));
+  ok1(TestTree(3333));
+
+  return exit_status();
+}
@@ -0,0 +1,94 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Thread/Parallel.hpp"
+#include "TestUtil.hpp"
+
+#include <atomic>
+
+static constexpr unsigned N = 64;
+
+/**
+ * Each index must be handled exactly once, and RunParallel() must
+ * not return before all of them have returned.
+ */
+static bool
+RunCounting(unsigned n)
+{
+  std::atomic<unsigned> counts[N];
+  for (auto &i : counts)
+    i = 0;
+
+  RunParallel(n, [&counts](unsigned i){
+      ++counts[i];
+    });
+
+  for (unsigned i = 0; i < N; ++i)
+    if (counts[i] != (i < n ? 1u : 0u))
+      return false;
+
+  return true;
+}
+
+static void
+TestCounting()
+{
+  ok1(RunCounting(0));
+  ok1(RunCounting(1));
+  ok1(RunCounting(2));
+  ok1(RunCounting(N));
+
+  /* the pool is reused by later calls */
+  bool valid = true;
+  for (unsigned i = 0; i < 1000; ++i)
+    valid = valid && RunCounting(1 + i % N);
+  ok1(valid);
+}
+
+/**
+ * A function may call RunParallel() again, even when there are more
+ * outer indexes than workers.
+ */
+static void
+TestNested()
+{
+  std::atomic<unsigned> sum(0);
+
+  RunParallel(N, [&sum](unsigned i){
+      RunParallel(N, [&sum, i](unsigned j){
+          sum += i * N + j;
+        });
+    });
+
+  ok1(sum == N * N * (N * N - 1) / 2);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(6);
+
+  TestCounting();
+  TestNested();
+
+  return exit_status();
+}
@@ -0,0 +1,200 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Profiler/Profiler.hpp"
+#include "Profiler/Statistics.hpp"
+#include "Thread/Thread.hpp"
+#include "TestUtil.hpp"
+
+#include <atomic>
+#include <vector>
+
+#include <string.h>
+
+static void
+TestStatistics()
+{
+  std::vector<Profiler::Span> spans;
+  for (unsigned i = 1; i <= 100; ++i)
+    spans.push_back({"b", i, 101 - i});
+  spans.push_back({"a", 0, 7});
+
+  const auto result = Profiler::CalculateStatistics(spans);
+  ok1(result.size() == 2);
+  ok1(strcmp(result[0].name, "a") == 0);
+  ok1(result[0].count == 1);
+  ok1(result[0].p50 == 7 && result[0].p95 == 7 && result[0].p99 == 7);
+  ok1(strcmp(result[1].name, "b") == 0);
+  ok1(result[1].count == 100);
+  ok1(result[1].p50 == 50);
+  ok1(result[1].p95 == 95);
+  ok1(result[1].p99 == 99);
+}
+
+static void
+TestRingBuffer()
+{
+  std::vector<Profiler::Span> spans;
+
+  /* disabled: nothing is recorded */
+  ok1(!Profiler::IsEnabled());
+  ok1(Profiler::RegisterThread("Test"));
+  ok1(Profiler::RegisterThread("Test"));
+  ok1(Profiler::GetThreadCount() == 1);
+  ok1(strcmp(Profiler::GetThreadName(0), "Test") == 0);
+
+  {
+    const ProfileScope scope("x");
+  }
+
+  Profiler::ReadAll(0, spans);
+  ok1(spans.empty());
+
+  Profiler::SetEnabled(true);
+
+  {
+    ProfileScope scope("x");
+    scope.Next("y");
+  }
+
+  unsigned cursor = 0;
+  Profiler::Read(0, cursor, spans);
+  ok1(spans.size() == 2);
+  ok1(strcmp(spans[0].name, "x") == 0);
+  ok1(strcmp(spans[1].name, "y") == 0);
+  ok1(spans[1].start == spans[0].start + spans[0].duration);
+
+  /* nothing new since the last call */
+  spans.clear();
+  Profiler::Read(0, cursor, spans);
+  ok1(spans.empty());
+
+  /* overflow: only the newest spans are kept */
+  const unsigned n = Profiler::CAPACITY + 100;
+  for (unsigned i = 0; i < n; ++i)
+    Profiler::Record("z", i, i + 1);
+
+  Profiler::Read(0, cursor, spans);
+  ok1(spans.size() == Profiler::CAPACITY);
+  ok1(spans.front().start == n - Profiler::CAPACITY);
+  ok1(spans.back().start == n - 1);
+
+  spans.clear();
+  Profiler::ReadAll(0, spans);
+  ok1(spans.size() == Profiler::CAPACITY);
+
+  Profiler::SetEnabled(false);
+}
+
+static constexpr unsigned N_SPANS = 1000000;
+
+/**
+ * Records spans whose fields are all derived from one counter, so
+ * the reader can detect torn copies.
+ */
+class WriterThread final : public Thread {
+  std::atomic<bool> finished;
+
+public:
+  WriterThread():Thread("Writer"), finished(false) {}
+
+  bool IsFinished() const {
+    return finished.load(std::memory_order_acquire);
+  }
+
+private:
+  /* virtual methods from class Thread */
+  void Run() override {
+    Profiler::RegisterThread("Writer");
+
+    for (unsigned i = 0; i < N_SPANS; ++i)
+      Profiler::Record(i % 2 == 0 ? "even" : "odd", i, 2 * i);
+
+    finished.store(true, std::memory_order_release);
+  }
+};
+
+static bool
+CheckSpans(const std::vector<Profiler::Span> &spans, uint64_t &last)
+{
+  for (const auto &span : spans) {
+    if (span.duration != span.start ||
+        strcmp(span.name, span.start % 2 == 0 ? "even" : "odd") != 0 ||
+        (last != uint64_t(-1) && span.start <= last))
+      return false;
+
+    last = span.start;
+  }
+
+  return true;
+}
+
+/**
+ * A reader running concurrently with the writer must never see a
+ * span which is being overwritten.
+ */
+static void
+TestConcurrent()
+{
+  Profiler::SetEnabled(true);
+
+  WriterThread writer;
+  writer.Start();
+
+  while (Profiler::GetThreadCount() < 2) {}
+
+  std::vector<Profiler::Span> spans;
+  unsigned cursor = 0;
+  uint64_t last = uint64_t(-1);
+  bool valid = true;
+  unsigned n = 0;
+  bool finished;
+  do {
+    finished = writer.IsFinished();
+
+    spans.clear();
+    Profiler::Read(1, cursor, spans);
+    valid = valid && CheckSpans(spans, last);
+    n += spans.size();
+  } while (!finished);
+
+  writer.Join();
+
+  ok1(valid);
+  ok1(n > 0 && n <= N_SPANS);
+  ok1(last == N_SPANS - 1);
+  ok1(cursor == N_SPANS);
+
+  Profiler::SetEnabled(false);
+}
+
+int
+main(int argc, char **argv)
+{
+  plan_tests(28);
+
+  TestStatistics();
+  TestRingBuffer();
+  TestConcurrent();
+
+  return exit_status();
+}
@@ -0,0 +1,189 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Device/Util/StagedNMEAInfo.hpp"
+#include "Device/Parser.hpp"
+#include "NMEA/Info.hpp"
+#include "NMEA/Checksum.hpp"
+#include "Thread/Thread.hpp"
+#include "Thread/Mutex.hpp"
+#include "TestUtil.hpp"
+
+#include <stdio.h>
+
+static constexpr unsigned N_BATCHES = 2000;
+
+/**
+ * Parse a line into the staged copy, the way
+ * DeviceDescriptor::ParseLine() does.
+ */
+static bool
+ParseLine(NMEAParser &parser, StagedNMEAInfo &staging,
+          Mutex &mutex, const NMEAInfo &shared, const char *line)
+{
+  if (!staging.IsActive()) {
+    const ScopeLock protect(mutex);
+    staging.Begin(shared);
+  }
+
+  NMEAInfo &basic = staging.Get();
+  basic.UpdateClock();
+  if (!parser.ParseLine(line, basic))
+    return false;
+
+  basic.alive.Update(basic.clock);
+  staging.SetModified();
+  return true;
+}
+
+static void
+FormatRMZ(char *buffer, unsigned altitude)
+{
+  sprintf(buffer, "$PGRMZ,%u,m,3", altitude);
+  AppendNMEAChecksum(buffer);
+}
+
+static void
+TestSequential()
+{
+  Mutex mutex;
+  NMEAInfo shared;
+  shared.Reset();
+
+  NMEAParser parser;
+  StagedNMEAInfo staging;
+
+  /* nothing to publish without a batch */
+  ok1(!staging.IsActive());
+  ok1(!staging.Publish(mutex, shared));
+
+  /* a batch is visible only after it has been published */
+  char line[64];
+  FormatRMZ(line, 1234);
+  ok1(ParseLine(parser, staging, mutex, shared, line));
+  ok1(staging.IsActive());
+  ok1(staging.IsModified());
+  ok1(!shared.baro_altitude_available);
+
+  FormatRMZ(line, 1300);
+  ok1(ParseLine(parser, staging, mutex, shared, line));
+  ok1(!shared.baro_altitude_available);
+
+  ok1(staging.Publish(mutex, shared));
+  ok1(!staging.IsActive());
+  ok1(shared.baro_altitude_available);
+  ok1(equals(shared.baro_altitude, 1300));
+  ok1(shared.alive);
+
+  /* a batch which parses nothing does not touch the shared copy */
+  shared.baro_altitude = fixed(42);
+  ok1(!ParseLine(parser, staging, mutex, shared, "$XYZ,garbage"));
+  ok1(staging.IsActive());
+  ok1(!staging.IsModified());
+  ok1(!staging.Publish(mutex, shared));
+  ok1(!staging.IsActive());
+  ok1(equals(shared.baro_altitude, 42));
+
+  /* the next batch starts from the shared copy */
+  ok1(!ParseLine(parser, staging, mutex, shared, "$XYZ,garbage"));
+  ok1(equals(staging.Get().baro_altitude, 42));
+  staging.Cancel();
+}
+
+/**
+ * Emulates the port thread: each batch consists of two lines, and
+ * only the second one determines the published altitude.
+ */
+class PortThread final : public Thread {
+  Mutex &mutex;
+  NMEAInfo &shared;
+
+  NMEAParser parser;
+  StagedNMEAInfo staging;
+
+public:
+  PortThread(Mutex &_mutex, NMEAInfo &_shared)
+    :Thread("Port"), mutex(_mutex), shared(_shared) {}
+
+private:
+  /* virtual methods from class Thread */
+  void Run() override {
+    char line[64];
+    for (unsigned i = 1; i <= N_BATCHES; ++i) {
+      /* an odd intermediate value which must never be published */
+      FormatRMZ(line, 2 * i + 1);
+      ParseLine(parser, staging, mutex, shared, line);
+
+      FormatRMZ(line, 2 * i);
+      ParseLine(parser, staging, mutex, shared, line);
+
+      staging.Publish(mutex, shared);
+    }
+  }
+};
+
+/**
+ * A reader holding the lock must only ever see complete batches, in
+ * order.
+ */
+static void
+TestConcurrent()
+{
+  Mutex mutex;
+  NMEAInfo shared;
+  shared.Reset();
+
+  PortThread port(mutex, shared);
+  port.Start();
+
+  bool valid = true;
+  unsigned last = 0;
+  while (last < 2 * N_BATCHES) {
+    const ScopeLock protect(mutex);
+    if (!shared.baro_altitude_available)
+      continue;
+
+    const unsigned altitude = unsigned(shared.baro_altitude);
+    if (altitude % 2 != 0 || altitude < last) {
+      valid = false;
+      break;
+    }
+
+    last = altitude;
+  }
+
+  port.Join();
+
+  ok1(valid);
+  ok1(equals(shared.baro_altitude, int(2 * N_BATCHES)));
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(23);
+
+  TestSequential();
+  TestConcurrent();
+
+  return exit_status();
+}
@@ -0,0 +1,155 @@
+/* Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2015 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Waypoint/WaypointCache.hpp"
+#include "Waypoint/WaypointReader.hpp"
+#include "Waypoint/Factory.hpp"
+#include "Engine/Waypoint/Waypoints.hpp"
+#include "IO/FileCache.hpp"
+#include "OS/FileUtil.hpp"
+#include "Operation/Operation.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include <stdio.h>
+#include <string.h>
+#include <tchar.h>
+
+static const TCHAR *const path = _T("test/data/waypoints.cup");
+static const TCHAR *const cache_name = _T("test-waypoints");
+static const TCHAR *const terrain_path = _T("output/results/test-terrain.xcm");
+
+/**
+ * Append to the dummy terrain file, to change its size.
+ */
+static bool
+AppendTerrain(const char *data)
+{
+  FILE *file = _tfopen(terrain_path, _T("ab"));
+  if (file == nullptr)
+    return false;
+
+  const size_t length = strlen(data);
+  const bool success = fwrite(data, 1, length, file) == length;
+  return fclose(file) == 0 && success;
+}
+
+static std::vector<const Waypoint *>
+SortById(const Waypoints &waypoints)
+{
+  std::vector<const Waypoint *> result;
+  for (const auto &wp : waypoints)
+    result.push_back(&wp);
+
+  std::sort(result.begin(), result.end(),
+            [](const Waypoint *a, const Waypoint *b){
+              return a->id < b->id;
+            });
+  return result;
+}
+
+static bool
+Equals(const Runway &a, const Runway &b)
+{
+  return a.IsDirectionDefined() == b.IsDirectionDefined() &&
+    (!a.IsDirectionDefined() ||
+     a.GetDirectionDegrees() == b.GetDirectionDegrees()) &&
+    a.IsLengthDefined() == b.IsLengthDefined() &&
+    (!a.IsLengthDefined() || a.GetLength() == b.GetLength());
+}
+
+static bool
+Equals(const Waypoint &a, const Waypoint &b)
+{
+  return a.id == b.id && a.original_id == b.original_id &&
+    a.location == b.location && a.elevation == b.elevation &&
+    Equals(a.runway, b.runway) &&
+    a.radio_frequency.IsDefined() == b.radio_frequency.IsDefined() &&
+    (!a.radio_frequency.IsDefined() ||
+     a.radio_frequency.GetKiloHertz() == b.radio_frequency.GetKiloHertz()) &&
+    a.type == b.type && a.origin == b.origin &&
+    a.flags.turn_point == b.flags.turn_point &&
+    a.flags.home == b.flags.home &&
+    a.flags.start_point == b.flags.start_point &&
+    a.flags.finish_point == b.flags.finish_point &&
+    a.name == b.name && a.comment == b.comment && a.details == b.details &&
+    a.files_embed == b.files_embed;
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(13);
+
+  Directory::Create(_T("output/results"));
+  FileCache cache(_T("output/results"));
+  cache.Flush(cache_name);
+
+  NullOperationEnvironment operation;
+  Waypoints parsed;
+  ok1(ReadWaypointFile(path, parsed,
+                       WaypointFactory(WaypointOrigin::PRIMARY),
+                       operation));
+  const auto sorted = SortById(parsed);
+  ok1(!sorted.empty());
+
+  ok1(WaypointCache::Save(cache, cache_name, path, nullptr, sorted));
+
+  /* the snapshot restores the waypoints in parse order, i.e. with the
+     same ids */
+  Waypoints loaded;
+  ok1(WaypointCache::Load(cache, cache_name, path, nullptr,
+                          WaypointOrigin::PRIMARY, loaded));
+  const auto loaded_sorted = SortById(loaded);
+  ok1(loaded_sorted.size() == sorted.size());
+  ok1(std::equal(sorted.begin(), sorted.end(), loaded_sorted.begin(),
+                 [](const Waypoint *a, const Waypoint *b){
+                   return Equals(*a, *b);
+                 }));
+
+  /* a different terrain invalidates the snapshot, and it gets
+     deleted */
+  Waypoints other;
+  ok1(!WaypointCache::Load(cache, cache_name, path, _T("terrain.xcm"),
+                           WaypointOrigin::PRIMARY, other));
+  ok1(!WaypointCache::Load(cache, cache_name, path, nullptr,
+                           WaypointOrigin::PRIMARY, other) &&
+      other.IsEmpty());
+
+  /* a terrain file which was replaced under the same path invalidates
+     the snapshot */
+  File::Delete(terrain_path);
+  ok1(AppendTerrain("terrain"));
+  ok1(WaypointCache::Save(cache, cache_name, path, terrain_path, sorted));
+  ok1(WaypointCache::Load(cache, cache_name, path, terrain_path,
+                          WaypointOrigin::PRIMARY, other) &&
+      other.size() == sorted.size());
+
+  ok1(AppendTerrain("replaced"));
+  Waypoints replaced;
+  ok1(!WaypointCache::Load(cache, cache_name, path, terrain_path,
+                           WaypointOrigin::PRIMARY, replaced) &&
+      replaced.IsEmpty());
+
+  return exit_status();
+}
@@ -35,6 +35,7 @@
 #include "Geo/SpeedVector.hpp"
 #include "Operation/Operation.hpp"
 #include "OS/FileUtil.hpp"
+#include "Thread/Parallel.hpp"
 
 #include <zzip/zzip.h>
 
@@ -100,6 +101,119 @@ static void test_reach(const RasterMap& map, fixed mwind, fixed mc)
   }
 }
 
+/**
+ * Count the points around the given center where the arrival heights
+ * of the two reach solutions differ significantly.
+ */
+static unsigned
+CountReachDifferences(const RasterMap &map, const GeoPoint &center,
+                      const TerrainRoute &a, const TerrainRoute &b,
+                      unsigned &n_total)
+{
+  unsigned n_differ = 0;
+  n_total = 0;
+
+  for (int i = -20; i <= 20; ++i) {
+    for (int j = -20; j <= 20; ++j) {
+      const GeoPoint x(center.longitude + Angle::Degrees(fixed(0.02) * i),
+                       center.latitude + Angle::Degrees(fixed(0.02) * j));
+      const AGeoPoint adest(x, RoughAltitude(map.GetInterpolatedHeight(x)));
+
+      ReachResult ra, rb;
+      a.FindPositiveArrival(adest, ra);
+      b.FindPositiveArrival(adest, rb);
+
+      ++n_total;
+      if (abs((int)ra.terrain - (int)rb.terrain) > 50 ||
+          ra.terrain_valid != rb.terrain_valid)
+        ++n_differ;
+    }
+  }
+
+  return n_differ;
+}
+
+static void
+InitTurningReach(TerrainRoute &route, RoutePlannerConfig &config,
+                 const RasterMap &map)
+{
+  GlideSettings settings;
+  settings.SetDefaults();
+  GlidePolar polar(fixed(0.1));
+  SpeedVector wind(Angle::Degrees(0), fixed(0));
+  route.UpdatePolar(settings, polar, polar, wind);
+  route.SetTerrain(&map);
+
+  config.SetDefaults();
+  config.reach_calc_mode = RoutePlannerConfig::ReachMode::TURNING;
+}
+
+/**
+ * Compare incremental reach updates after small movements with a
+ * reach which was solved from scratch at the new position.
+ */
+static void test_reach_incremental(const RasterMap &map)
+{
+  RoutePlannerConfig config;
+  TerrainRoute incremental, full;
+  InitTurningReach(incremental, config, map);
+  InitTurningReach(full, config, map);
+
+  const GeoPoint origin(map.GetMapCenter());
+  const short horigin = map.GetHeight(origin) + 1000;
+  incremental.SolveReach(AGeoPoint(origin, RoughAltitude(horigin)),
+                         config, RoughAltitude::Max(), true, true);
+
+  /* glide along for a few seconds, updating the reach each time */
+  GeoPoint moved = origin;
+  AGeoPoint amoved;
+  for (unsigned i = 1; i <= 10; ++i) {
+    moved.longitude += Angle::Degrees(0.0004);
+    amoved = AGeoPoint(moved, RoughAltitude(horigin - 2 * (int)i));
+    incremental.SolveReach(amoved, config, RoughAltitude::Max(), true, true);
+  }
+
+  /* each step must have been an incremental update, not a fallback
+     to a full solution */
+  ok(incremental.GetReachUpdateCount() == 10, "reach incremental count", 0);
+
+  full.SolveReach(amoved, config, RoughAltitude::Max());
+  ok1(full.GetReachUpdateCount() == 0);
+
+  unsigned n_total;
+  const unsigned n_differ =
+    CountReachDifferences(map, moved, incremental, full, n_total);
+  printf("# incremental reach differs at %u of %u points\n",
+         n_differ, n_total);
+  ok(n_differ * 100 <= n_total, "reach incremental", 0);
+}
+
+/**
+ * Compare a reach whose sectors were solved in parallel with one
+ * which was solved on a single thread.
+ */
+static void test_reach_parallel(const RasterMap &map)
+{
+  RoutePlannerConfig config;
+  TerrainRoute serial, parallel;
+  InitTurningReach(serial, config, map);
+  InitTurningReach(parallel, config, map);
+  parallel.SetParallel(RunParallel);
+
+  const GeoPoint origin(map.GetMapCenter());
+  const AGeoPoint aorigin(origin,
+                          RoughAltitude(map.GetHeight(origin) + 600));
+  serial.SolveReach(aorigin, config, RoughAltitude::Max());
+  parallel.SolveReach(aorigin, config, RoughAltitude::Max());
+
+  unsigned n_total;
+  const unsigned n_differ =
+    CountReachDifferences(map, origin, serial, parallel, n_total);
+  printf("# parallel reach differs at %u of %u points\n",
+         n_differ, n_total);
+  ok(n_differ * 100 <= n_total, "reach parallel", 0);
+}
+
 int main(int argc, char** argv) {
   static const char hc_path[] = "tmp/map.xcm";
   const char *map_path;
@@ -132,7 +246,9 @@ int main(int argc, char** argv) {
   } while (map.IsDirty());
   zzip_dir_close(dir);
 
-  plan_tests(1);
+  plan_tests(5);
+  test_reach_incremental(map);
+  test_reach_parallel(map);
   test_reach(map, fixed(0), fixed(0.1));
 
   return exit_status();